@@ -0,0 +1,444 @@
+#include "buffer/buffer_pool_instance.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/two_queue_replacer.h"
+#include "glog/logging.h"
+
+BufferPoolInstance::BufferPoolInstance(size_t pool_size, DiskManager *disk_manager, ReplacerType replacer_type,
+                                       size_t instance_index)
+    : pool_size_(pool_size), instance_index_(instance_index), disk_manager_(disk_manager) {
+  pages_ = new Page[pool_size_];
+  switch (replacer_type) {
+    case ReplacerType::kLRUK:
+      replacer_ = new LRUKReplacer(pool_size_);
+      break;
+    case ReplacerType::kTwoQueue:
+      replacer_ = new TwoQueueReplacer(pool_size_);
+      break;
+    case ReplacerType::kClock:
+      replacer_ = new CLOCKReplacer(pool_size_);
+      break;
+    default:
+      replacer_ = new LRUReplacer(pool_size_);
+  }
+  dirty_pos_.resize(pool_size_);
+  for (size_t i = 0; i < pool_size_; i++) {
+    free_list_.emplace_back(i);
+  }
+}
+
+BufferPoolInstance::~BufferPoolInstance() {
+  // 等待还在进行的预读，它们完成时要访问frame和latch_
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    loading_cv_.wait(lock, [this] { return loading_pages_.empty(); });
+  }
+  FlushAllPages();
+  delete[] pages_;
+  delete replacer_;
+}
+
+Page *BufferPoolInstance::FetchPage(page_id_t page_id, BufferRing *ring) {
+  // 1.     Search the page table for the requested page (P).
+  // 1.1    If P exists, pin it and return it immediately.
+  // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
+  //        Note that pages are always found from the free list first.
+  // 2.     If R is dirty, write it back to the disk.
+  // 3.     Delete R from the page table and insert P.
+  // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
+  std::unique_lock<std::mutex> lock(latch_);
+  WaitForLoading(lock, page_id);
+
+  // 1. 检查是否已在缓冲池中
+  auto it = page_table_.find(page_id);
+  if (it != page_table_.end()) {
+    frame_id_t frame_id = it->second;
+    pages_[frame_id].pin_count_++;
+    replacer_->Pin(frame_id);
+    replacer_->RecordAccess(frame_id);
+    hits_++;
+    return &pages_[frame_id];
+  }
+  misses_++;
+
+  // 2. 获取可用frame
+  frame_id_t frame_id = ring == nullptr ? TryToFindFreePage() : TryToFindRingFrame(ring, page_id);
+  if (frame_id == INVALID_FRAME_ID) {
+    return nullptr;  // 没有可用页
+  }
+
+  // 3. 准备新页，该页可能刚被换出而后台写还没落盘
+  page_table_[page_id] = frame_id;
+  Page *page = &pages_[frame_id];
+  WaitForCleaning(page_id);
+  disk_manager_->ReadPage(page_id, page->data_);
+  page->page_id_ = page_id;
+  page->pin_count_ = 1;
+  page->is_dirty_ = false;
+
+  // 4. pin
+  replacer_->Pin(frame_id);
+  replacer_->RecordAccess(frame_id);
+
+  return page;
+}
+
+Page *BufferPoolInstance::TryFetchPage(page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+
+  auto it = page_table_.find(page_id);
+  if (it == page_table_.end() || loading_pages_.count(page_id) > 0) {
+    return nullptr;
+  }
+  frame_id_t frame_id = it->second;
+  pages_[frame_id].pin_count_++;
+  replacer_->Pin(frame_id);
+  return &pages_[frame_id];
+}
+
+bool BufferPoolInstance::PrefetchPage(page_id_t page_id, BufferRing *ring, bool wait) {
+  std::unique_lock<std::mutex> lock(latch_);
+
+  if (page_table_.find(page_id) != page_table_.end()) {
+    return false;  // 已在缓冲池中
+  }
+
+  frame_id_t frame_id = ring == nullptr ? TryToFindFreePage() : TryToFindRingFrame(ring, page_id);
+  if (frame_id == INVALID_FRAME_ID) {
+    return false;
+  }
+
+  // 读盘期间pin住frame，不持有latch_；读完后不再pin，交给replacer，可以像普通页一样被换出
+  page_table_[page_id] = frame_id;
+  Page *page = &pages_[frame_id];
+  WaitForCleaning(page_id);
+  page->page_id_ = page_id;
+  page->pin_count_ = 1;
+  page->is_dirty_ = false;
+  loading_pages_.insert(page_id);
+  lock.unlock();
+  auto read = disk_manager_->ReadPageAsync(page_id, page->data_, [this, page_id, frame_id] {
+    std::lock_guard<std::mutex> guard(latch_);
+    pages_[frame_id].pin_count_ = 0;
+    replacer_->Unpin(frame_id);
+    loading_pages_.erase(page_id);
+    prefetched_pages_++;
+    loading_cv_.notify_all();
+  });
+  if (wait) {
+    read.wait();
+  }
+  return true;
+}
+
+Page *BufferPoolInstance::NewPage(page_id_t page_id, BufferRing *ring) {
+  // 1.   If all the pages in the buffer pool are pinned, return nullptr.
+  // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
+  // 3.   Update P's metadata, zero out memory and add P to the page table.
+  std::unique_lock<std::mutex> lock(latch_);
+  WaitForLoading(lock, page_id);
+
+  // 1. 获取可用frame，若预读在该页被释放后又把旧内容读了进来，直接复用那个frame
+  frame_id_t frame_id;
+  auto it = page_table_.find(page_id);
+  if (it != page_table_.end()) {
+    frame_id = it->second;
+    ASSERT(pages_[frame_id].pin_count_ == 0, "Newly allocated page is pinned.");
+    MarkClean(frame_id);
+  } else {
+    frame_id = ring == nullptr ? TryToFindFreePage() : TryToFindRingFrame(ring, page_id);
+  }
+  if (frame_id == INVALID_FRAME_ID) {
+    return nullptr;
+  }
+
+  // 2. 初始化新页
+  Page *page = &pages_[frame_id];
+  page->page_id_ = page_id;
+  page->pin_count_ = 1;
+  page->is_dirty_ = false;
+  page->ResetMemory();
+
+  // 3. 更新元数据
+  page_table_[page_id] = frame_id;
+  replacer_->Pin(frame_id);
+  replacer_->RecordAccess(frame_id);
+
+  return page;
+}
+
+bool BufferPoolInstance::DeletePage(page_id_t page_id) {
+  // 1.   Search the page table for the requested page (P).
+  // 1.   If P does not exist, return true.
+  // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
+  // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
+  std::unique_lock<std::mutex> lock(latch_);
+  WaitForLoading(lock, page_id);
+
+  auto it = page_table_.find(page_id);
+  if (it == page_table_.end()) {
+    return true;  // 页不存在，视为删除成功
+  }
+
+  frame_id_t frame_id = it->second;
+  Page *page = &pages_[frame_id];
+
+  if (page->pin_count_ > 0) {
+    return false;  // 页正在使用
+  }
+
+  // 表明删除，解除缓冲池对该页的引用
+  page_table_.erase(page_id);
+
+  // 重置页状态
+  MarkClean(frame_id);
+  page->page_id_ = INVALID_PAGE_ID;
+  page->pin_count_ = 0;
+  page->ResetMemory();
+
+  // 更新元数据，frame从replacer中移出后才能放回free list，否则会被重复分配
+  replacer_->Remove(frame_id);
+  free_list_.push_back(frame_id);
+
+  return true;
+}
+
+bool BufferPoolInstance::UnpinPage(page_id_t page_id, bool is_dirty) {
+  std::lock_guard<std::mutex> lock(latch_);
+
+  // 在页表中查找指定的page_id
+  auto it = page_table_.find(page_id);
+  if (it == page_table_.end()) {
+    return false;  // 页不存在
+  }
+
+  frame_id_t frame_id = it->second;
+  Page *page = &pages_[frame_id];
+
+  // 如果页面的pin计数小于等于0，表示页面未被固定，返回false
+  if (page->pin_count_ <= 0) {
+    return false;  // 页未被固定
+  }
+
+  // 减少页面的pin计数
+  if ((--(page->pin_count_)) == 0) {
+    // 如果pin计数变为0，通知replacer该页面不再被固定
+    replacer_->Unpin(frame_id);
+  }
+
+  // 只能置脏，不能因为其他使用者的干净unpin而丢失修改
+  if (is_dirty) {
+    MarkDirty(frame_id);
+  }
+
+  return true;
+}
+
+bool BufferPoolInstance::FlushPage(page_id_t page_id) {
+  std::unique_lock<std::mutex> lock(latch_);
+  WaitForLoading(lock, page_id);
+
+  auto it = page_table_.find(page_id);
+  if (it == page_table_.end()) {
+    return false;  // 页不存在
+  }
+
+  Page *page = &pages_[it->second];
+  WaitForCleaning(page_id);
+  disk_manager_->WritePage(page_id, page->data_);
+  MarkClean(it->second);
+
+  return true;
+}
+
+void BufferPoolInstance::FlushAllPages() {
+  std::lock_guard<std::mutex> lock(latch_);
+  // 持有latch期间frame不会被换出，所有脏页一起写，连续的页合并成一次写
+  std::vector<std::pair<page_id_t, const char *>> batch;
+  batch.reserve(dirty_list_.size());
+  while (!dirty_list_.empty()) {
+    frame_id_t frame_id = dirty_list_.front();
+    page_id_t page_id = pages_[frame_id].page_id_;
+    WaitForCleaning(page_id);
+    batch.emplace_back(page_id, pages_[frame_id].data_);
+    MarkClean(frame_id);
+  }
+  if (!batch.empty()) {
+    disk_manager_->WritePages(batch);
+  }
+}
+
+void BufferPoolInstance::PinDirtyPages(const std::vector<page_id_t> *page_ids,
+                                       std::vector<std::pair<page_id_t, const char *>> *batch) {
+  std::lock_guard<std::mutex> lock(latch_);
+  std::vector<frame_id_t> frames;
+  if (page_ids == nullptr) {
+    frames.assign(dirty_list_.begin(), dirty_list_.end());
+  } else {
+    for (auto page_id : *page_ids) {
+      auto it = page_table_.find(page_id);
+      if (it != page_table_.end() && pages_[it->second].is_dirty_) {
+        frames.push_back(it->second);
+      }
+    }
+  }
+  // pin住直到调用者写完，期间该页不会被换出后又读到旧内容
+  for (auto frame_id : frames) {
+    Page *page = &pages_[frame_id];
+    WaitForCleaning(page->page_id_);
+    page->pin_count_++;
+    replacer_->Pin(frame_id);
+    MarkClean(frame_id);
+    batch->emplace_back(page->page_id_, page->data_);
+  }
+}
+
+bool BufferPoolInstance::CheckAllUnpinned() {
+  bool res = true;
+  for (size_t i = 0; i < pool_size_; i++) {
+    if (pages_[i].pin_count_ != 0) {
+      res = false;
+      LOG(ERROR) << "page " << pages_[i].page_id_ << " pin count:" << pages_[i].pin_count_ << endl;
+    }
+  }
+  return res;
+}
+
+frame_id_t BufferPoolInstance::TryToFindFreePage() {
+  frame_id_t frame_id = INVALID_FRAME_ID;
+
+  // 首先尝试从free_list_获取
+  if (!free_list_.empty()) {
+    frame_id = free_list_.front();
+    free_list_.pop_front();
+    return frame_id;
+  }
+
+  // 如果没有空闲页，尝试从replacer_获取，优先选择不需要写回的干净页
+  if (replacer_->Victim(&frame_id, [this](frame_id_t id) { return !pages_[id].is_dirty_; })) {
+    // 如果找到victim，检查是否是脏页需要写回
+    if (pages_[frame_id].IsDirty()) {
+      WaitForCleaning(pages_[frame_id].GetPageId());
+      disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
+      MarkClean(frame_id);
+      foreground_writes_++;
+    }
+    // 从page_table_中移除旧映射
+    page_table_.erase(pages_[frame_id].GetPageId());
+    return frame_id;
+  }
+
+  // 没有可用页
+  return INVALID_FRAME_ID;
+}
+
+frame_id_t BufferPoolInstance::TryToFindRingFrame(BufferRing *ring, page_id_t page_id) {
+  auto &slots = ring->slots_[instance_index_];
+  frame_id_t frame_id = INVALID_FRAME_ID;
+
+  // 环满时复用最早放入环中的frame，前提是它仍装着环放进去的页且没有被pin
+  if (slots.size() >= ring->instance_ring_size_) {
+    BufferRing::Slot slot = slots.front();
+    slots.pop_front();
+    auto it = page_table_.find(slot.page_id_);
+    if (it != page_table_.end() && it->second == slot.frame_id_ && pages_[slot.frame_id_].pin_count_ == 0) {
+      frame_id = slot.frame_id_;
+      replacer_->Remove(frame_id);
+      if (pages_[frame_id].IsDirty()) {
+        WaitForCleaning(slot.page_id_);
+        disk_manager_->WritePage(slot.page_id_, pages_[frame_id].GetData());
+        MarkClean(frame_id);
+        foreground_writes_++;
+      }
+      page_table_.erase(slot.page_id_);
+      ring->reuses_++;
+    }
+    // 否则该frame已被换出或正被别人使用，把它留给共享池
+  }
+
+  // 环还没满或没有可复用的frame时，从共享池中取一个加入环
+  if (frame_id == INVALID_FRAME_ID) {
+    frame_id = TryToFindFreePage();
+    if (frame_id == INVALID_FRAME_ID) {
+      return INVALID_FRAME_ID;
+    }
+    ring->frames_used_++;
+  }
+  slots.push_back({frame_id, page_id});
+  return frame_id;
+}
+
+size_t BufferPoolInstance::CleanPages(double clean_ratio) {
+  std::unique_lock<std::mutex> lock(latch_);
+
+  // 计算需要写回多少页，才能使可换出的frame中至少有clean_ratio是干净的
+  size_t evictable = free_list_.size() + replacer_->Size();
+  std::vector<frame_id_t> frames;
+  for (auto frame_id : dirty_list_) {
+    if (pages_[frame_id].pin_count_ == 0) {
+      frames.push_back(frame_id);  // 按变脏的先后顺序
+    }
+  }
+  auto min_clean = static_cast<size_t>(clean_ratio * evictable + 0.5);
+  size_t clean = evictable - frames.size();
+  size_t to_clean = min_clean > clean ? min_clean - clean : 0;
+  frames.resize(std::min(to_clean, frames.size()));
+  if (frames.empty()) {
+    return 0;
+  }
+
+  // 在latch_下拷贝页内容并置为干净，之后的修改会重新置脏；写盘时不持有latch_，
+  // 同一页的读写通过cleaning_latch_等待这批写完成
+  std::unique_ptr<char[]> data(new char[frames.size() * PAGE_SIZE]);
+  std::vector<std::pair<page_id_t, const char *>> batch;
+  batch.reserve(frames.size());
+  for (size_t i = 0; i < frames.size(); i++) {
+    page_id_t page_id = pages_[frames[i]].page_id_;
+    memcpy(data.get() + i * PAGE_SIZE, pages_[frames[i]].data_, PAGE_SIZE);
+    MarkClean(frames[i]);
+    batch.emplace_back(page_id, data.get() + i * PAGE_SIZE);
+  }
+  cleaning_latch_.lock();
+  for (auto &page : batch) {
+    cleaning_pages_.insert(page.first);
+  }
+  lock.unlock();
+  // 连续的页合并成一次写，不同的段在I/O worker上并行写
+  disk_manager_->WritePages(batch);
+  cleaning_latch_.unlock();
+  lock.lock();
+  for (auto &page : batch) {
+    cleaning_pages_.erase(page.first);
+  }
+  background_writes_ += batch.size();
+  return batch.size();
+}
+
+void BufferPoolInstance::MarkDirty(frame_id_t frame_id) {
+  if (!pages_[frame_id].is_dirty_) {
+    pages_[frame_id].is_dirty_ = true;
+    dirty_pos_[frame_id] = dirty_list_.insert(dirty_list_.end(), frame_id);
+  }
+}
+
+void BufferPoolInstance::MarkClean(frame_id_t frame_id) {
+  if (pages_[frame_id].is_dirty_) {
+    pages_[frame_id].is_dirty_ = false;
+    dirty_list_.erase(dirty_pos_[frame_id]);
+  }
+}
+
+void BufferPoolInstance::WaitForCleaning(page_id_t page_id) {
+  if (cleaning_pages_.count(page_id) > 0) {
+    std::lock_guard<std::mutex> guard(cleaning_latch_);
+  }
+}
+
+void BufferPoolInstance::WaitForLoading(std::unique_lock<std::mutex> &lock, page_id_t page_id) {
+  loading_cv_.wait(lock, [this, page_id] { return loading_pages_.count(page_id) == 0; });
+}
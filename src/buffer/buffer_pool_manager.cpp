@@ -3,203 +3,166 @@
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
 
-static const char EMPTY_PAGE_DATA[PAGE_SIZE] = {0};
-
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t num_instances,
+                                     ReplacerType replacer_type)
     : pool_size_(pool_size), disk_manager_(disk_manager) {
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size_);
-  for (size_t i = 0; i < pool_size_; i ++) {
-    free_list_.emplace_back(i);
+  ASSERT(num_instances > 0 && num_instances <= pool_size, "Invalid number of buffer pool instances.");
+  // 均分frame，余数分给前几个instance
+  for (size_t i = 0; i < num_instances; i++) {
+    size_t instance_size = pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0);
+    instances_.push_back(new BufferPoolInstance(instance_size, disk_manager_, replacer_type, i));
   }
 }
 
 BufferPoolManager::~BufferPoolManager() {
-  for (auto page : page_table_) {
-    FlushPage(page.first);
-  }
-  delete[] pages_;
-  delete replacer_;
-}
-
-/**
- * TODO: Student Implement
- */
-Page *BufferPoolManager::FetchPage(page_id_t page_id) {
-  // 1.     Search the page table for the requested page (P).
-  // 1.1    If P exists, pin it and return it immediately.
-  // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
-  //        Note that pages are always found from the free list first.
-  // 2.     If R is dirty, write it back to the disk.
-  // 3.     Delete R from the page table and insert P.
-  // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-  std::lock_guard<std::recursive_mutex> lock(latch_);
-
-  // 1. 检查是否已在缓冲池中
-  auto it = page_table_.find(page_id);
-  if (it != page_table_.end()) {
-    frame_id_t frame_id = it->second;
-    pages_[frame_id].pin_count_++;
-    replacer_->Pin(frame_id);
-    return &pages_[frame_id];
-  }
-
-  // 2. 获取可用frame
-  frame_id_t frame_id = TryToFindFreePage();
-  if (frame_id == -1) {
-    return nullptr;  // 没有可用页
-  }
-
-  // 3. 准备新页
-  page_table_[page_id] = frame_id;
-  Page *page = &pages_[frame_id];
-  disk_manager_->ReadPage(page_id, page->data_);
-  page->page_id_ = page_id;
-  page->pin_count_ = 1;
-  page->is_dirty_ = false;
-
-  // 5. pin
-  replacer_->Pin(frame_id);
-
-  return page;
+  StopBackgroundWriter();
+  {
+    std::lock_guard<std::mutex> lock(prefetch_latch_);
+    prefetch_stop_ = true;
+  }
+  prefetch_cv_.notify_all();
+  if (prefetcher_.joinable()) {
+    prefetcher_.join();
+  }
+  // 所有instance的脏页一起写，instance各自析构时就没有脏页了
+  FlushAllPages();
+  for (auto instance : instances_) {
+    delete instance;
+  }
 }
 
-/**
- * TODO: Student Implement
- */
-Page *BufferPoolManager::NewPage(page_id_t &page_id) {
-  // 0.   Make sure you call AllocatePage!
-  // 1.   If all the pages in the buffer pool are pinned, return nullptr.
-  // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
-  // 3.   Update P's metadata, zero out memory and add P to the page table.
-  // 4.   Set the page ID output parameter. Return a pointer to P.
-
-  std::lock_guard<std::recursive_mutex> lock(latch_);
+Page *BufferPoolManager::FetchPage(page_id_t page_id, BufferRing *ring) {
+  return GetInstance(page_id)->FetchPage(page_id, ring);
+}
 
-  // 1. 获取可用frame
-  frame_id_t frame_id = TryToFindFreePage();
-  if (frame_id == -1) {
+Page *BufferPoolManager::NewPage(page_id_t &page_id, BufferRing *ring) {
+  // The page id decides which instance the page lives in, so it has to be allocated before a frame is picked.
+  // If that instance is full the allocation is given back, leaving the disk file as it was.
+  page_id_t new_page_id = AllocatePage();
+  Page *page = GetInstance(new_page_id)->NewPage(new_page_id, ring);
+  if (page == nullptr) {
+    DeallocatePage(new_page_id);
     return nullptr;
   }
-
-  // 2. 分配新页号
-  page_id = AllocatePage();
-
-  // 3. 初始化新页
-  Page *page = &pages_[frame_id];
-  page->page_id_ = page_id;
-  page->pin_count_ = 1;
-  page->is_dirty_ = false;
-  page->ResetMemory();
-
-  // 4. 更新元数据
-  page_table_[page_id] = frame_id;
-  replacer_->Pin(frame_id);
-
+  page_id = new_page_id;
   return page;
 }
 
-/**
- * TODO: Student Implement
- */
 bool BufferPoolManager::DeletePage(page_id_t page_id) {
-  // 0.   Make sure you call DeallocatePage!
-  // 1.   Search the page table for the requested page (P).
-  // 1.   If P does not exist, return true.
-  // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
-  // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-
-  std::lock_guard<std::recursive_mutex> lock(latch_);
-
-  auto it = page_table_.find(page_id);
-  if (it == page_table_.end()) {
-    return true;  // 页不存在，视为删除成功
+  if (!GetInstance(page_id)->DeletePage(page_id)) {
+    return false;
   }
-
-  frame_id_t frame_id = it->second;
-  Page *page = &pages_[frame_id];
-
-  if (page->pin_count_ > 0) {
-    return false;  // 页正在使用
-  }
-
-  // 表明删除，解除缓冲池对该页的引用
-  page_table_.erase(page_id);
-
-  // 重置页状态
-  page->page_id_ = INVALID_PAGE_ID;
-  page->pin_count_ = 0;
-  page->is_dirty_ = false;
-  page->ResetMemory();
-
-  // 更新元数据
-  free_list_.push_back(frame_id);
   // 从磁盘删除
   DeallocatePage(page_id);
-
   return true;
 }
 
-/**
- * TODO: Student Implement
- */
-
-// 取消固定页
-bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
-  // 使用递归互斥锁保护共享数据结构，防止多线程并发访问导致的数据不一致
-  std::lock_guard<std::recursive_mutex> lock(latch_);
+Page *BufferPoolManager::TryFetchPage(page_id_t page_id) {
+  return GetInstance(page_id)->TryFetchPage(page_id);
+}
 
-  // 在页表中查找指定的page_id
-  auto it = page_table_.find(page_id);
+std::shared_ptr<BufferRing> BufferPoolManager::CreateBufferRing(size_t ring_size) {
+  return std::make_shared<BufferRing>(ring_size, instances_.size());
+}
 
-  // 如果没有找到该page_id对应的条目，则返回false，表示页不存在
-  if (it == page_table_.end()) {
-    return false;  // 页不存在
+void BufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids, std::shared_ptr<BufferRing> ring) {
+  std::lock_guard<std::mutex> lock(prefetch_latch_);
+  for (auto page_id : page_ids) {
+    EnqueuePrefetch({page_id, 1, nullptr, ring});
   }
+  prefetch_cv_.notify_one();
+}
 
-  // 获取对应的frame_id
-  frame_id_t frame_id = it->second;
-  // 获取对应的页面指针
-  Page *page = &pages_[frame_id];
+void BufferPoolManager::PrefetchChain(page_id_t page_id, size_t length, NextPageFn next_page,
+                                      std::shared_ptr<BufferRing> ring) {
+  std::lock_guard<std::mutex> lock(prefetch_latch_);
+  EnqueuePrefetch({page_id, length, next_page, std::move(ring)});
+  prefetch_cv_.notify_one();
+}
 
-  // 如果页面的pin计数小于等于0，表示页面未被固定，返回false
-  if (page->pin_count_ <= 0) {
-    return false;  // 页未被固定
+void BufferPoolManager::EnqueuePrefetch(PrefetchRequest request) {
+  // 预读只是提示，积压太多时直接丢弃
+  if (prefetch_stop_ || request.page_id == INVALID_PAGE_ID || request.length == 0 ||
+      prefetch_queue_.size() >= pool_size_) {
+    return;
   }
-
-  // 减少页面的pin计数
-  if ((--(page->pin_count_)) == 0) {
-    // 如果pin计数变为0，通知replacer该页面不再被固定
-    replacer_->Unpin(frame_id);
+  prefetch_queue_.push_back(std::move(request));
+  if (!prefetcher_.joinable()) {
+    prefetcher_ = std::thread([this] {
+      std::unique_lock<std::mutex> lock(prefetch_latch_);
+      while (true) {
+        prefetch_cv_.wait(lock, [this] { return prefetch_stop_ || !prefetch_queue_.empty(); });
+        if (prefetch_stop_) {
+          return;
+        }
+        auto request = std::move(prefetch_queue_.front());
+        prefetch_queue_.pop_front();
+        lock.unlock();
+        // 链表的下一页只有读入当前页后才知道，所以要等链表中间的页读完再从中取出下一页；
+        // 其余的页不等待，在I/O worker上并行读
+        while (true) {
+          GetInstance(request.page_id)->PrefetchPage(request.page_id, request.ring.get(), request.length > 1);
+          Page *page = --request.length > 0 ? TryFetchPage(request.page_id) : nullptr;
+          if (page == nullptr) {
+            break;
+          }
+          page->RLatch();
+          page_id_t next_page_id = request.next_page(page);
+          page->RUnlatch();
+          UnpinPage(request.page_id, false);
+          if (next_page_id == INVALID_PAGE_ID) {
+            break;
+          }
+          request.page_id = next_page_id;
+        }
+        request.ring.reset();
+        lock.lock();
+      }
+    });
   }
-
-  page->is_dirty_ = is_dirty;
-
-  // 成功解除固定页面，返回true
-  return true;
 }
 
-/**
- * TODO: Student Implement
- */
+bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  return GetInstance(page_id)->UnpinPage(page_id, is_dirty);
+}
 
-// 刷新页到磁盘
 bool BufferPoolManager::FlushPage(page_id_t page_id) {
+  return GetInstance(page_id)->FlushPage(page_id);
+}
 
-  std::lock_guard<std::recursive_mutex> lock(latch_);
-
-  auto it = page_table_.find(page_id);
-  if (it == page_table_.end()) {
-    return false;  // 页不存在
-  }
-
-  frame_id_t frame_id = it->second;
-  Page *page = &pages_[frame_id];
+void BufferPoolManager::FlushPages(const std::vector<page_id_t> &page_ids) {
+  FlushBatch(&page_ids);
+}
 
-  disk_manager_->WritePage(page_id, page->data_);
-  page->is_dirty_ = false;
+void BufferPoolManager::FlushAllPages() {
+  FlushBatch(nullptr);
+}
 
-  return true;
+void BufferPoolManager::FlushBatch(const std::vector<page_id_t> *page_ids) {
+  // 相邻的页号分在不同的instance，要从所有instance收集后才能合并
+  std::vector<std::pair<page_id_t, const char *>> batch;
+  if (page_ids == nullptr) {
+    for (auto instance : instances_) {
+      instance->PinDirtyPages(nullptr, &batch);
+    }
+  } else {
+    std::vector<std::vector<page_id_t>> instance_page_ids(instances_.size());
+    for (auto page_id : *page_ids) {
+      instance_page_ids[static_cast<size_t>(page_id) % instances_.size()].push_back(page_id);
+    }
+    for (size_t i = 0; i < instances_.size(); i++) {
+      if (!instance_page_ids[i].empty()) {
+        instances_[i]->PinDirtyPages(&instance_page_ids[i], &batch);
+      }
+    }
+  }
+  if (batch.empty()) {
+    return;
+  }
+  disk_manager_->WritePages(batch);
+  for (auto &page : batch) {
+    UnpinPage(page.first, false);
+  }
 }
 
 page_id_t BufferPoolManager::AllocatePage() {
@@ -218,11 +181,78 @@ bool BufferPoolManager::IsPageFree(page_id_t page_id) {
 // Only used for debug
 bool BufferPoolManager::CheckAllUnpinned() {
   bool res = true;
-  for (size_t i = 0; i < pool_size_; i++) {
-    if (pages_[i].pin_count_ != 0) {
-      res = false;
-      LOG(ERROR) << "page " << pages_[i].page_id_ << " pin count:" << pages_[i].pin_count_ << endl;
-    }
+  for (auto instance : instances_) {
+    res = instance->CheckAllUnpinned() && res;
   }
   return res;
-}
\ No newline at end of file
+}
+
+void BufferPoolManager::StartBackgroundWriter(double clean_ratio, uint32_t interval_ms) {
+  if (bg_writer_.joinable()) {
+    return;
+  }
+  bg_stop_ = false;
+  bg_writer_ = std::thread([this, clean_ratio, interval_ms] {
+    std::unique_lock<std::mutex> lock(bg_latch_);
+    while (!bg_cv_.wait_for(lock, std::chrono::milliseconds(interval_ms), [this] { return bg_stop_; })) {
+      // 写盘期间不持有bg_latch_，避免Stop等待一整轮
+      lock.unlock();
+      CleanPages(clean_ratio);
+      lock.lock();
+    }
+  });
+}
+
+void BufferPoolManager::StopBackgroundWriter() {
+  if (!bg_writer_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(bg_latch_);
+    bg_stop_ = true;
+  }
+  bg_cv_.notify_all();
+  bg_writer_.join();
+}
+
+size_t BufferPoolManager::CleanPages(double clean_ratio) {
+  size_t written = 0;
+  for (auto instance : instances_) {
+    written += instance->CleanPages(clean_ratio);
+  }
+  return written;
+}
+
+size_t BufferPoolManager::GetForegroundWrites() const {
+  size_t writes = 0;
+  for (auto instance : instances_) {
+    writes += instance->GetForegroundWrites();
+  }
+  return writes;
+}
+
+size_t BufferPoolManager::GetBackgroundWrites() const {
+  size_t writes = 0;
+  for (auto instance : instances_) {
+    writes += instance->GetBackgroundWrites();
+  }
+  return writes;
+}
+
+size_t BufferPoolManager::GetPrefetchedPages() const {
+  size_t pages = 0;
+  for (auto instance : instances_) {
+    pages += instance->GetPrefetchedPages();
+  }
+  return pages;
+}
+
+double BufferPoolManager::GetHitRate() const {
+  size_t hits = 0;
+  size_t misses = 0;
+  for (auto instance : instances_) {
+    hits += instance->GetHits();
+    misses += instance->GetMisses();
+  }
+  return hits + misses == 0 ? 0 : static_cast<double>(hits) / (hits + misses);
+}
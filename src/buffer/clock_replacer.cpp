@@ -0,0 +1,79 @@
+#include "buffer/clock_replacer.h"
+
+#include "common/macros.h"
+
+CLOCKReplacer::CLOCKReplacer(size_t num_pages)
+    : capacity(num_pages), evictable_(num_pages, false), referenced_(num_pages, false) {}
+
+CLOCKReplacer::~CLOCKReplacer() = default;
+
+bool CLOCKReplacer::Victim(frame_id_t *frame_id) {
+  return Victim(frame_id, [](frame_id_t) { return true; });
+}
+
+bool CLOCKReplacer::Victim(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &prefer) {
+  std::lock_guard<std::mutex> lock(latch_);
+
+  if (size_ == 0) {
+    return false;
+  }
+
+  // 转动指针：引用位为1的清零后跳过（第二次机会），引用位为0的是候选，
+  // 在前几个候选中选第一个满足prefer的，否则选第一个候选
+  frame_id_t victim = INVALID_FRAME_ID;
+  frame_id_t first = INVALID_FRAME_ID;
+  size_t depth = PreferScanDepth(size_);
+  size_t seen = 0;
+  while (victim == INVALID_FRAME_ID) {
+    auto id = static_cast<frame_id_t>(hand_);
+    hand_ = (hand_ + 1) % capacity;
+    if (!evictable_[id]) {
+      continue;
+    }
+    if (referenced_[id]) {
+      referenced_[id] = false;
+      continue;
+    }
+    if (prefer(id)) {
+      victim = id;
+    } else {
+      if (first == INVALID_FRAME_ID) {
+        first = id;
+      }
+      if (++seen >= depth) {
+        victim = first;
+      }
+    }
+  }
+
+  evictable_[victim] = false;
+  size_--;
+  *frame_id = victim;
+  return true;
+}
+
+void CLOCKReplacer::Pin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  ASSERT(static_cast<size_t>(frame_id) < capacity, "Invalid frame id.");
+
+  if (evictable_[frame_id]) {
+    evictable_[frame_id] = false;
+    size_--;
+  }
+}
+
+void CLOCKReplacer::Unpin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  ASSERT(static_cast<size_t>(frame_id) < capacity, "Invalid frame id.");
+
+  if (!evictable_[frame_id]) {
+    evictable_[frame_id] = true;
+    size_++;
+  }
+  referenced_[frame_id] = true;
+}
+
+size_t CLOCKReplacer::Size() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return size_;
+}
@@ -0,0 +1,133 @@
+#include "buffer/lru_k_replacer.h"
+
+#include "common/macros.h"
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k) : k_(k), frames_(num_pages) {
+  ASSERT(k_ > 0, "k must be positive.");
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  return Victim(frame_id, [](frame_id_t) { return true; });
+}
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &prefer) {
+  std::lock_guard<std::mutex> lock(latch_);
+
+  if (history_queue_.empty() && cache_queue_.empty()) {
+    return false;
+  }
+
+  // 先看访问不足k次的帧（k距离为无穷大），再按第k次访问的时间从旧到新看其余帧
+  frame_id_t victim = INVALID_FRAME_ID;
+  size_t depth = PreferScanDepth(history_queue_.size() + cache_queue_.size());
+  size_t seen = 0;
+  for (auto *queue : {&history_queue_, &cache_queue_}) {
+    for (auto it = queue->begin(); it != queue->end() && seen < depth; ++it, ++seen) {
+      if (prefer(it->second)) {
+        victim = it->second;
+        break;
+      }
+    }
+    if (victim != INVALID_FRAME_ID || seen >= depth) {
+      break;
+    }
+  }
+  if (victim == INVALID_FRAME_ID) {
+    victim = history_queue_.empty() ? cache_queue_.begin()->second : history_queue_.begin()->second;
+  }
+
+  Evict(victim);
+  *frame_id = victim;
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+
+  if (frames_[frame_id].evictable_) {
+    Dequeue(frame_id);
+    frames_[frame_id].evictable_ = false;
+  }
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+
+  if (!frames_[frame_id].evictable_) {
+    frames_[frame_id].evictable_ = true;
+    Enqueue(frame_id);
+  }
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+
+  FrameInfo &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    Dequeue(frame_id);
+  }
+  current_timestamp_++;
+  if (last_accessed_ == frame_id && !frame.history_.empty()) {
+    // 相关访问：紧接着的重复访问只刷新最近一次的时间
+    frame.history_.back() = current_timestamp_;
+  } else {
+    frame.history_.push_back(current_timestamp_);
+    if (frame.history_.size() > k_) {
+      frame.history_.pop_front();
+    }
+  }
+  last_accessed_ = frame_id;
+  if (frame.evictable_) {
+    Enqueue(frame_id);
+  }
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+
+  Evict(frame_id);
+}
+
+size_t LRUKReplacer::Size() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return history_queue_.size() + cache_queue_.size();
+}
+
+void LRUKReplacer::Enqueue(frame_id_t frame_id) {
+  FrameInfo &frame = frames_[frame_id];
+  if (frame.history_.size() >= k_) {
+    frame.key_ = frame.history_.front();
+    cache_queue_.emplace(frame.key_, frame_id);
+  } else {
+    // 从未被访问过的帧（例如预读进来的页）按进入replacer的时间排队，不会比刚访问过一次的页先被换出
+    frame.key_ = frame.history_.empty() ? current_timestamp_ : frame.history_.front();
+    history_queue_.emplace(frame.key_, frame_id);
+  }
+}
+
+void LRUKReplacer::Dequeue(frame_id_t frame_id) {
+  FrameInfo &frame = frames_[frame_id];
+  if (frame.history_.size() >= k_) {
+    cache_queue_.erase({frame.key_, frame_id});
+  } else {
+    history_queue_.erase({frame.key_, frame_id});
+  }
+}
+
+void LRUKReplacer::Evict(frame_id_t frame_id) {
+  FrameInfo &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    Dequeue(frame_id);
+  }
+  frame.history_.clear();
+  frame.evictable_ = false;
+  if (last_accessed_ == frame_id) {
+    last_accessed_ = INVALID_FRAME_ID;
+  }
+}
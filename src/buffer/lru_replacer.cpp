@@ -25,6 +25,34 @@ bool LRUReplacer::Victim(frame_id_t *frame_id) {
   return true;
 }
 
+bool LRUReplacer::Victim(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &prefer) {
+  std::lock_guard<std::mutex> lock(latch_);
+
+  if (lru_list_.empty()) {
+    return false;
+  }
+
+  // 从链表尾部开始，在最旧的一部分候选中找第一个满足prefer的帧，找不到就退回到最久未使用的帧
+  auto victim = std::prev(lru_list_.end());
+  auto it = victim;
+  size_t depth = PreferScanDepth(lru_list_.size());
+  for (size_t i = 0; i < depth; i++) {
+    if (prefer(*it)) {
+      victim = it;
+      break;
+    }
+    if (it == lru_list_.begin()) {
+      break;
+    }
+    --it;
+  }
+
+  *frame_id = *victim;
+  lru_map_.erase(*victim);
+  lru_list_.erase(victim);
+  return true;
+}
+
 /**
  * TODO: Student Implement
  */
@@ -0,0 +1,43 @@
+#include "buffer/read_ahead.h"
+
+void ReadAhead::Advance(page_id_t page_id) {
+  if (buffer_pool_manager_ == nullptr || buffer_pool_manager_->GetReadAheadWindow() == 0) {
+    return;
+  }
+  size_t window = buffer_pool_manager_->GetReadAheadWindow();
+
+  // 扫描按链表顺序到达下一页时窗口缩短一页，否则窗口作废，从当前页重新开始
+  if (page_id == expected_ && ahead_ > 0) {
+    ahead_--;
+  } else {
+    ahead_ = 0;
+  }
+  expected_ = PeekNextPageId(page_id);
+
+  // 窗口还剩一半以上时不补充，补充时沿已读入的页走到窗口末尾
+  if (expected_ == INVALID_PAGE_ID || ahead_ > window / 2) {
+    return;
+  }
+  page_id_t frontier = expected_;
+  for (size_t i = 0; i < ahead_; i++) {
+    frontier = PeekNextPageId(frontier);
+    if (frontier == INVALID_PAGE_ID) {
+      return;  // 窗口中的页还没读完，或者链表已经结束
+    }
+  }
+  // 之后的页由预读线程边读边沿链表找到
+  buffer_pool_manager_->PrefetchChain(frontier, window - ahead_, next_page_, ring_);
+  ahead_ = window;
+}
+
+page_id_t ReadAhead::PeekNextPageId(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->TryFetchPage(page_id);
+  if (page == nullptr) {
+    return INVALID_PAGE_ID;
+  }
+  page->RLatch();
+  page_id_t next_page_id = next_page_(page);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return next_page_id;
+}
@@ -0,0 +1,119 @@
+#include "buffer/two_queue_replacer.h"
+
+#include "common/macros.h"
+
+TwoQueueReplacer::TwoQueueReplacer(size_t num_pages, double a1_ratio)
+    : a1_max_size_(static_cast<size_t>(num_pages * a1_ratio)), frames_(num_pages) {}
+
+TwoQueueReplacer::~TwoQueueReplacer() = default;
+
+bool TwoQueueReplacer::Victim(frame_id_t *frame_id) {
+  return Victim(frame_id, [](frame_id_t) { return true; });
+}
+
+bool TwoQueueReplacer::Victim(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &prefer) {
+  std::lock_guard<std::mutex> lock(latch_);
+
+  if (a1_.empty() && am_.empty()) {
+    return false;
+  }
+
+  // A1超过配额或Am为空时从A1换出，否则从Am换出
+  auto &queue = (a1_.size() > a1_max_size_ || am_.empty()) ? a1_ : am_;
+  frame_id_t victim = queue.begin()->second;
+  size_t depth = PreferScanDepth(queue.size());
+  size_t seen = 0;
+  for (auto it = queue.begin(); it != queue.end() && seen < depth; ++it, ++seen) {
+    if (prefer(it->second)) {
+      victim = it->second;
+      break;
+    }
+  }
+
+  Evict(victim);
+  *frame_id = victim;
+  return true;
+}
+
+void TwoQueueReplacer::Pin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+
+  if (frames_[frame_id].evictable_) {
+    Dequeue(frame_id);
+    frames_[frame_id].evictable_ = false;
+  }
+}
+
+void TwoQueueReplacer::Unpin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+
+  FrameInfo &frame = frames_[frame_id];
+  if (!frame.evictable_) {
+    if (!frame.accessed_) {
+      // 从未被访问过的帧（例如预读进来的页）排在A1末尾
+      frame.key_ = current_timestamp_;
+    }
+    frame.evictable_ = true;
+    Enqueue(frame_id);
+  }
+}
+
+void TwoQueueReplacer::RecordAccess(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+
+  FrameInfo &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    Dequeue(frame_id);
+  }
+  current_timestamp_++;
+  if (!frame.accessed_) {
+    // 第一次访问，进入A1
+    frame.accessed_ = true;
+    frame.key_ = current_timestamp_;
+  } else if (frame.in_am_) {
+    frame.key_ = current_timestamp_;
+  } else if (last_accessed_ != frame_id) {
+    // 在A1中再次被访问（不是紧接着的相关访问），移入Am
+    frame.in_am_ = true;
+    frame.key_ = current_timestamp_;
+  }
+  last_accessed_ = frame_id;
+  if (frame.evictable_) {
+    Enqueue(frame_id);
+  }
+}
+
+void TwoQueueReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+  Evict(frame_id);
+}
+
+size_t TwoQueueReplacer::Size() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return a1_.size() + am_.size();
+}
+
+void TwoQueueReplacer::Enqueue(frame_id_t frame_id) {
+  FrameInfo &frame = frames_[frame_id];
+  (frame.in_am_ ? am_ : a1_).emplace(frame.key_, frame_id);
+}
+
+void TwoQueueReplacer::Dequeue(frame_id_t frame_id) {
+  FrameInfo &frame = frames_[frame_id];
+  (frame.in_am_ ? am_ : a1_).erase({frame.key_, frame_id});
+}
+
+void TwoQueueReplacer::Evict(frame_id_t frame_id) {
+  FrameInfo &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    Dequeue(frame_id);
+  }
+  frame = FrameInfo();
+  if (last_accessed_ == frame_id) {
+    last_accessed_ = INVALID_FRAME_ID;
+  }
+}
@@ -82,15 +82,23 @@ CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManag
       TableMetadata::DeserializeFrom(table_meta_page->GetData(), table_meta);
       buffer_pool_manager_->UnpinPage(table_meta_pid, true);
 
+      // 创建表堆，旧格式的表不加载
+      TableHeap *tbl_heap = nullptr;
+      if (table_meta != nullptr) {
+        tbl_heap = TableHeap::Create(buffer_pool_manager_, table_meta->GetFirstPageId(), table_meta->GetSchema(),
+                                     log_manager_, lock_manager_, table_meta->GetFreeSpaceMapPageId());
+      }
+      if (tbl_heap == nullptr) {
+        LOG(ERROR) << "Table " << entry.first << " was written in an older format and is not loaded.";
+        delete table_meta;
+        continue;
+      }
+
       // 获取表信息并保存
       table_id_t tbl_id = table_meta->GetTableId();
       std::string tbl_name = table_meta->GetTableName();
       table_names_[tbl_name] = tbl_id;
 
-      // 创建表堆
-      TableHeap *tbl_heap = TableHeap::Create(buffer_pool_manager_, table_meta->GetFirstPageId(),
-                                               table_meta->GetSchema(), log_manager_, lock_manager_);
-
       // 创建表信息对象
       TableInfo *tbl_info = TableInfo::Create();
       tbl_info->Init(table_meta, tbl_heap);
@@ -111,6 +119,10 @@ CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManag
       // 获取索引信息并保存
       index_id_t idx_id = index_meta->GetIndexId();
       table_id_t tid = index_meta->GetTableId();
+      if (tables_.find(tid) == tables_.end()) {
+        delete index_meta;  // 所在的表没有加载
+        continue;
+      }
       std::string table_name = tables_[tid]->GetTableName();
       std::string index_name = index_meta->GetIndexName();
 
@@ -147,7 +159,8 @@ CatalogManager::~CatalogManager() {
  * TODO: Student Implement
  */
 //////
-dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schema, Txn *txn, TableInfo *&table_info) {
+dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schema, Txn *txn, TableInfo *&table_info,
+                                    TableLayout layout) {
   // 检查表是否已存在
   if (table_names_.find(table_name) != table_names_.end()) {
     return DB_TABLE_ALREADY_EXIST;
@@ -166,10 +179,11 @@ dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schem
   Page *meta_page = buffer_pool_manager_->NewPage(meta_page_id);
 
   // 创建并初始化表堆
-  TableHeap *heap = TableHeap::Create(buffer_pool_manager_, copied_schema, txn, log_manager_, lock_manager_);
+  TableHeap *heap = TableHeap::Create(buffer_pool_manager_, copied_schema, txn, log_manager_, lock_manager_, layout);
 
   // 创建表的元数据对象并将其序列化
-  TableMetadata *table_metadata = TableMetadata::Create(current_table_id, table_name, heap->GetFirstPageId(), copied_schema);
+  TableMetadata *table_metadata = TableMetadata::Create(current_table_id, table_name, heap->GetFirstPageId(),
+                                                        copied_schema, heap->GetFreeSpaceMapPageId());
   table_metadata->SerializeTo(meta_page->GetData());
   buffer_pool_manager_->UnpinPage(meta_page_id, true);
 
@@ -419,9 +433,6 @@ dberr_t CatalogManager::LoadTable(const table_id_t table_id, const page_id_t pag
         return DB_TABLE_ALREADY_EXIST;
     }
 
-    // 注册表的元数据页信息
-    catalog_meta_->table_meta_pages_[table_id] = page_id;
-
     // 从缓冲池读取表元数据页
     Page *meta_page = buffer_pool_manager_->FetchPage(page_id);
     char *meta_data = reinterpret_cast<char *>(meta_page->GetData());
@@ -430,13 +441,27 @@ dberr_t CatalogManager::LoadTable(const table_id_t table_id, const page_id_t pag
     TableMetadata *table_metadata = nullptr;
     TableMetadata::DeserializeFrom(meta_data, table_metadata);
 
+    // 创建表堆，旧格式的表不加载
+    TableHeap *table_heap = nullptr;
+    if (table_metadata != nullptr) {
+        table_heap = TableHeap::Create(buffer_pool_manager_, table_metadata->GetFirstPageId(),
+                                       table_metadata->GetSchema(), log_manager_, lock_manager_,
+                                       table_metadata->GetFreeSpaceMapPageId());
+    }
+    if (table_heap == nullptr) {
+        delete table_metadata;
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        return DB_TABLE_FORMAT_OUTDATED;
+    }
+
+    // 注册表的元数据页信息
+    catalog_meta_->table_meta_pages_[table_id] = page_id;
+
     // 记录表名与表 ID 映射
     std::string table_name = table_metadata->GetTableName();
     table_names_[table_name] = table_id;
 
-    // 创建表堆并初始化表信息对象
-    TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_, page_id, table_metadata->GetSchema(),
-                                              log_manager_, lock_manager_);
+    // 初始化表信息对象
     TableInfo *table_info = TableInfo::Create();
     table_info->Init(table_metadata, table_heap);
 
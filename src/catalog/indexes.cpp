@@ -85,17 +85,8 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta) {
 }
  
 Index *IndexInfo::CreateIndex(BufferPoolManager *buffer_pool_manager, const string &index_type) {
-  size_t max_size = 0;
-  uint32_t column_cnt = key_schema_->GetColumns().size();
-  size_t size_bitmap = (column_cnt % 8) ? column_cnt / 8 + 1 : column_cnt / 8;
-  // column_cnt + bitmap
-  max_size += 4 + sizeof(unsigned char) * size_bitmap;
-  for (auto col : key_schema_->GetColumns()) {
-    // length of char column
-    if(col->GetType() == TypeId::kTypeChar)
-      max_size += 4;
-    max_size += col->GetLength();
-  }
+  // 键按可直接 memcmp 比较的格式存储，见 KeyManager
+  size_t max_size = KeyManager::GetEncodedSize(key_schema_);
 
   if (index_type == "bptree") {
     if (max_size <= 8)
@@ -115,5 +106,9 @@ Index *IndexInfo::CreateIndex(BufferPoolManager *buffer_pool_manager, const stri
   } else {
     return nullptr;
   }
+  // 单个定长列上的索引用比较可以内联的特化 B+ 树
+  if (FixedKeyManager::IsFixedWidth(key_schema_)) {
+    return new FixedKeyBPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager);
+  }
   return new BPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager);
 }
@@ -12,7 +12,7 @@ DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer
   }
   // Initialize components
   disk_mgr_ = new DiskManager(db_file_name_);
-  bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_);
+  bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_, DEFAULT_BUFFER_POOL_INSTANCES, ReplacerType::kLRUK);
 
   // Allocate static page for db storage engine
   if (init) {
@@ -39,6 +39,7 @@ DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer
     ASSERT(!bpm_->IsPageFree(INDEX_ROOTS_PAGE_ID), "Invalid header page.");
   }
   catalog_mgr_ = new CatalogManager(bpm_, nullptr, nullptr, init);
+  bpm_->StartBackgroundWriter();
 }
 
 DBStorageEngine::~DBStorageEngine() {
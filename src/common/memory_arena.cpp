@@ -0,0 +1,76 @@
+#include "common/memory_arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+MemoryArena::~MemoryArena() {
+  // Block的成员都不需要析构，直接释放整块内存
+  for (auto block : blocks_) {
+    delete[] reinterpret_cast<char *>(block);
+  }
+}
+
+char *MemoryArena::Block::TryAllocate(size_t size, size_t alignment) {
+  auto base = reinterpret_cast<uintptr_t>(Data());
+  size_t used = used_.load(std::memory_order_relaxed);
+  while (true) {
+    size_t offset = ((base + used + alignment - 1) & ~(alignment - 1)) - base;
+    if (offset + size > size_) {
+      return nullptr;
+    }
+    // 失败时used被更新为别的线程留下的值，重新对齐再试
+    if (used_.compare_exchange_weak(used, offset + size, std::memory_order_relaxed)) {
+      return Data() + offset;
+    }
+  }
+}
+
+MemoryArena::Block *MemoryArena::NewBlock(size_t size) {
+  // new char[]返回的地址满足max_align_t的对齐，块头之后也是
+  auto block = new (new char[HEADER_SIZE + size]) Block(size);
+  block_allocations_++;
+  blocks_.push_back(block);
+  return block;
+}
+
+void *MemoryArena::Allocate(size_t size, size_t alignment) {
+  allocations_.fetch_add(1, std::memory_order_relaxed);
+  bytes_allocated_.fetch_add(size, std::memory_order_relaxed);
+  // 快速路径只在当前块上原子地移动偏移，不加锁
+  Block *block = current_.load(std::memory_order_acquire);
+  char *result = block == nullptr ? nullptr : block->TryAllocate(size, alignment);
+  if (result != nullptr) {
+    return result;
+  }
+  std::lock_guard<std::mutex> lock(latch_);
+  // 大的请求单独占一个块，当前块保持不变
+  if (size + alignment > block_size_) {
+    block = NewBlock(size + alignment);
+    return block->TryAllocate(size, alignment);
+  }
+  // 等锁时别的线程可能已经换上了新块
+  block = current_.load(std::memory_order_relaxed);
+  result = block == nullptr ? nullptr : block->TryAllocate(size, alignment);
+  if (result != nullptr) {
+    return result;
+  }
+  block = NewBlock(block_size_);
+  result = block->TryAllocate(size, alignment);
+  current_.store(block, std::memory_order_release);
+  return result;
+}
+
+void MemoryArena::Reset() {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (blocks_.empty()) {
+    return;
+  }
+  // 保留第一个块，下一个查询不用重新分配
+  for (size_t i = 1; i < blocks_.size(); i++) {
+    delete[] reinterpret_cast<char *>(blocks_[i]);
+  }
+  blocks_.resize(1);
+  blocks_[0]->used_.store(0, std::memory_order_relaxed);
+  current_.store(blocks_[0], std::memory_order_release);
+}
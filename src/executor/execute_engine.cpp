@@ -75,6 +75,10 @@ std::unique_ptr<AbstractExecutor> ExecuteEngine::CreateExecutor(ExecuteContext *
 
 dberr_t ExecuteEngine::ExecutePlan(const AbstractPlanNodeRef &plan, std::vector<Row> *result_set, Txn *txn,
                                    ExecuteContext *exec_ctx) {
+  // 只有SELECT的扫描并行执行。DELETE和UPDATE边扫描边修改表，并行扫描可能再次读到刚修改过的记录
+  if (plan->GetType() != PlanType::SeqScan) {
+    exec_ctx->SetScanParallelism(1);
+  }
   // Construct the executor for the abstract plan node
   auto executor = CreateExecutor(exec_ctx, plan);
 
@@ -84,7 +88,9 @@ dberr_t ExecuteEngine::ExecutePlan(const AbstractPlanNodeRef &plan, std::vector<
     Row row{};
     while (executor->Next(&row, &rid)) {
       if (result_set != nullptr) {
-        result_set->push_back(row);
+        // 结果集中的记录放在查询的内存池中，查询结束时一起释放
+        result_set->emplace_back(exec_ctx->GetArena());
+        result_set->back() = row;
       }
     }
   } catch (const exception &ex) {
@@ -104,6 +110,7 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast) {
   auto start_time = std::chrono::system_clock::now();
   unique_ptr<ExecuteContext> context(nullptr);
   if (!current_db_.empty()) context = dbs_[current_db_]->MakeExecuteContext(nullptr);
+  if (context != nullptr) context->SetScanParallelism(scan_parallelism_);
   switch (ast->type_) {
     case kNodeCreateDB:
       return ExecuteCreateDatabase(ast, context.get());
@@ -197,6 +204,9 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast) {
     writer.EndInformation(result_set.size(), duration_time, false);
   }
   std::cout << writer.stream_.rdbuf();
+  // 结果已经输出，查询的内存池可以整体释放
+  result_set.clear();
+  context->GetArena()->Reset();
   // todo:: use shared_ptr for schema
   if (ast->type_ == kNodeSelect)
       delete planner.plan_->OutputSchema();
@@ -229,6 +239,9 @@ void ExecuteEngine::ExecuteInformation(dberr_t result) {
     case DB_KEY_NOT_FOUND:
       cout << "Key not exists." << endl;
       break;
+    case DB_TABLE_FORMAT_OUTDATED:
+      cout << "Table was written in an older format." << endl;
+      break;
     case DB_QUIT:
       cout << "Bye." << endl;
       break;
@@ -335,6 +348,26 @@ dberr_t ExecuteEngine::ExecuteShowTables(pSyntaxNode ast, ExecuteContext *contex
   return DB_SUCCESS;
 }
 
+dberr_t ExecuteEngine::ExecuteVacuum(double min_dead_ratio) {
+#ifdef ENABLE_EXECUTE_DEBUG
+  LOG(INFO) << "ExecuteVacuum" << std::endl;
+#endif
+  if (current_db_.empty()) {
+    cout << "No database selected" << endl;
+    return DB_FAILED;
+  }
+  vector<TableInfo *> tables;
+  dbs_[current_db_]->catalog_mgr_->GetTables(tables);
+  for (auto table : tables) {
+    size_t pages_before = table->GetTableHeap()->GetNumPages();
+    size_t pages_freed = 0;
+    size_t removed = table->GetTableHeap()->Vacuum(min_dead_ratio, &pages_freed);
+    cout << table->GetTableName() << ": removed " << removed << " deleted rows, pages " << pages_before << " -> "
+         << pages_before - pages_freed << endl;
+  }
+  return DB_SUCCESS;
+}
+
 /**
  * TODO: Student Implement
  */
@@ -404,11 +437,31 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext *conte
     cur_def = cur_def->next_;
   }
 
+  // 解析存储布局：USING row（默认）或 USING column（PAX）
+  Schema *schema_obj = new Schema(col_defs);
+  TableLayout layout = TableLayout::kRow;
+  auto layout_node = col_node_list->next_;
+  if (layout_node != nullptr && layout_node->type_ == kNodeTableLayout) {
+    std::string layout_name(layout_node->child_->val_);
+    if (layout_name == "column" || layout_name == "pax") {
+      layout = TableLayout::kPax;
+    } else if (layout_name != "row") {
+      cout << "Unknown table layout " << layout_name << endl;
+      delete schema_obj;
+      return DB_FAILED;
+    }
+  }
+  if (layout == TableLayout::kPax && PaxPage::GetCapacity(schema_obj) == 0) {
+    cout << "Rows of table " << new_table_name << " are too wide for the column layout" << endl;
+    delete schema_obj;
+    return DB_FAILED;
+  }
+
   // 创建表
   auto *catalog_mgr = context->GetCatalog();
-  Schema *schema_obj = new Schema(col_defs);
   TableInfo *tbl_info = nullptr;
-  auto status = catalog_mgr->CreateTable(new_table_name, schema_obj, context->GetTransaction(), tbl_info);
+  auto status =
+      catalog_mgr->CreateTable(new_table_name, schema_obj, context->GetTransaction(), tbl_info, layout);
   if (status != DB_SUCCESS) {
     return status;
   }
@@ -35,13 +35,16 @@ bool IndexScanExecutor::SchemaEqual(const Schema *table_schema, const Schema *ou
 void IndexScanExecutor::TupleTransfer(const Schema *table_schema, const Schema *output_schema, const Row *row,
                                       Row *output_row) {
   const auto &output_columns = output_schema->GetColumns();
-  std::vector<Field> dest_row;
-  dest_row.reserve(output_columns.size());
+  uint32_t data_size = 0;
   for (const auto column : output_columns) {
-    auto idx = column->GetTableInd();
-    dest_row.emplace_back(*row->GetField(idx));
+    data_size += Row::GetDataSize(*row->GetField(column->GetTableInd()));
+  }
+  // 直接拷贝到输出行的缓冲区中
+  output_row->destroy();
+  output_row->Reserve(output_columns.size(), data_size);
+  for (const auto column : output_columns) {
+    output_row->AppendField(*row->GetField(column->GetTableInd()));
   }
-  *output_row = Row(dest_row);
 }
 
 vector<RowId> IndexScanExecutor::IndexScan(AbstractExpressionRef predicate) {
@@ -85,13 +88,19 @@ vector<RowId> IndexScanExecutor::IndexScan(AbstractExpressionRef predicate) {
 bool IndexScanExecutor::Next(Row *row, RowId *rid) {
   auto predicate = plan_->GetPredicate();
   auto table_schema = table_info_->GetSchema();
+  // 谓词的结果与同一个常量比较，不用每条记录都构造一个Field
+  static const Field true_value(kTypeInt, 1);
   while (cursor_ < result_.size()) {
-    auto p_row = new Row(result_[cursor_]);
-    table_info_->GetTableHeap()->GetTuple(p_row, nullptr);
+    // 读出的记录放在复用的行中，不用每次都分配
+    Row *p_row = &table_row_;
+    p_row->SetRowId(result_[cursor_]);
+    if (!table_info_->GetTableHeap()->GetTuple(p_row, nullptr)) {
+      cursor_++;  // 索引中的记录已被删除
+      continue;
+    }
     if (plan_->need_filter_) {
-      if (!predicate->Evaluate(p_row).CompareEquals(Field(kTypeInt, 1))) {
+      if (!predicate->Evaluate(p_row).CompareEquals(true_value)) {
         cursor_++;
-        delete p_row;
         continue;
       }
     }
@@ -101,7 +110,6 @@ bool IndexScanExecutor::Next(Row *row, RowId *rid) {
     } else {
       *row = *p_row;
     }
-    delete p_row;
     cursor_++;
     return true;
   }
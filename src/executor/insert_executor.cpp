@@ -4,6 +4,9 @@
 
 #include "executor/executors/insert_executor.h"
 
+#include <string>
+#include <unordered_set>
+
 InsertExecutor::InsertExecutor(ExecuteContext *exec_ctx, const InsertPlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
     : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
@@ -13,30 +16,60 @@ void InsertExecutor::Init() {
   exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
   schema_ = table_info_->GetSchema();
   exec_ctx_->GetCatalog()->GetTableIndexes(table_info_->GetTableName(), index_info_);
+  batch_inserted_ = false;
+  num_inserted_ = 0;
+  cursor_ = 0;
 }
 
 bool InsertExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
-    Row insert_row;
-    RowId insert_rid;
-    if (child_executor_->Next(&insert_row, &insert_rid)) {
-        for (auto info: index_info_) {
-            Row key_row;
-            insert_row.GetKeyFromRow(table_info_->GetSchema(), info->GetIndexKeySchema(), key_row);
-            std::vector<RowId> result;
-            if (!key_row.GetFields().empty() &&
-                info->GetIndex()->ScanKey(key_row, result, exec_ctx_->GetTransaction()) == DB_SUCCESS) {
-                std::cout << "key already exists" << std::endl;
-                return false;
-            }
-        }
-        if (table_info_->GetTableHeap()->InsertTuple(insert_row, exec_ctx_->GetTransaction())) {
-            Row key_row;
-            for (auto info: index_info_) {  // 更新索引
-                insert_row.GetKeyFromRow(schema_, info->GetIndexKeySchema(), key_row);
-                info->GetIndex()->InsertEntry(key_row, insert_row.GetRowId(), exec_ctx_->GetTransaction());
-            }
-            return true;
-        }
+  if (!batch_inserted_) {
+    num_inserted_ = InsertBatch();
+    batch_inserted_ = true;
+  }
+  if (cursor_ < num_inserted_) {
+    cursor_++;
+    return true;
   }
   return false;
-}
\ No newline at end of file
+}
+
+size_t InsertExecutor::InsertBatch() {
+  std::vector<Row> batch;
+  // 同一批中的键也不能重复，按序列化后的键判断
+  std::vector<std::unordered_set<std::string>> batch_keys(index_info_.size());
+  Row insert_row;
+  RowId insert_rid;
+  while (child_executor_->Next(&insert_row, &insert_rid)) {
+    bool duplicate = false;
+    for (size_t i = 0; i < index_info_.size() && !duplicate; i++) {
+      auto key_schema = index_info_[i]->GetIndexKeySchema();
+      Row key_row;
+      insert_row.GetKeyFromRow(schema_, key_schema, key_row);
+      if (key_row.GetFieldCount() == 0) {
+        continue;
+      }
+      std::vector<RowId> result;
+      std::string key(key_row.GetSerializedSize(key_schema), '\0');
+      key_row.SerializeTo(key.data(), key_schema);
+      duplicate = index_info_[i]->GetIndex()->ScanKey(key_row, result, exec_ctx_->GetTransaction()) == DB_SUCCESS ||
+                  !batch_keys[i].insert(std::move(key)).second;
+    }
+    if (duplicate) {
+      std::cout << "key already exists" << std::endl;
+      break;
+    }
+    batch.push_back(insert_row);
+  }
+
+  // 整批写入表堆，再更新索引
+  size_t inserted = table_info_->GetTableHeap()->InsertTuples(batch, exec_ctx_->GetTransaction(),
+                                                              exec_ctx_->GetBufferRing().get());
+  for (size_t i = 0; i < inserted; i++) {
+    Row key_row;
+    for (auto info : index_info_) {
+      batch[i].GetKeyFromRow(schema_, info->GetIndexKeySchema(), key_row);
+      info->GetIndex()->InsertEntry(key_row, batch[i].GetRowId(), exec_ctx_->GetTransaction());
+    }
+  }
+  return inserted;
+}
@@ -27,46 +27,174 @@ bool SeqScanExecutor::SchemaEqual(const Schema *table_schema, const Schema *outp
   return true;
 }
 
-void SeqScanExecutor::TupleTransfer(const Schema *table_schema, const Schema *output_schema, const Row *row,
+void SeqScanExecutor::TupleTransfer(const Schema *table_schema, const Schema *output_schema, const RowView &row,
                                     Row *output_row) {
   const auto &output_columns = output_schema->GetColumns();
-  std::vector<Field> dest_row;
-  dest_row.reserve(output_columns.size());
+  // 先算出字符串的总长度，输出行的缓冲区最多分配一次，复用时不分配
+  uint32_t data_size = 0;
   for (const auto column : output_columns) {
     auto idx = column->GetTableInd();
-    dest_row.emplace_back(*row->GetField(idx));
+    if (row.GetTypeId(idx) == TypeId::kTypeChar) {
+      uint32_t len;
+      row.GetChars(idx, &len);
+      data_size += len;
+    }
+  }
+  output_row->destroy();
+  output_row->Reserve(output_columns.size(), data_size);
+  for (const auto column : output_columns) {
+    output_row->AppendField(row.GetField(column->GetTableInd()));
   }
-  *output_row = Row(dest_row);
 }
 
+SeqScanExecutor::~SeqScanExecutor() { StopWorkers(); }
+
 void SeqScanExecutor::Init() {
   exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
-  auto first_row = table_info_->GetTableHeap()->Begin(nullptr);
-  iterator_ = (table_info_->GetTableHeap()->Begin(exec_ctx_->GetTransaction()));
   schema_ = plan_->OutputSchema();
   is_schema_same_ = SchemaEqual(table_info_->GetSchema(), schema_);
+  advance_ = false;
+  parallelism_ = exec_ctx_->GetScanParallelism();
+  if (parallelism_ <= 1) {
+    iterator_ = (table_info_->GetTableHeap()->Begin(exec_ctx_->GetTransaction(), exec_ctx_->GetBufferRing()));
+    return;
+  }
+  // 并行扫描：页按morsel分给工作线程，不需要沿着页链表遍历
+  StopWorkers();
+  page_ids_ = table_info_->GetTableHeap()->GetPageIds();
+  next_page_ = 0;
+  results_.clear();
+  batch_.clear();
+  batch_pos_ = 0;
+  running_workers_ = parallelism_;
+  for (size_t i = 0; i < parallelism_; i++) {
+    workers_.emplace_back(&SeqScanExecutor::ScanMorsels, this);
+  }
 }
 
-bool SeqScanExecutor::Next(Row *row, RowId *rid) {
+bool SeqScanExecutor::ScanRow(const RowView &view, Row *row) {
+  // 谓词的结果与同一个常量比较，不用每条记录都构造一个Field
+  static const Field true_value(kTypeInt, 1);
   auto predicate = plan_->GetPredicate();
-  auto table_schema = table_info_->GetSchema();
+  // 谓词直接在页中的元组上求值，只有满足条件的记录才反序列化
+  if (predicate != nullptr && !predicate->Evaluate(view).CompareEquals(true_value)) {
+    return false;
+  }
+  if (!is_schema_same_) {
+    TupleTransfer(table_info_->GetSchema(), schema_, view, row);
+    row->SetRowId(view.GetRowId());
+  } else {
+    view.Materialize(row);
+  }
+  return true;
+}
+
+bool SeqScanExecutor::Next(Row *row, RowId *rid) {
+  if (parallelism_ > 1) {
+    return NextParallel(row, rid);
+  }
+  // 上一次返回的记录被父节点处理完之后才前进，这样父节点对页的修改会在前进时被迭代器发现
+  if (advance_) {
+    ++iterator_;
+    advance_ = false;
+  }
   while (iterator_ != table_info_->GetTableHeap()->End()) {
-    auto p_row = &(*iterator_);
-    if (predicate != nullptr) {
+    // 和并行扫描一样，在页的读锁下求值和复制元组
+    if (!iterator_.RLatchPage()) {
+      iterator_.RUnlatchPage();
+      ++iterator_;
+      continue;
+    }
+    const RowView &view = iterator_.GetRowView();
+    bool selected = ScanRow(view, row);
+    *rid = view.GetRowId();
+    iterator_.RUnlatchPage();
+    if (!selected) {
+      ++iterator_;
+      continue;
+    }
+    advance_ = true;
+    return true;
+  }
+  return false;
+}
+
+bool SeqScanExecutor::NextParallel(Row *row, RowId *rid) {
+  while (batch_pos_ == batch_.size()) {
+    std::unique_lock<std::mutex> lock(results_latch_);
+    results_cv_.wait(lock, [this] { return !results_.empty() || running_workers_ == 0; });
+    if (results_.empty()) {
+      return false;
+    }
+    batch_ = std::move(results_.front());
+    batch_pos_ = 0;
+    results_.pop_front();
+    results_cv_.notify_all();  // 唤醒因结果队列已满而等待的工作线程
+  }
+  *row = std::move(batch_[batch_pos_++]);
+  *rid = row->GetRowId();
+  return true;
+}
 
-      if (!predicate->Evaluate(p_row).CompareEquals(Field(kTypeInt, 1))) {
-        iterator_++;
+void SeqScanExecutor::ScanMorsels() {
+  auto bpm = exec_ctx_->GetBufferPoolManager();
+  auto table_schema = table_info_->GetSchema();
+  auto overflow_store = table_info_->GetTableHeap()->GetOverflowStore();
+  std::vector<RowView> views;
+  std::vector<Row> morsel;
+  // 工作线程生成的记录都从查询的内存池中分配，不用逐条malloc
+  MemoryArena *arena = exec_ctx_->GetArena();
+  while (true) {
+    size_t begin = next_page_.fetch_add(SCAN_MORSEL_PAGES);
+    if (begin >= page_ids_.size()) {
+      break;
+    }
+    size_t end = std::min(begin + SCAN_MORSEL_PAGES, page_ids_.size());
+    for (size_t i = begin; i < end; i++) {
+      auto page = reinterpret_cast<TablePage *>(bpm->FetchPage(page_ids_[i], exec_ctx_->GetBufferRing().get()));
+      if (page == nullptr) {
         continue;
       }
+      page->RLatch();
+      uint32_t num_views = page->GetTupleViews(table_schema, 0, &views, overflow_store);
+      for (uint32_t j = 0; j < num_views; j++) {
+        morsel.emplace_back(arena);
+        if (!ScanRow(views[j], &morsel.back())) {
+          morsel.pop_back();
+        }
+      }
+      page->RUnlatch();
+      bpm->UnpinPage(page_ids_[i], false);
     }
-    *rid = iterator_->GetRowId();
-    if (!is_schema_same_) {
-      TupleTransfer(table_schema, schema_, p_row, row);
-    } else {
-      *row = *p_row;
+    if (morsel.empty()) {
+      continue;
     }
-    iterator_++;
-    return true;
+    std::vector<Row> next_morsel;
+    next_morsel.reserve(morsel.size());
+    // 结果队列满时等待，避免工作线程把整张表都读进内存
+    std::unique_lock<std::mutex> lock(results_latch_);
+    results_cv_.wait(lock, [this] { return results_.size() < 2 * parallelism_ || stop_; });
+    if (stop_) {
+      break;
+    }
+    results_.push_back(std::move(morsel));
+    morsel = std::move(next_morsel);
+    results_cv_.notify_all();
   }
-  return false;
+  std::lock_guard<std::mutex> lock(results_latch_);
+  running_workers_--;
+  results_cv_.notify_all();
+}
+
+void SeqScanExecutor::StopWorkers() {
+  {
+    std::lock_guard<std::mutex> lock(results_latch_);
+    stop_ = true;
+  }
+  results_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+  stop_ = false;
 }
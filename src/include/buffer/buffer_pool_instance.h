@@ -0,0 +1,162 @@
+#ifndef MINISQL_BUFFER_POOL_INSTANCE_H
+#define MINISQL_BUFFER_POOL_INSTANCE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "buffer/buffer_ring.h"
+#include "buffer/replacer.h"
+#include "page/page.h"
+#include "storage/disk_manager.h"
+
+using namespace std;
+
+/**
+ * BufferPoolInstance is one partition of the buffer pool. It owns a fixed set of frames together with its own page
+ * table, free list, replacer and latch, so that threads working on pages of different instances never contend.
+ *
+ * Page allocation and de-allocation on disk is not done here but in BufferPoolManager, which routes every page id to
+ * exactly one instance.
+ *
+ * Dirty frames are kept on a dirty list in the order they were first dirtied. Eviction prefers clean frames, and
+ * CleanPages, which is driven by the background writer of BufferPoolManager, writes dirty unpinned frames back ahead
+ * of time so that a thread which needs a frame rarely has to write one itself.
+ */
+class BufferPoolInstance {
+ public:
+  /**
+   * @param instance_index position of this instance in its BufferPoolManager, selects its part of a BufferRing
+   */
+  explicit BufferPoolInstance(size_t pool_size, DiskManager *disk_manager,
+                              ReplacerType replacer_type = ReplacerType::kLRU, size_t instance_index = 0);
+
+  ~BufferPoolInstance();
+
+  DISALLOW_COPY_AND_MOVE(BufferPoolInstance)
+
+  /**
+   * @param ring if not null, a miss recycles a frame of the ring instead of evicting from the shared pool
+   */
+  Page *FetchPage(page_id_t page_id, BufferRing *ring = nullptr);
+
+  /**
+   * Pin and return a page only if it is already in the pool. Never does any I/O.
+   * @return nullptr if the page is not resident
+   */
+  Page *TryFetchPage(page_id_t page_id);
+
+  /**
+   * Read a page into the pool without pinning it, so that a later FetchPage is a hit. The page is read on an I/O
+   * worker of the DiskManager without holding the latch; a FetchPage of the page in the meantime waits for it.
+   * @param wait whether to return only once the page has been read
+   * @return true if the page is being read, false if it was already resident or every frame is pinned
+   */
+  bool PrefetchPage(page_id_t page_id, BufferRing *ring = nullptr, bool wait = false);
+
+  bool UnpinPage(page_id_t page_id, bool is_dirty);
+
+  bool FlushPage(page_id_t page_id);
+
+  /**
+   * Bring a page which has just been allocated on disk into the pool, zeroed out and pinned.
+   * @return nullptr if all the frames of this instance are pinned
+   */
+  Page *NewPage(page_id_t page_id, BufferRing *ring = nullptr);
+
+  /**
+   * Drop a page from the pool without writing it back.
+   * @return false if the page is still pinned by someone
+   */
+  bool DeletePage(page_id_t page_id);
+
+  /**
+   * Write back every dirty page of this instance, consecutive pages with a single write.
+   */
+  void FlushAllPages();
+
+  /**
+   * Pin the dirty pages among page_ids, or all dirty pages if page_ids is null, mark them clean and append them to
+   * batch, so that the caller can write them together with the pages of other instances and unpin them afterwards.
+   */
+  void PinDirtyPages(const std::vector<page_id_t> *page_ids, std::vector<std::pair<page_id_t, const char *>> *batch);
+
+  bool CheckAllUnpinned();
+
+  /**
+   * Write back dirty unpinned frames, oldest first, until at least clean_ratio of the frames which could be evicted
+   * right now are clean. The pages are copied under the latch and written together through the I/O workers of the
+   * DiskManager without holding it.
+   * @return number of pages written
+   */
+  size_t CleanPages(double clean_ratio);
+
+  inline size_t GetPoolSize() const { return pool_size_; }
+
+  /** @return number of dirty victims written back by the thread which needed the frame */
+  inline size_t GetForegroundWrites() const { return foreground_writes_; }
+
+  /** @return number of pages written back by CleanPages */
+  inline size_t GetBackgroundWrites() const { return background_writes_; }
+
+  /** @return number of FetchPage calls which found the page in the pool */
+  inline size_t GetHits() const { return hits_; }
+
+  /** @return number of FetchPage calls which had to read the page from disk */
+  inline size_t GetMisses() const { return misses_; }
+
+  /** @return number of pages PrefetchPage has finished reading */
+  inline size_t GetPrefetchedPages() const { return prefetched_pages_; }
+
+ private:
+  frame_id_t TryToFindFreePage();
+
+  /**
+   * Find a frame for a page which is read or created through a ring: recycle the oldest frame of the ring if it still
+   * holds the page the ring put there and nobody uses it, otherwise take a frame from the shared pool into the ring.
+   */
+  frame_id_t TryToFindRingFrame(BufferRing *ring, page_id_t page_id);
+
+  void MarkDirty(frame_id_t frame_id);
+
+  void MarkClean(frame_id_t frame_id);
+
+  /**
+   * Block until CleanPages has finished writing the page, so that a read or a newer write of the same page can not be
+   * overtaken by the older copy. Called with latch_ held.
+   */
+  void WaitForCleaning(page_id_t page_id);
+
+  /**
+   * Block until a prefetch has finished reading the page. Called with latch_ held by lock, which is released while
+   * waiting, so the caller has to look the page up afterwards.
+   */
+  void WaitForLoading(std::unique_lock<std::mutex> &lock, page_id_t page_id);
+
+ private:
+  size_t pool_size_;                                 // number of pages in this instance
+  size_t instance_index_;                            // position in the BufferPoolManager
+  Page *pages_;                                      // array of pages
+  DiskManager *disk_manager_;                        // pointer to the disk manager.
+  unordered_map<page_id_t, frame_id_t> page_table_;  // to keep track of pages
+  Replacer *replacer_;                               // to find an unpinned page for replacement
+  list<frame_id_t> free_list_;                       // to find a free page for replacement
+  std::mutex latch_;                                 // to protect shared data structure
+  list<frame_id_t> dirty_list_;                      // dirty frames, oldest first
+  vector<list<frame_id_t>::iterator> dirty_pos_;     // position of every dirty frame in dirty_list_
+  unordered_set<page_id_t> cleaning_pages_;          // pages CleanPages is writing without latch_, guarded by latch_
+  std::mutex cleaning_latch_;                        // held by CleanPages for the duration of those writes
+  unordered_set<page_id_t> loading_pages_;           // pages being prefetched without latch_, guarded by latch_
+  std::condition_variable loading_cv_;               // notified when a prefetch has read its page
+  std::atomic<size_t> foreground_writes_{0};
+  std::atomic<size_t> background_writes_{0};
+  std::atomic<size_t> hits_{0};
+  std::atomic<size_t> misses_{0};
+  std::atomic<size_t> prefetched_pages_{0};
+};
+
+#endif  // MINISQL_BUFFER_POOL_INSTANCE_H
@@ -1,30 +1,87 @@
 #ifndef MINISQL_BUFFER_POOL_MANAGER_H
 #define MINISQL_BUFFER_POOL_MANAGER_H
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <list>
+#include <memory>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
-#include "buffer/lru_replacer.h"
+#include "buffer/buffer_pool_instance.h"
 #include "page/disk_file_meta_page.h"
 #include "page/page.h"
 #include "storage/disk_manager.h"
 
 using namespace std;
 
+/** Reads the id of the next page in a linked page chain from a pinned page. */
+using NextPageFn = page_id_t (*)(Page *page);
+
+/**
+ * BufferPoolManager is partitioned into several BufferPoolInstance, and every page id is hashed to exactly one of
+ * them, so page accesses of different threads only serialize when they hit the same instance.
+ *
+ * An optional background writer thread periodically cleans every instance, so that eviction can usually pick a clean
+ * frame instead of writing a dirty one on the caller's thread.
+ *
+ * PrefetchPages hands page ids to a prefetcher thread which reads them into the pool ahead of a scan. PrefetchChain
+ * hands it the head of a linked page chain instead, which it follows as each page arrives, see ReadAhead.
+ *
+ * FetchPage, NewPage and PrefetchPages optionally take a BufferRing, so that large scans and bulk loads only cycle
+ * through a few frames of their own instead of flushing the working set of everyone else out of the pool.
+ */
 class BufferPoolManager {
  public:
-  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager);
+  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t num_instances = 1,
+                             ReplacerType replacer_type = ReplacerType::kLRU);
 
   ~BufferPoolManager();
 
-  Page *FetchPage(page_id_t page_id);
+  Page *FetchPage(page_id_t page_id, BufferRing *ring = nullptr);
+
+  /**
+   * Pin and return a page only if it is already in the pool, without blocking on I/O.
+   */
+  Page *TryFetchPage(page_id_t page_id);
+
+  /**
+   * Asynchronously read the pages into the pool, unpinned. Pages which are already resident are skipped, and the
+   * request is dropped if the prefetcher is too far behind, so this is only a hint.
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, std::shared_ptr<BufferRing> ring = nullptr);
+
+  /**
+   * Asynchronously read up to length pages of a chain into the pool like PrefetchPages, starting at page_id. The id
+   * of each following page is read with next_page from its predecessor once the prefetcher has loaded it.
+   */
+  void PrefetchChain(page_id_t page_id, size_t length, NextPageFn next_page,
+                     std::shared_ptr<BufferRing> ring = nullptr);
 
   bool UnpinPage(page_id_t page_id, bool is_dirty);
 
   bool FlushPage(page_id_t page_id);
 
-  Page *NewPage(page_id_t &page_id);
+  /**
+   * Write back the dirty pages among page_ids, together with a single write for every run of pages which are
+   * consecutive on disk. Pages which are not in the pool or clean are skipped.
+   */
+  void FlushPages(const std::vector<page_id_t> &page_ids);
+
+  /**
+   * Write back every dirty page of the pool like FlushPages.
+   */
+  void FlushAllPages();
+
+  Page *NewPage(page_id_t &page_id, BufferRing *ring = nullptr);
+
+  /**
+   * Create a bulk access strategy for this pool. The ring must only be used with this pool.
+   */
+  std::shared_ptr<BufferRing> CreateBufferRing(size_t ring_size = DEFAULT_BUFFER_RING_SIZE);
 
   bool DeletePage(page_id_t page_id);
 
@@ -32,50 +89,93 @@ class BufferPoolManager {
 
   bool CheckAllUnpinned();
 
+  /**
+   * Start the background writer, which wakes up every interval_ms and writes back dirty unpinned pages until at least
+   * clean_ratio of the unpinned frames of every instance are clean. Does nothing if it is already running.
+   */
+  void StartBackgroundWriter(double clean_ratio = DEFAULT_BG_WRITER_CLEAN_RATIO,
+                             uint32_t interval_ms = DEFAULT_BG_WRITER_INTERVAL_MS);
+
+  void StopBackgroundWriter();
+
+  /**
+   * Run one round of the background writer on the calling thread.
+   * @return number of pages written
+   */
+  size_t CleanPages(double clean_ratio);
+
+  inline size_t GetPoolSize() const { return pool_size_; }
+
+  inline size_t GetNumInstances() const { return instances_.size(); }
+
+  /** @return number of pages sequential scans should keep prefetched ahead of them, 0 disables read-ahead */
+  inline size_t GetReadAheadWindow() const { return read_ahead_window_; }
+
+  inline void SetReadAheadWindow(size_t window) { read_ahead_window_ = window; }
+
+  /** @return share of FetchPage calls which found the page in the pool */
+  double GetHitRate() const;
+
+  /** @return number of pages read into the pool by the prefetcher */
+  size_t GetPrefetchedPages() const;
+
+  /** @return number of dirty victims written back during eviction by the thread which needed the frame */
+  size_t GetForegroundWrites() const;
+
+  /** @return number of pages written back ahead of eviction by the background writer */
+  size_t GetBackgroundWrites() const;
+
  private:
   /**
    * Allocate new page (operations like create index/table) For now just keep an increasing counter
    */
   page_id_t AllocatePage();
 
+  /**
+   * Write back the dirty pages among page_ids of every instance in one batch, all of them if page_ids is null
+   */
+  void FlushBatch(const std::vector<page_id_t> *page_ids);
+
   /**
    * Deallocate page (operations like drop index/table) Need bitmap in header page for tracking pages
    */
   void DeallocatePage(page_id_t page_id);
 
-  frame_id_t TryToFindFreePage() {
-    frame_id_t frame_id = -1;
-
-    // 首先尝试从free_list_获取
-    if (!free_list_.empty()) {
-      frame_id = free_list_.front();
-      free_list_.pop_front();
-      return frame_id;
-    }
-
-    // 如果没有空闲页，尝试从replacer_获取
-    if (replacer_->Victim(&frame_id)) {
-      // 如果找到victim，检查是否是脏页需要写回
-      if (pages_[frame_id].IsDirty()) {
-        disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
-      }
-      // 从page_table_中移除旧映射
-      page_table_.erase(pages_[frame_id].GetPageId());
-      return frame_id;
-    }
-
-    // 没有可用页
-    return -1;
+  /** A page for the prefetcher, with the number of chain pages to read from it on, itself included. */
+  struct PrefetchRequest {
+    page_id_t page_id;
+    size_t length;
+    NextPageFn next_page;
+    std::shared_ptr<BufferRing> ring;
+  };
+
+  /**
+   * Queue a request and start the prefetcher if needed. Called with prefetch_latch_ held.
+   */
+  void EnqueuePrefetch(PrefetchRequest request);
+
+  /**
+   * @return the instance responsible for the page
+   */
+  inline BufferPoolInstance *GetInstance(page_id_t page_id) {
+    ASSERT(page_id >= 0, "Invalid page id.");
+    return instances_[static_cast<size_t>(page_id) % instances_.size()];
   }
 
  private:
-  size_t pool_size_;                                 // number of pages in buffer pool
-  Page *pages_;                                      // array of pages
-  DiskManager *disk_manager_;                        // pointer to the disk manager.
-  unordered_map<page_id_t, frame_id_t> page_table_;  // to keep track of pages
-  Replacer *replacer_;                               // to find an unpinned page for replacement
-  list<frame_id_t> free_list_;                       // to find a free page for replacement
-  recursive_mutex latch_;                            // to protect shared data structure
+  size_t pool_size_;                             // number of pages in buffer pool
+  DiskManager *disk_manager_;                    // pointer to the disk manager.
+  std::vector<BufferPoolInstance *> instances_;  // partitions of the pool, indexed by page_id % size
+  std::thread bg_writer_;                        // background writer, not joinable if it is not running
+  std::mutex bg_latch_;                          // protects bg_stop_
+  std::condition_variable bg_cv_;                // wakes the background writer up early to stop it
+  bool bg_stop_{false};
+  std::atomic<size_t> read_ahead_window_{DEFAULT_READ_AHEAD_WINDOW};
+  std::thread prefetcher_;                       // started by the first PrefetchPages
+  std::mutex prefetch_latch_;                    // protects prefetch_queue_ and prefetch_stop_
+  std::condition_variable prefetch_cv_;
+  std::deque<PrefetchRequest> prefetch_queue_;   // pages waiting for the prefetcher
+  bool prefetch_stop_{false};
 };
 
 #endif  // MINISQL_BUFFER_POOL_MANAGER_H
@@ -0,0 +1,53 @@
+#ifndef MINISQL_BUFFER_RING_H
+#define MINISQL_BUFFER_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <vector>
+
+#include "common/config.h"
+
+using namespace std;
+
+/**
+ * BufferRing is a bulk access strategy: a small private ring of frames which a one-pass scan or a bulk load recycles
+ * for the pages it reads or creates, instead of evicting the shared working set. Pages which are already in the pool
+ * are used where they are, only misses go through the ring.
+ *
+ * A ring is created by BufferPoolManager::CreateBufferRing and split evenly over the instances of that pool. The
+ * pool records how many frames the ring took from the shared pool and how often it recycled one of them.
+ */
+class BufferRing {
+  friend class BufferPoolManager;
+  friend class BufferPoolInstance;
+
+ public:
+  /** @return number of frames the ring may hold */
+  inline size_t GetRingSize() const { return ring_size_; }
+
+  /** @return number of frames the ring took from the shared pool */
+  inline size_t GetFramesUsed() const { return frames_used_; }
+
+  /** @return number of misses served by recycling a frame of the ring */
+  inline size_t GetReuses() const { return reuses_; }
+
+  BufferRing(size_t ring_size, size_t num_instances)
+      : ring_size_(ring_size),
+        instance_ring_size_(std::max(static_cast<size_t>(1), (ring_size + num_instances - 1) / num_instances)),
+        slots_(num_instances) {}
+
+ private:
+  struct Slot {
+    frame_id_t frame_id_;
+    page_id_t page_id_;  // page the ring put into the frame, the frame is only recycled if it still holds it
+  };
+
+  size_t ring_size_;
+  size_t instance_ring_size_;     // frames per instance
+  vector<deque<Slot>> slots_;     // per instance, oldest first, guarded by the latch of that instance
+  std::atomic<size_t> frames_used_{0};
+  std::atomic<size_t> reuses_{0};
+};
+
+#endif  // MINISQL_BUFFER_RING_H
@@ -32,6 +32,8 @@ class CLOCKReplacer : public Replacer {
 
   bool Victim(frame_id_t *frame_id) override;
 
+  bool Victim(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &prefer) override;
+
   void Pin(frame_id_t frame_id) override;
 
   void Unpin(frame_id_t frame_id) override;
@@ -39,9 +41,12 @@ class CLOCKReplacer : public Replacer {
   size_t Size() override;
 
  private:
+  std::mutex latch_;
   size_t capacity;
-  list<frame_id_t> clock_list;               // replacer中可以被替换的数据页
-  map<frame_id_t, frame_id_t> clock_status;  // 数据页的存储状态
+  size_t size_{0};           // replacer中可以被替换的数据页数量
+  size_t hand_{0};           // 时钟指针
+  vector<bool> evictable_;   // 数据页是否在replacer中
+  vector<bool> referenced_;  // 数据页的引用位
 };
 
-#endif  // MINISQL_CLOCK_REPLACER_H
\ No newline at end of file
+#endif  // MINISQL_CLOCK_REPLACER_H
@@ -0,0 +1,72 @@
+#ifndef MINISQL_LRU_K_REPLACER_H
+#define MINISQL_LRU_K_REPLACER_H
+
+#include <deque>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+using namespace std;
+
+/**
+ * LRUKReplacer evicts the frame whose k-th most recent access lies furthest in the past. Frames accessed fewer than
+ * k times have an infinite backward k-distance and go first, oldest first, so pages touched only by a scan do not
+ * push out pages which are used again and again.
+ *
+ * Consecutive accesses to the same frame count as one correlated reference, otherwise a scan which fetches a page
+ * once per tuple would look like repeated use.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k number of accesses remembered per frame
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = 2);
+
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  bool Victim(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &prefer) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+ private:
+  struct FrameInfo {
+    deque<size_t> history_;  // timestamps of the last k accesses, oldest first
+    size_t key_{0};          // position in its queue while evictable
+    bool evictable_{false};
+  };
+
+  /** Put an evictable frame into the queue matching its history. */
+  void Enqueue(frame_id_t frame_id);
+
+  /** Take a frame out of its queue. */
+  void Dequeue(frame_id_t frame_id);
+
+  void Evict(frame_id_t frame_id);
+
+  std::mutex latch_;
+  size_t k_;
+  size_t current_timestamp_{0};
+  frame_id_t last_accessed_{INVALID_FRAME_ID};
+  vector<FrameInfo> frames_;
+  set<pair<size_t, frame_id_t>> history_queue_;  // evictable frames with fewer than k accesses, by first access
+  set<pair<size_t, frame_id_t>> cache_queue_;    // evictable frames with k accesses, by k-th most recent access
+};
+
+#endif  // MINISQL_LRU_K_REPLACER_H
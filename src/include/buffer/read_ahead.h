@@ -0,0 +1,40 @@
+#ifndef MINISQL_READ_AHEAD_H
+#define MINISQL_READ_AHEAD_H
+
+#include <memory>
+
+#include "buffer/buffer_pool_manager.h"
+
+/**
+ * ReadAhead keeps the next pages of a linked page chain (table heap pages, b+ tree leaves) queued for prefetching
+ * while a scan walks the chain, up to the read-ahead window of the buffer pool.
+ *
+ * The id of a page is only known once its predecessor is in memory, so the window is handed to the prefetcher as a
+ * chain request, which it follows page by page. The window is topped up once the scan has used half of it. The scan
+ * itself never waits for read-ahead.
+ *
+ * If the scan runs through a BufferRing, the prefetched pages are read into the same ring.
+ */
+class ReadAhead {
+ public:
+  explicit ReadAhead(BufferPoolManager *buffer_pool_manager = nullptr, NextPageFn next_page = nullptr,
+                     std::shared_ptr<BufferRing> ring = nullptr)
+      : buffer_pool_manager_(buffer_pool_manager), next_page_(next_page), ring_(std::move(ring)) {}
+
+  /**
+   * Called when the scan has moved onto a page, while that page is still resident.
+   */
+  void Advance(page_id_t page_id);
+
+ private:
+  /** @return successor of a resident page, INVALID_PAGE_ID if it is not resident */
+  page_id_t PeekNextPageId(page_id_t page_id);
+
+  BufferPoolManager *buffer_pool_manager_;
+  NextPageFn next_page_;
+  std::shared_ptr<BufferRing> ring_;
+  page_id_t expected_{INVALID_PAGE_ID};  // successor of the page the scan is on
+  size_t ahead_{0};                       // pages after the current one already handed to the prefetcher
+};
+
+#endif  // MINISQL_READ_AHEAD_H
@@ -1,10 +1,22 @@
 #ifndef MINISQL_REPLACER_H
 #define MINISQL_REPLACER_H
 
+#include <algorithm>
 #include <cstdio>
+#include <functional>
 
 #include "common/config.h"
 
+/**
+ * Replacement policies a buffer pool can be built with.
+ */
+enum class ReplacerType {
+  kLRU,       // least recently unpinned, see LRUReplacer
+  kLRUK,      // largest backward k-distance, see LRUKReplacer
+  kTwoQueue,  // simplified 2Q, see TwoQueueReplacer
+  kClock,     // second chance, see CLOCKReplacer
+};
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -21,6 +33,16 @@ class Replacer {
    */
   virtual bool Victim(frame_id_t *frame_id) = 0;
 
+  /**
+   * Remove a victim frame, but look at the next few candidates in eviction order first and take the first one
+   * accepted by prefer, e.g. a frame which can be evicted without a write. At most PREFER_SCAN_DEPTH candidates and
+   * a quarter of the replacer are looked at, so recently used frames are not evicted. Falls back to the plain victim.
+   * @param[out] frame_id id of frame that was removed
+   * @param prefer predicate selecting the frames which should be evicted first
+   * @return true if a victim frame was found, false otherwise
+   */
+  virtual bool Victim(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &prefer) = 0;
+
   /**
    * Pins a frame, indicating that it should not be victimized until it is unpinned.
    * @param frame_id the id of the frame to pin
@@ -33,8 +55,29 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Record that the page in a frame has been accessed by a user of the pool. Read-ahead and other internal pins are
+   * not reported. Policies which only look at the unpin order ignore it.
+   * @param frame_id the id of the accessed frame
+   */
+  virtual void RecordAccess(frame_id_t /*frame_id*/) {}
+
+  /**
+   * Forget a frame whose page has been dropped from the pool, together with any access history of it.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
+
+  static constexpr size_t PREFER_SCAN_DEPTH = 64;  // candidates looked at before falling back to the plain victim
+
+ protected:
+  /** @return number of candidates to look at in Victim(frame_id, prefer) when size frames can be evicted */
+  static inline size_t PreferScanDepth(size_t size) {
+    return std::min(PREFER_SCAN_DEPTH, std::max(static_cast<size_t>(1), size / 4));
+  }
 };
 
 #endif  // MINISQL_REPLACER_H
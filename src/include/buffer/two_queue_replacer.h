@@ -0,0 +1,70 @@
+#ifndef MINISQL_TWO_QUEUE_REPLACER_H
+#define MINISQL_TWO_QUEUE_REPLACER_H
+
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+using namespace std;
+
+/**
+ * TwoQueueReplacer implements the simplified 2Q policy. A frame accessed once sits in the FIFO queue A1, and moves to
+ * the LRU queue Am when it is accessed again. Victims come from A1 as long as it holds more than its share of the
+ * pool, so a scan only cycles through A1 and leaves the hot pages in Am alone.
+ *
+ * The replacer only knows frames, not pages, so there is no ghost queue of recently evicted pages as in full 2Q.
+ * Consecutive accesses to the same frame count as one correlated reference.
+ */
+class TwoQueueReplacer : public Replacer {
+ public:
+  /**
+   * Create a new TwoQueueReplacer.
+   * @param num_pages the maximum number of pages the TwoQueueReplacer will be required to store
+   * @param a1_ratio share of the pages A1 may hold before victims are taken from it first
+   */
+  explicit TwoQueueReplacer(size_t num_pages, double a1_ratio = 0.25);
+
+  ~TwoQueueReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  bool Victim(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &prefer) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+ private:
+  struct FrameInfo {
+    size_t key_{0};        // first access while in A1, last access while in Am
+    bool accessed_{false};
+    bool in_am_{false};
+    bool evictable_{false};
+  };
+
+  void Enqueue(frame_id_t frame_id);
+
+  void Dequeue(frame_id_t frame_id);
+
+  void Evict(frame_id_t frame_id);
+
+  std::mutex latch_;
+  size_t a1_max_size_;
+  size_t current_timestamp_{0};
+  frame_id_t last_accessed_{INVALID_FRAME_ID};
+  vector<FrameInfo> frames_;
+  set<pair<size_t, frame_id_t>> a1_;  // evictable frames accessed once, by first access
+  set<pair<size_t, frame_id_t>> am_;  // evictable frames accessed again, by last access
+};
+
+#endif  // MINISQL_TWO_QUEUE_REPLACER_H
@@ -70,13 +70,19 @@ class CatalogMeta {
  *
  */
 class CatalogManager {
+  friend class ExecuteEngine;
+
  public:
   explicit CatalogManager(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
                           bool init);
 
   ~CatalogManager();
 
-  dberr_t CreateTable(const std::string &table_name, TableSchema *schema, Txn *txn, TableInfo *&table_info);
+  /**
+   * @param layout how the tuples are laid out in the pages of the table heap
+   */
+  dberr_t CreateTable(const std::string &table_name, TableSchema *schema, Txn *txn, TableInfo *&table_info,
+                      TableLayout layout = TableLayout::kRow);
 
   dberr_t GetTable(const std::string &table_name, TableInfo *&table_info);
 
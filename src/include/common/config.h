@@ -13,11 +13,25 @@ static constexpr int META_PAGE_ID = 0;          // physical page id of the disk
 static constexpr int CATALOG_META_PAGE_ID = 0;  // logical page id of the catalog meta data
 static constexpr int INDEX_ROOTS_PAGE_ID = 1;   // logical page id of the index roots
 
-static constexpr int PAGE_SIZE = 4096;                  // size of a data page in byte
-static constexpr int DEFAULT_BUFFER_POOL_SIZE = 20480;  // default size of buffer pool
+static constexpr int PAGE_SIZE = 4096;                    // size of a data page in byte
+static constexpr int DEFAULT_BUFFER_POOL_SIZE = 20480;    // default size of buffer pool
+static constexpr int DEFAULT_BUFFER_POOL_INSTANCES = 16;  // default number of buffer pool partitions
+
+static constexpr double DEFAULT_BG_WRITER_CLEAN_RATIO = 0.25;  // fraction of unpinned frames kept clean
+static constexpr uint32_t DEFAULT_BG_WRITER_INTERVAL_MS = 50;   // how often the background writer wakes up
+static constexpr size_t DEFAULT_READ_AHEAD_WINDOW = 8;          // pages prefetched ahead of a sequential scan
+static constexpr size_t DEFAULT_BUFFER_RING_SIZE = 32;          // frames a bulk scan or load may recycle
+static constexpr size_t DEFAULT_IO_WORKERS = 4;                 // threads serving asynchronous page I/O
+static constexpr size_t DEFAULT_SCAN_PARALLELISM = 1;           // threads of a sequential scan, 1 scans inline
+static constexpr size_t SCAN_MORSEL_PAGES = 16;                 // heap pages a parallel scan worker claims at once
+static constexpr double DEFAULT_VACUUM_DEAD_RATIO = 0.2;        // share of deleted tuple bytes that makes VACUUM compact
+static constexpr size_t ARENA_BLOCK_SIZE = 64 * 1024;           // bytes the memory arena of a query mallocs at once
+static constexpr int KEY_SEARCH_SCAN_KEYS = 16;                 // fixed width keys a page search scans, not bisects
 
 static constexpr uint32_t FIELD_NULL_LEN = UINT32_MAX;
-static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;  // max length of varchar
+static constexpr uint32_t VARCHAR_MAX_LEN = 16 * PAGE_SIZE;       // max length of varchar
+static constexpr uint32_t TOAST_ROW_THRESHOLD = PAGE_SIZE / 4;    // larger rows move char fields to overflow pages
+static constexpr uint32_t FIELD_OVERFLOW_FLAG = 1U << 31;         // set in the length of a char field stored out of line
 
 // static std::string DB_META_FILE = "minisql.meta.db";
 
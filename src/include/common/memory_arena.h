@@ -0,0 +1,81 @@
+#ifndef MINISQL_MEMORY_ARENA_H
+#define MINISQL_MEMORY_ARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+/**
+ * MemoryArena hands out memory from large blocks and frees all of it at once, so that the many small objects a query
+ * creates (rows returned by parallel scans, result rows, ...) cost a pointer bump instead of a malloc and a free each.
+ * It works with the ALLOC macros, e.g. ALLOC_P(arena, Field)(TypeId::kTypeInt, 1).
+ *
+ * Memory is never given back before Reset, and objects placed in the arena are not destructed by it, so it is meant
+ * for objects which do not own other memory and which do not outlive the query. Allocate may be called by several
+ * threads at the same time: they bump the offset of the current block atomically, and only take a latch to add a block.
+ */
+class MemoryArena {
+ public:
+  /**
+   * @param block_size size of the blocks the arena allocates, larger requests get a block of their own
+   */
+  explicit MemoryArena(size_t block_size = ARENA_BLOCK_SIZE) : block_size_(block_size) {}
+
+  ~MemoryArena();
+
+  DISALLOW_COPY_AND_MOVE(MemoryArena)
+
+  /**
+   * @return size bytes aligned to alignment, valid until the next Reset
+   */
+  void *Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+  /**
+   * Free everything allocated so far. The first block is kept for the allocations which follow. Must not be called
+   * while other threads allocate.
+   */
+  void Reset();
+
+  /** @return number of Allocate calls since the arena was created */
+  inline size_t GetAllocations() const { return allocations_; }
+
+  /** @return number of bytes handed out since the arena was created */
+  inline size_t GetBytesAllocated() const { return bytes_allocated_; }
+
+  /** @return number of blocks taken from the heap since the arena was created, the only mallocs of the arena */
+  inline size_t GetBlockAllocations() const { return block_allocations_; }
+
+ private:
+  /** Header at the start of every block, followed by its memory. */
+  struct Block {
+    explicit Block(size_t size) : size_(size) {}
+
+    char *Data() { return reinterpret_cast<char *>(this) + HEADER_SIZE; }
+
+    /** @return size bytes aligned to alignment from this block, nullptr if they do not fit */
+    char *TryAllocate(size_t size, size_t alignment);
+
+    size_t size_;                  // bytes of memory after the header
+    std::atomic<size_t> used_{0};  // bytes of memory handed out, bumped by compare and swap
+  };
+
+  static constexpr size_t HEADER_SIZE =
+      (sizeof(Block) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+  /** @return a new block with size bytes of memory, added to blocks_. Called with latch_ held. */
+  Block *NewBlock(size_t size);
+
+  size_t block_size_;
+  std::mutex latch_;                       // protects blocks_ and serializes adding a block
+  std::vector<Block *> blocks_;            // every allocated block, the first one is kept by Reset
+  std::atomic<Block *> current_{nullptr};  // block small allocations are bumped from
+  std::atomic<size_t> allocations_{0};
+  std::atomic<size_t> bytes_allocated_{0};
+  std::atomic<size_t> block_allocations_{0};
+};
+
+#endif  // MINISQL_MEMORY_ARENA_H
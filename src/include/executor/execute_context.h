@@ -5,9 +5,12 @@
 #ifndef MINISQL_EXECUTE_CONTEXT_H
 #define MINISQL_EXECUTE_CONTEXT_H
 
+#include <algorithm>
+
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/catalog.h"
 #include "common/macros.h"
+#include "common/memory_arena.h"
 #include "concurrency/txn.h"
 
 class ExecuteContext {
@@ -19,7 +22,10 @@ class ExecuteContext {
    * @param bpm The buffer pool manager that the executor uses
    */
   ExecuteContext(Txn *transaction, CatalogManager *catalog, BufferPoolManager *bpm)
-      : transaction_(transaction), catalog_{catalog}, bpm_{bpm} {}
+      : transaction_(transaction),
+        catalog_{catalog},
+        bpm_{bpm},
+        buffer_ring_{bpm == nullptr ? nullptr : bpm->CreateBufferRing()} {}
 
   ~ExecuteContext() = default;
 
@@ -34,6 +40,19 @@ class ExecuteContext {
   /** @return the buffer pool manager */
   BufferPoolManager *GetBufferPoolManager() { return bpm_; }
 
+  /** @return the bulk access strategy sequential scans and inserts of the query read and create pages through */
+  const std::shared_ptr<BufferRing> &GetBufferRing() const { return buffer_ring_; }
+
+  /** @return number of threads a sequential scan of the query may use */
+  size_t GetScanParallelism() const { return scan_parallelism_; }
+
+  void SetScanParallelism(size_t scan_parallelism) { scan_parallelism_ = std::max<size_t>(1, scan_parallelism); }
+
+  /**
+   * @return the arena the rows and temporaries of the query are allocated from, reset when the query is done
+   */
+  MemoryArena *GetArena() { return &arena_; }
+
  private:
   /** The recovery context associated with this executor context */
   Txn *transaction_;
@@ -41,6 +60,12 @@ class ExecuteContext {
   CatalogManager *catalog_;
   /** The buffer pool manager associated with this executor context */
   BufferPoolManager *bpm_;
+  /** The buffer ring shared by the bulk page accesses of the query */
+  std::shared_ptr<BufferRing> buffer_ring_;
+  /** The degree of parallelism of sequential scans, set from the session. Plans that modify a table scan serially */
+  size_t scan_parallelism_{DEFAULT_SCAN_PARALLELISM};
+  /** The memory arena of the query */
+  MemoryArena arena_;
 };
 
 #endif  // MINISQL_EXECUTE_CONTEXT_H
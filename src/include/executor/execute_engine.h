@@ -1,6 +1,7 @@
 #ifndef MINISQL_EXECUTE_ENGINE_H
 #define MINISQL_EXECUTE_ENGINE_H
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -40,6 +41,20 @@ class ExecuteEngine {
 
   void ExecuteInformation(dberr_t result);
 
+  /**
+   * Set the number of threads the sequential scans of the following statements of this session may use, morsels of
+   * pages are then scanned in parallel and the rows come out in no particular order.
+   */
+  void SetScanParallelism(size_t scan_parallelism) { scan_parallelism_ = std::max<size_t>(1, scan_parallelism); }
+
+  size_t GetScanParallelism() const { return scan_parallelism_; }
+
+  /**
+   * VACUUM: compact the pages of the tables of the current database in which deleted tuples take at least
+   * min_dead_ratio of the space, and free the pages left empty. The parser has no statement for it yet.
+   */
+  dberr_t ExecuteVacuum(double min_dead_ratio = DEFAULT_VACUUM_DEAD_RATIO);
+
  private:
   static std::unique_ptr<AbstractExecutor> CreateExecutor(ExecuteContext *exec_ctx, const AbstractPlanNodeRef &plan);
 
@@ -76,6 +91,7 @@ class ExecuteEngine {
  private:
   std::unordered_map<std::string, DBStorageEngine *> dbs_; /** all opened databases */
   std::string current_db_;                                 /** current database */
+  size_t scan_parallelism_{DEFAULT_SCAN_PARALLELISM};      /** threads of a sequential scan */
 };
 
 #endif  // MINISQL_EXECUTE_ENGINE_H
@@ -47,4 +47,5 @@ class IndexScanExecutor : public AbstractExecutor {
   vector<RowId> result_;
   size_t cursor_ = 0;
   bool is_schema_same_;
+  Row table_row_;  // row of the table read for the current rid, reused for every rid
 };
\ No newline at end of file
@@ -12,7 +12,8 @@
 /**
  * InsertExecutor executes an insert on a table.
  *
- * Inserted values are always pulled from a child executor.
+ * Inserted values are always pulled from a child executor. All of them are pulled by the first call to Next and
+ * inserted into the table heap as one batch, later calls only report the inserted rows one by one.
  */
 class InsertExecutor : public AbstractExecutor {
  public:
@@ -42,12 +43,22 @@ class InsertExecutor : public AbstractExecutor {
   const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
 
  private:
+  /**
+   * Pull the rows from the child executor up to the first one whose key already exists, insert them into the table
+   * heap in one batch and add them to the indexes.
+   * @return number of rows inserted
+   */
+  size_t InsertBatch();
+
   /** The insert plan node to be executed*/
   const InsertPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> child_executor_;
   TableInfo *table_info_{};
   const Schema *schema_{};
   std::vector<IndexInfo *> index_info_;
+  bool batch_inserted_{false};
+  size_t num_inserted_{0};
+  size_t cursor_{0};
 };
 
 #endif  // MINISQL_INSERT_EXECUTOR_H
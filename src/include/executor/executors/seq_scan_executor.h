@@ -5,6 +5,11 @@
 #ifndef MINISQL_SEQ_SCAN_EXECUTOR_H
 #define MINISQL_SEQ_SCAN_EXECUTOR_H
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "executor/execute_context.h"
@@ -13,6 +18,10 @@
 
 /**
  * The SeqScanExecutor executor executes a sequential table scan.
+ *
+ * If the scan parallelism of the execute context is greater than 1, the pages of the table are handed out in morsels
+ * of SCAN_MORSEL_PAGES to that many worker threads, which apply the predicate and the projection and queue the rows
+ * of every morsel for Next. The rows then come out in no particular order.
  */
 class SeqScanExecutor : public AbstractExecutor {
  public:
@@ -23,6 +32,8 @@ class SeqScanExecutor : public AbstractExecutor {
    */
   SeqScanExecutor(ExecuteContext *exec_ctx, const SeqScanPlanNode *plan);
 
+  ~SeqScanExecutor() override;
+
   /** Initialize the sequential scan */
   void Init() override;
 
@@ -39,15 +50,42 @@ class SeqScanExecutor : public AbstractExecutor {
 
   bool SchemaEqual(const Schema *table_schema, const Schema *output_schema);
 
-  void TupleTransfer(const Schema *table_schema, const Schema *output_schema, const Row *row, Row *output_row);
+  void TupleTransfer(const Schema *table_schema, const Schema *output_schema, const RowView &row, Row *output_row);
 
  private:
+  /**
+   * Apply the predicate to a tuple and project it into row if it qualifies.
+   * @return whether the tuple qualifies
+   */
+  bool ScanRow(const RowView &view, Row *row);
+
+  /** Next of a parallel scan, returns the rows queued by the workers. */
+  bool NextParallel(Row *row, RowId *rid);
+
+  /** Body of a worker of a parallel scan, scans morsels until there are none left or the scan is stopped. */
+  void ScanMorsels();
+
+  /** Stop the workers of a parallel scan and wait for them. */
+  void StopWorkers();
+
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
   TableInfo *table_info_{};
   TableIterator iterator_;
   const Schema *schema_{};
   bool is_schema_same_;
+  bool advance_{false};  // the iterator is still on the row returned last
+  size_t parallelism_{1};
+  std::vector<page_id_t> page_ids_;           // pages of the table, split into morsels by a parallel scan
+  std::atomic<size_t> next_page_{0};          // first page of the next morsel
+  std::vector<std::thread> workers_;
+  std::mutex results_latch_;                  // protects results_, running_workers_ and stop_
+  std::condition_variable results_cv_;
+  std::deque<std::vector<Row>> results_;      // rows of the morsels scanned by the workers, not yet returned
+  size_t running_workers_{0};
+  bool stop_{false};
+  std::vector<Row> batch_;                    // rows of the morsel Next is returning
+  size_t batch_pos_{0};                       // position of the next row to return in batch_
 };
 
 #endif  // MINISQL_SEQ_SCAN_EXECUTOR_H
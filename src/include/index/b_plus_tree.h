@@ -1,10 +1,13 @@
 #ifndef MINISQL_B_PLUS_TREE_H
 #define MINISQL_B_PLUS_TREE_H
 
+#include <atomic>
+#include <fstream>
 #include <queue>
 #include <string>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "concurrency/txn.h"
 #include "index/index_iterator.h"
 #include "page/b_plus_tree_internal_page.h"
@@ -20,13 +23,25 @@
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * The tree is a template over its key manager: BPlusTree works with any key schema, FixedKeyBPlusTree with keys of a
+ * single int or float column, whose comparisons it inlines into the page searches.
+ *
+ * Concurrent sessions may share a tree. Lookups follow Lehman and Yao: every page has a high key and a right sibling
+ * link, so a lookup holds one page latch at a time and moves right when a split moved its key after it read the child
+ * pointer. Inserts and removes first descend optimistically, read latching internal pages and write latching only the
+ * leaf; when the leaf would split or underflow they restart pessimistically, write latching the path and releasing the
+ * ancestors above each safe page. Merges and redistributions move keys left, where a lookup cannot follow them, so
+ * removes that may do them exclude lookups with smo_latch_. Index iterators copy a leaf under its latch and find the
+ * next one by looking up its high key. Destroy does not latch.
  */
-class BPlusTree {
+template <typename KeyManagerType>
+class BasicBPlusTree {
   using InternalPage = BPlusTreeInternalPage;
   using LeafPage = BPlusTreeLeafPage;
 
  public:
-  explicit BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &comparator,
+  explicit BasicBPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManagerType &comparator,
                      int leaf_max_size = UNDEFINED_SIZE, int internal_max_size = UNDEFINED_SIZE);
 
   // Returns true if this B+ tree has no keys and values.
@@ -47,8 +62,8 @@ class BPlusTree {
 
   IndexIterator End();
 
-  // expose for test purpose
-  Page *FindLeafPage(const GenericKey *key, page_id_t page_id = INVALID_PAGE_ID, bool leftMost = false);
+  // expose for test purpose, the returned leaf is pinned but not latched
+  Page *FindLeafPage(const GenericKey *key, bool leftMost = false);
 
   // used to check whether all pages are unpinned
   bool Check();
@@ -68,6 +83,31 @@ class BPlusTree {
   }
 
  private:
+  enum class Operation { kInsert, kRemove };
+
+  enum class LeafTarget { kKey, kLeftMost, kRightMost };
+
+  /** Pages a pessimistic insert or remove holds write latched, root side first, and the pages it frees. */
+  struct WriteSet {
+    bool root_latched{false};
+    std::vector<Page *> pages;
+    std::vector<page_id_t> deleted;
+  };
+
+  Page *FindLeafPageRead(const GenericKey *key, LeafTarget target);
+
+  IndexIterator::FindLeafFn LeafFinder();
+
+  Page *FindLeafPageOptimistic(const GenericKey *key, bool &is_root);
+
+  Page *FindLeafPageWrite(const GenericKey *key, Operation op, WriteSet &write_set);
+
+  bool IsSafe(BPlusTreePage *node, Operation op, bool is_root) const;
+
+  void ReleaseAncestors(WriteSet &write_set);
+
+  void ReleaseWriteSet(WriteSet &write_set);
+
   void StartNewTree(GenericKey *key, const RowId &value);
 
   bool InsertIntoLeaf(GenericKey *key, const RowId &value, Txn *transaction = nullptr);
@@ -79,19 +119,17 @@ class BPlusTree {
   InternalPage *Split(InternalPage *node, Txn *transaction);
 
   template <typename N>
-  bool CoalesceOrRedistribute(N *&node, Txn *transaction = nullptr);
+  void CoalesceOrRedistribute(N *node, WriteSet &write_set);
 
-  bool Coalesce(InternalPage *&neighbor_node, InternalPage *&node, InternalPage *&parent, int index,
-                Txn *transaction = nullptr);
+  void Coalesce(LeafPage *left, LeafPage *right, InternalPage *parent, int index, WriteSet &write_set);
 
-  bool Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage *&parent, int index,
-                Txn *transaction = nullptr);
+  void Coalesce(InternalPage *left, InternalPage *right, InternalPage *parent, int index, WriteSet &write_set);
 
-  void Redistribute(LeafPage *neighbor_node, LeafPage *node, int index);
+  void Redistribute(LeafPage *neighbor_node, LeafPage *node, InternalPage *parent, int index);
 
-  void Redistribute(InternalPage *neighbor_node, InternalPage *node, int index);
+  void Redistribute(InternalPage *neighbor_node, InternalPage *node, InternalPage *parent, int index);
 
-  bool AdjustRoot(BPlusTreePage *node);
+  void AdjustRoot(BPlusTreePage *node, WriteSet &write_set);
 
   void UpdateRootPageId(int insert_record = 0);
 
@@ -102,11 +140,17 @@ class BPlusTree {
 
   // member variable
   index_id_t index_id_;
-  page_id_t root_page_id_{INVALID_PAGE_ID};
+  std::atomic<page_id_t> root_page_id_{INVALID_PAGE_ID};  // written under root_latch_, lookups read it without
+  ReaderWriterLatch root_latch_;
+  ReaderWriterLatch smo_latch_;  // shared by lookups, exclusive for removes that may merge or redistribute
   BufferPoolManager *buffer_pool_manager_;
-  KeyManager processor_;
+  KeyManagerType processor_;
   int leaf_max_size_;
   int internal_max_size_;
 };
 
+using BPlusTree = BasicBPlusTree<KeyManager>;
+
+using FixedKeyBPlusTree = BasicBPlusTree<FixedKeyManager>;
+
 #endif  // MINISQL_B_PLUS_TREE_H
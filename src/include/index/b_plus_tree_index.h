@@ -5,9 +5,14 @@
 #include "index/generic_key.h"
 #include "index/index.h"
 
-class BPlusTreeIndex : public Index {
+/**
+ * Index on a B+ tree whose keys are handled by KeyManagerType, see BasicBPlusTree.
+ */
+template <typename KeyManagerType>
+class BasicBPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager);
+  BasicBPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
+                      BufferPoolManager *buffer_pool_manager);
 
   dberr_t InsertEntry(const Row &key, RowId row_id, Txn *txn) override;
 
@@ -25,9 +30,13 @@ class BPlusTreeIndex : public Index {
 
  protected:
   // comparator for key
-  KeyManager processor_;
+  KeyManagerType processor_;
   // container
-  BPlusTree container_;
+  BasicBPlusTree<KeyManagerType> container_;
 };
 
+using BPlusTreeIndex = BasicBPlusTreeIndex<KeyManager>;
+
+using FixedKeyBPlusTreeIndex = BasicBPlusTreeIndex<FixedKeyManager>;
+
 #endif  // MINISQL_B_PLUS_TREE_INDEX_H
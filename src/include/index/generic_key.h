@@ -1,16 +1,30 @@
 #ifndef MINISQL_GENERIC_KEY_H
 #define MINISQL_GENERIC_KEY_H
 
+#include <cstdint>
 #include <cstring>
 
+#include "index/key_search.h"
 #include "record/field.h"
 #include "record/row.h"
 
 class GenericKey {
   friend class KeyManager;
+  friend class FixedKeyManager;
   char data[0];
 };
 
+/**
+ * KeyManager stores index keys in an order-preserving binary form, so that comparing two keys is a memcmp of their
+ * bytes and needs no deserialization. Each column of the key schema is written as:
+ *
+ *   null marker (1 byte, 0 for null, 1 otherwise, so nulls sort first), then unless null
+ *   int:   big-endian with the sign bit flipped
+ *   float: big-endian IEEE bits, all bits flipped if negative, else the sign bit flipped
+ *   char:  the characters padded with zero bytes to the length of the column, then the length (2 bytes, big-endian)
+ *
+ * A null column is followed by zero bytes of the same size, and the rest of the key buffer is zeroed too.
+ */
 class KeyManager {
  public: /**/
   [[nodiscard]] inline GenericKey *InitKey() const {
@@ -18,42 +32,76 @@ class KeyManager {
   }
 
   inline void SerializeFromKey(GenericKey *key_buf, const Row &key, Schema *schema) const {
-    // initialize to 0
-    [[maybe_unused]] uint32_t size = key.GetSerializedSize(schema);
     ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
-    ASSERT(size <= (uint32_t)key_size_, "Index key size exceed max key size.");
+    ASSERT(GetEncodedSize(schema) <= (uint32_t)key_size_, "Index key size exceed max key size.");
     memset(key_buf->data, 0, key_size_);
-    key.SerializeTo(key_buf->data, schema);
+    auto *buf = reinterpret_cast<unsigned char *>(key_buf->data);
+    for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+      const Column *column = schema->GetColumn(i);
+      const Field *field = key.GetField(i);
+      uint32_t size = GetEncodedSize(column);
+      if (!field->IsNull()) {
+        EncodeField(buf, *field, column);
+      }
+      buf += size;
+    }
   }
 
   inline void DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const {
-    [[maybe_unused]] uint32_t ofs = key.DeserializeFrom(const_cast<char *>(key_buf->data), schema);
-    ASSERT(ofs <= (uint32_t)key_size_, "Index key size exceed max key size.");
+    key.destroy();
+    const auto *buf = reinterpret_cast<const unsigned char *>(key_buf->data);
+    for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+      const Column *column = schema->GetColumn(i);
+      if (buf[0] == 0) {
+        key.AppendField(Field(column->GetType()));
+      } else if (column->GetType() == TypeId::kTypeInt) {
+        key.AppendField(Field(TypeId::kTypeInt, static_cast<int32_t>(ReadBigEndian32(buf + 1) ^ SIGN_BIT)));
+      } else if (column->GetType() == TypeId::kTypeFloat) {
+        uint32_t bits = ReadBigEndian32(buf + 1);
+        bits = (bits & SIGN_BIT) ? bits ^ SIGN_BIT : ~bits;
+        float value;
+        memcpy(&value, &bits, sizeof(float));
+        key.AppendField(Field(TypeId::kTypeFloat, value));
+      } else {
+        uint32_t len = (buf[1 + column->GetLength()] << 8) | buf[2 + column->GetLength()];
+        key.AppendField(Field(TypeId::kTypeChar, reinterpret_cast<char *>(const_cast<unsigned char *>(buf + 1)), len,
+                              false));
+      }
+      buf += GetEncodedSize(column);
+    }
   }
 
   // compare
   [[nodiscard]] inline int CompareKeys(const GenericKey *lhs, const GenericKey *rhs) const {
-    //    ASSERT(malloc_usable_size((void *)&lhs) == malloc_usable_size((void *)&rhs), "key size not match.");
-    uint32_t column_count = key_schema_->GetColumnCount();
-    Row lhs_key(INVALID_ROWID);
-    Row rhs_key(INVALID_ROWID);
-    DeserializeToKey(lhs, lhs_key, key_schema_);
-    DeserializeToKey(rhs, rhs_key, key_schema_);
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Field *lhs_value = lhs_key.GetField(i);
-      Field *rhs_value = rhs_key.GetField(i);
-
-      if (lhs_value->CompareLessThan(*rhs_value) == CmpBool::kTrue) {
-        return -1;
-      }
+    return memcmp(lhs->data, rhs->data, key_size_);
+  }
 
-      if (lhs_value->CompareGreaterThan(*rhs_value) == CmpBool::kTrue) {
-        return 1;
+  /**
+   * Binary search among the keys in [begin, end) of a page, the first key at keys and each next one stride bytes later.
+   * @return index of the first key not less than key, or greater than key if upper, end if there is none
+   */
+  inline int SearchKeys(const char *keys, int stride, int begin, int end, const GenericKey *key, bool upper) const {
+    while (begin < end) {
+      int mid = begin + (end - begin) / 2;
+      int cmp = CompareKeys(reinterpret_cast<const GenericKey *>(keys + mid * stride), key);
+      if (cmp < 0 || (upper && cmp == 0)) {
+        begin = mid + 1;
+      } else {
+        end = mid;
       }
     }
-    // equals
-    return 0;
+    return begin;
+  }
+
+  /**
+   * @return bytes a key of key_schema takes in its binary form
+   */
+  static uint32_t GetEncodedSize(const Schema *key_schema) {
+    uint32_t size = 0;
+    for (auto column : key_schema->GetColumns()) {
+      size += GetEncodedSize(column);
+    }
+    return size;
   }
 
   inline int GetKeySize() const { return key_size_; }
@@ -66,9 +114,104 @@ class KeyManager {
   // constructor
   KeyManager(Schema *key_schema, size_t key_size) : key_size_(key_size), key_schema_(key_schema) {}
 
+ protected:
+  static inline uint32_t ReadBigEndian32(const unsigned char *buf) {
+    return (static_cast<uint32_t>(buf[0]) << 24) | (static_cast<uint32_t>(buf[1]) << 16) |
+           (static_cast<uint32_t>(buf[2]) << 8) | buf[3];
+  }
+
  private:
+  static constexpr uint32_t SIGN_BIT = 0x80000000u;
+
+  static uint32_t GetEncodedSize(const Column *column) {
+    if (column->GetType() == TypeId::kTypeChar) {
+      return 1 + column->GetLength() + sizeof(uint16_t);
+    }
+    return 1 + sizeof(uint32_t);
+  }
+
+  static void EncodeField(unsigned char *buf, const Field &field, const Column *column) {
+    buf[0] = 1;
+    switch (column->GetType()) {
+      case TypeId::kTypeInt: {
+        WriteBigEndian32(buf + 1, static_cast<uint32_t>(field.value_.integer_) ^ SIGN_BIT);
+        break;
+      }
+      case TypeId::kTypeFloat: {
+        float value = field.value_.float_ == 0.0f ? 0.0f : field.value_.float_;  // -0 and 0 are equal keys
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(float));
+        WriteBigEndian32(buf + 1, (bits & SIGN_BIT) ? ~bits : bits ^ SIGN_BIT);
+        break;
+      }
+      default: {
+        uint32_t len = field.GetLength();
+        ASSERT(len <= column->GetLength() && len <= UINT16_MAX, "Index key exceeds the length of its column.");
+        memcpy(buf + 1, field.GetData(), len);
+        // 补零后再写长度，前缀相同时短的字符串排在前面，和 CompareStrings 的顺序一致
+        buf[1 + column->GetLength()] = static_cast<unsigned char>(len >> 8);
+        buf[2 + column->GetLength()] = static_cast<unsigned char>(len);
+        break;
+      }
+    }
+  }
+
+  static inline void WriteBigEndian32(unsigned char *buf, uint32_t value) {
+    buf[0] = static_cast<unsigned char>(value >> 24);
+    buf[1] = static_cast<unsigned char>(value >> 16);
+    buf[2] = static_cast<unsigned char>(value >> 8);
+    buf[3] = static_cast<unsigned char>(value);
+  }
+
   int key_size_;
   Schema *key_schema_;
 };
 
+/**
+ * KeyManager of a key schema with a single int or float column. Such a key fits into its first 8 bytes (the rest of
+ * the key buffer is zero), so two keys compare as two integers instead of with memcmp. The B+ tree and its pages are
+ * templates over the key manager, so that this comparison is inlined into their binary searches, see FixedKeyBPlusTree.
+ */
+class FixedKeyManager : public KeyManager {
+ public:
+  FixedKeyManager(Schema *key_schema, size_t key_size) : KeyManager(key_schema, key_size) {
+    ASSERT(IsFixedWidth(key_schema), "Key schema is not a single fixed width column.");
+    ASSERT(key_size >= sizeof(uint64_t), "Key size too small for fixed width keys.");
+  }
+
+  [[nodiscard]] inline int CompareKeys(const GenericKey *lhs, const GenericKey *rhs) const {
+    uint64_t lhs_word = ReadKeyWord(lhs);
+    uint64_t rhs_word = ReadKeyWord(rhs);
+    return (lhs_word > rhs_word) - (lhs_word < rhs_word);
+  }
+
+  /**
+   * Same as KeyManager::SearchKeys. Bisects until few keys are left, then counts the keys before the position with
+   * KeySearch, which compares several keys at once.
+   */
+  inline int SearchKeys(const char *keys, int stride, int begin, int end, const GenericKey *key, bool upper) const {
+    uint64_t word = ReadKeyWord(key);
+    while (end - begin > KEY_SEARCH_SCAN_KEYS) {
+      int mid = begin + (end - begin) / 2;
+      uint64_t mid_word = ReadKeyWord(reinterpret_cast<const GenericKey *>(keys + mid * stride));
+      if (mid_word < word || (upper && mid_word == word)) {
+        begin = mid + 1;
+      } else {
+        end = mid;
+      }
+    }
+    return begin + KeySearch::CountLess(keys + begin * stride, stride, end - begin, word, upper);
+  }
+
+  /**
+   * @return whether keys of key_schema can be managed by a FixedKeyManager
+   */
+  static bool IsFixedWidth(const Schema *key_schema) {
+    return key_schema->GetColumnCount() == 1 && key_schema->GetColumn(0)->GetType() != TypeId::kTypeChar;
+  }
+
+ private:
+  static inline uint64_t ReadKeyWord(const GenericKey *key) { return KeySearch::ReadWord(key->data); }
+};
+
 #endif  // MINISQL_GENERIC_KEY_H
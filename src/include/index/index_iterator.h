@@ -1,18 +1,34 @@
 #ifndef MINISQL_INDEX_ITERATOR_H
 #define MINISQL_INDEX_ITERATOR_H
 
+#include <functional>
+#include <vector>
+
+#include "buffer/read_ahead.h"
 #include "page/b_plus_tree_leaf_page.h"
 
+/**
+ * IndexIterator walks the leaves of a B+ tree in key order. The entries of the current leaf are copied out under its
+ * read latch, so the iterator neither reads a page another session is changing nor keeps a leaf pinned, which a merge
+ * could not delete then. It moves to the next leaf by looking up the high key of the current one in the tree, which
+ * finds the right leaf even after merges moved keys to the left or freed the leaf it came from.
+ */
 class IndexIterator {
   using LeafPage = BPlusTreeLeafPage;
 
  public:
+  /** Look up key in the tree: return the leaf holding it pinned and read latched, and the position of key in it. */
+  using FindLeafFn = std::function<Page *(const GenericKey *key, int *index)>;
+
   // you may define your own constructor based on your member variables
   explicit IndexIterator();
 
-  explicit IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int index = 0);
+  /**
+   * Start at position index of leaf, which is pinned and read latched and which the iterator releases.
+   */
+  explicit IndexIterator(BufferPoolManager *bpm, FindLeafFn find_leaf, Page *leaf, int index = 0);
 
-  ~IndexIterator();
+  ~IndexIterator() = default;
 
   /** Return the key/value pair this iterator is currently pointing at. */
   std::pair<GenericKey *, RowId> operator*();
@@ -20,18 +36,33 @@ class IndexIterator {
   /** Move to the next key/value pair.*/
   IndexIterator &operator++();
 
-  /** Return whether two iterators are equal */
+  /** Return whether two iterators are equal, every iterator past the last key is equal to End() */
   bool operator==(const IndexIterator &itr) const;
 
   /** Return whether two iterators are not equal. */
   bool operator!=(const IndexIterator &itr) const;
 
  private:
+  /** Copy the entries of leaf from index on and release it. */
+  void Load(Page *leaf, int index);
+
+  /** Once past the copied entries, load the leaf after the high key, until there is an entry or no leaf is left. */
+  void MoveRight();
+
+  /** @return whether the iterator is past the last key of the tree */
+  bool IsEnd() const { return item_index >= first_index_ + static_cast<int>(values_.size()) && high_key_.empty(); }
+
   page_id_t current_page_id{INVALID_PAGE_ID};
-  LeafPage *page{nullptr};
   int item_index{0};
   BufferPoolManager *buffer_pool_manager{nullptr};
   // add your own private member variables here
+  FindLeafFn find_leaf_;
+  int key_size_{0};
+  int first_index_{0};          // position of the first copied entry in the leaf
+  std::vector<char> keys_;      // copied keys, key_size_ bytes each
+  std::vector<RowId> values_;   // copied values
+  std::vector<char> high_key_;  // high key of the leaf, empty for the last leaf
+  ReadAhead read_ahead_;  // prefetches the leaves following the current one
 };
 
 #endif  // MINISQL_INDEX_ITERATOR_H
@@ -0,0 +1,33 @@
+#ifndef MINISQL_KEY_SEARCH_H
+#define MINISQL_KEY_SEARCH_H
+
+#include <cstdint>
+
+/**
+ * Search kernels for fixed width index keys (see FixedKeyManager), which compare as the big-endian 64-bit word at the
+ * start of each key. The keys of a B+ tree page are interleaved with their values, so the kernels take the distance
+ * between two keys.
+ *
+ * The AVX2 kernel loads four keys at once and compares them with the searched word in one instruction. It is chosen at
+ * run time when the CPU supports it, else a branch-free scalar loop is used.
+ */
+class KeySearch {
+ public:
+  /**
+   * @return number of the count keys starting at keys, stride bytes apart, whose word is less than word, or less than
+   * or equal to it if or_equal
+   */
+  static int CountLess(const char *keys, int stride, int count, uint64_t word, bool or_equal);
+
+  /** Same as CountLess, but never uses SIMD instructions. */
+  static int CountLessScalar(const char *keys, int stride, int count, uint64_t word, bool or_equal);
+
+  /** @return the big-endian word at the start of key */
+  static inline uint64_t ReadWord(const char *key) {
+    uint64_t word;
+    __builtin_memcpy(&word, key, sizeof(word));
+    return __builtin_bswap64(word);
+  }
+};
+
+#endif  // MINISQL_KEY_SEARCH_H
@@ -8,7 +8,7 @@
 #include "index/generic_key.h"
 #include "page/b_plus_tree_page.h"
 
-#define INTERNAL_PAGE_HEADER_SIZE 28
+#define INTERNAL_PAGE_HEADER_SIZE 32
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -18,9 +18,10 @@
  * should ignore the first key.
  *
  * Internal page format (keys are stored in increasing order):
- *  --------------------------------------------------------------------------
- * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
- *  --------------------------------------------------------------------------
+ *  --------------------------------------------------------------------------------------
+ * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) | ... | HIGH KEY |
+ *  --------------------------------------------------------------------------------------
+ * The header ends with NextPageId (4), the right sibling on the same level.
  */
 class BPlusTreeInternalPage : public BPlusTreePage {
  public:
@@ -28,6 +29,10 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int key_size = UNDEFINED_SIZE,
             int max_size = UNDEFINED_SIZE);
 
+  page_id_t GetNextPageId() const;
+
+  void SetNextPageId(page_id_t next_page_id);
+
   GenericKey *KeyAt(int index);
 
   void SetKeyAt(int index, GenericKey *key);
@@ -42,7 +47,8 @@ class BPlusTreeInternalPage : public BPlusTreePage {
 
   void PairCopy(void *dest, void *src, int pair_num = 1);
 
-  page_id_t Lookup(const GenericKey *key, const KeyManager &KP);
+  template <typename KeyManagerType>
+  page_id_t Lookup(const GenericKey *key, const KeyManagerType &KP);
 
   void PopulateNewRoot(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value);
 
@@ -70,6 +76,8 @@ class BPlusTreeInternalPage : public BPlusTreePage {
 
   void CopyFirstFrom(page_id_t value, BufferPoolManager *buffer_pool_manager);
 
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+
   char data_[PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE];
 };
 
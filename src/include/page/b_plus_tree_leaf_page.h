@@ -9,9 +9,9 @@
  * page. Only support unique key.
 
  * Leaf page format (keys are stored in order):
- *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
- *  ----------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------------
+ * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n) | ... | HIGH KEY |
+ *  ---------------------------------------------------------------------------------
  *
  *  Header format (size in byte, 24 bytes in total):
  *  ---------------------------------------------------------------------
@@ -49,7 +49,8 @@ class BPlusTreeLeafPage : public BPlusTreePage {
 
   void SetValueAt(int index, RowId value);
 
-  int KeyIndex(const GenericKey *key, const KeyManager &comparator);
+  template <typename KeyManagerType>
+  int KeyIndex(const GenericKey *key, const KeyManagerType &comparator);
 
   void *PairPtrAt(int index);
 
@@ -58,11 +59,14 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   std::pair<GenericKey *, RowId> GetItem(int index);
 
   // insert and delete methods
-  int Insert(GenericKey *key, const RowId &value, const KeyManager &comparator);
+  template <typename KeyManagerType>
+  int Insert(GenericKey *key, const RowId &value, const KeyManagerType &comparator);
 
-  bool Lookup(const GenericKey *key, RowId &value, const KeyManager &comparator);
+  template <typename KeyManagerType>
+  bool Lookup(const GenericKey *key, RowId &value, const KeyManagerType &comparator);
 
-  int RemoveAndDeleteRecord(const GenericKey *key, const KeyManager &comparator);
+  template <typename KeyManagerType>
+  int RemoveAndDeleteRecord(const GenericKey *key, const KeyManagerType &comparator);
 
   // Split and Merge utility methods
   void MoveHalfTo(BPlusTreeLeafPage *recipient);
@@ -8,6 +8,8 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+class GenericKey;
+
 // define page type enum
 enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
 
@@ -24,6 +26,9 @@ enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
  * ----------------------------------------------------------------------------
  * | ParentPageId (4) | PageId(4) |
  * ----------------------------------------------------------------------------
+ *
+ * The last KeySize bytes of the page hold the high key, an upper bound of the keys under the page. It is valid only
+ * while the page has a right sibling, and lets a lookup that reached the page before a concurrent split move right.
  */
 class BPlusTreePage {
  public:
@@ -59,6 +64,10 @@ class BPlusTreePage {
 
   void SetLSN(lsn_t lsn = INVALID_LSN);
 
+  GenericKey *GetHighKey();
+
+  void SetHighKey(const GenericKey *key);
+
  private:
   // member variable, attributes that both internal and leaf page share
   [[maybe_unused]] IndexPageType page_type_;
@@ -0,0 +1,66 @@
+#ifndef MINISQL_FREE_SPACE_MAP_PAGE_H
+#define MINISQL_FREE_SPACE_MAP_PAGE_H
+
+#include <algorithm>
+
+#include "common/config.h"
+
+/**
+ * Free space map page records roughly how much room is left in up to MAX_ENTRIES pages of a table heap. The pages of
+ * a map are chained, and entries are appended in the order the heap pages were added to the table.
+ *
+ * Format (size in byte):
+ *  ----------------------------------------------------------------------------------------------------------
+ * | NextPageId (4) | EntryCount (4) | HeapPageId_1 (4) | ... | HeapPageId_n (4) | Category_1 (1) | ... |
+ *  ----------------------------------------------------------------------------------------------------------
+ *
+ * The category of a heap page is its free space in units of CATEGORY_UNIT bytes, rounded down, so a page of category
+ * c has at least c * CATEGORY_UNIT bytes free.
+ */
+class FreeSpaceMapPage {
+ public:
+  static constexpr uint32_t MAX_ENTRIES = (PAGE_SIZE - 8) / (sizeof(page_id_t) + sizeof(uint8_t));
+  static constexpr uint32_t CATEGORY_UNIT = PAGE_SIZE / 256;
+
+  void Init() {
+    next_page_id_ = INVALID_PAGE_ID;
+    count_ = 0;
+  }
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  uint32_t GetCount() const { return count_; }
+
+  page_id_t GetHeapPageId(uint32_t index) const { return heap_page_ids_[index]; }
+
+  void SetHeapPageId(uint32_t index, page_id_t heap_page_id) { heap_page_ids_[index] = heap_page_id; }
+
+  uint8_t GetCategory(uint32_t index) const { return Categories()[index]; }
+
+  void SetCategory(uint32_t index, uint8_t category) { Categories()[index] = category; }
+
+  /**
+   * @return false if the page is full
+   */
+  bool Append(page_id_t heap_page_id, uint8_t category);
+
+  /** @return the largest category whose pages are guaranteed to have free_space bytes */
+  static uint8_t ToCategory(uint32_t free_space) { return std::min<uint32_t>(free_space / CATEGORY_UNIT, 255); }
+
+  /** @return the smallest category whose pages are guaranteed to have size bytes */
+  static uint32_t RequiredCategory(uint32_t size) { return (size + CATEGORY_UNIT - 1) / CATEGORY_UNIT; }
+
+ private:
+  uint8_t *Categories() const {
+    return reinterpret_cast<uint8_t *>(const_cast<page_id_t *>(heap_page_ids_) + MAX_ENTRIES);
+  }
+
+ private:
+  page_id_t next_page_id_;
+  uint32_t count_;
+  page_id_t heap_page_ids_[0];
+};
+
+#endif  // MINISQL_FREE_SPACE_MAP_PAGE_H
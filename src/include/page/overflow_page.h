@@ -0,0 +1,43 @@
+#ifndef MINISQL_OVERFLOW_PAGE_H
+#define MINISQL_OVERFLOW_PAGE_H
+
+#include "common/config.h"
+
+/**
+ * Overflow page holds a piece of a char field which is too large to stay in its row. The pieces of one field are
+ * chained in order, see OverflowStore.
+ *
+ * Format (size in byte):
+ *  --------------------------------------------------
+ * | NextPageId (4) | Size (4) | Data (up to CAPACITY) |
+ *  --------------------------------------------------
+ */
+class OverflowPage {
+ public:
+  static constexpr uint32_t CAPACITY = PAGE_SIZE - sizeof(page_id_t) - sizeof(uint32_t);
+
+  void Init() {
+    next_page_id_ = INVALID_PAGE_ID;
+    size_ = 0;
+  }
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  /** @return number of bytes of the field in this page */
+  uint32_t GetSize() const { return size_; }
+
+  void SetSize(uint32_t size) { size_ = size; }
+
+  char *GetData() { return data_; }
+
+  const char *GetData() const { return data_; }
+
+ private:
+  page_id_t next_page_id_;
+  uint32_t size_;
+  char data_[0];
+};
+
+#endif  // MINISQL_OVERFLOW_PAGE_H
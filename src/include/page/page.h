@@ -16,6 +16,7 @@
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManager;
+  friend class BufferPoolInstance;
 
  public:
   DISALLOW_COPY(Page)
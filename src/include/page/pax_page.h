@@ -0,0 +1,99 @@
+#ifndef MINISQL_PAX_PAGE_H
+#define MINISQL_PAX_PAGE_H
+
+#include <vector>
+
+#include "page/table_page.h"
+
+/**
+ * PAX page stores the tuples of a table heap column by column: the page is divided into one minipage per column, and
+ * the value of a column for slot i is at a fixed position in that minipage. A scan which evaluates a predicate on one
+ * column and projects another only reads those two minipages, whose values sit next to each other.
+ *
+ * Every value takes the declared width of its column: 4 bytes for int and float, 4 bytes of length followed by the
+ * declared length for char (or an overflow pointer, see OverflowStore). So a page holds a fixed number of tuples, a
+ * value is updated in place, and a char value longer than its column does not fit.
+ *
+ * Format (size in byte):
+ *  ---------------------------------------------------------------------------------------------------------
+ * | TablePage header (36) | Capacity (4) | SlotWidth (4) | SlotState_1 (1) | ... | Minipage_1 | Minipage_2 | ... |
+ *  ---------------------------------------------------------------------------------------------------------
+ *
+ * TupleCount of the header counts the slots which hold a tuple, including the ones marked deleted. The state array is
+ * padded to 4 bytes, the minipages follow in column order, each Capacity times as wide as its column.
+ */
+class PaxPage : public TablePage {
+ public:
+  /**
+   * @return number of tuples of schema a PAX page holds, 0 if not even one fits
+   */
+  static uint32_t GetCapacity(const Schema *schema);
+
+  /**
+   * @return whether every value of row fits into its column in a PAX page
+   */
+  static bool CanHold(const Row &row, const Schema *schema);
+
+  void Init(page_id_t page_id, page_id_t prev_id, const Schema *schema, LogManager *log_mgr, Txn *txn);
+
+  bool InsertTuple(Row &row, Schema *schema, Txn *txn, LockManager *lock_manager, LogManager *log_manager);
+
+  bool MarkDelete(const RowId &rid, Txn *txn, LockManager *lock_manager, LogManager *log_manager);
+
+  bool UpdateTuple(Row &new_row, Row *old_row, Schema *schema, Txn *txn, LockManager *lock_manager,
+                   LogManager *log_manager);
+
+  void ApplyDelete(const RowId &rid, Txn *txn, LogManager *log_manager);
+
+  void RollbackDelete(const RowId &rid, Txn *txn, LogManager *log_manager);
+
+  bool GetTuple(Row *row, Schema *schema, Txn *txn, LockManager *lock_manager);
+
+  bool GetTupleView(const RowId &rid, const Schema *schema, RowView *view, const OverflowStore *overflow_store,
+                    bool include_deleted);
+
+  uint32_t GetTupleViews(const Schema *schema, uint32_t begin_slot, std::vector<RowView> *views,
+                         const OverflowStore *overflow_store);
+
+  uint32_t GetDeletedTupleViews(const Schema *schema, std::vector<RowView> *views);
+
+  bool GetFirstTupleRid(RowId *first_rid);
+
+  bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
+
+  uint32_t GetDeletedTupleSpace();
+
+  uint32_t Compact();
+
+ private:
+  enum SlotState : uint8_t { kSlotEmpty = 0, kSlotLive = 1, kSlotDeleted = 2 };
+
+  /** @return bytes a value of column takes in its minipage */
+  static uint32_t GetColumnWidth(const Column *column);
+
+  /** @return offset of the first minipage */
+  static uint32_t GetMinipagesOffset(uint32_t capacity) { return OFFSET_SLOT_STATES + ((capacity + 3) & ~3U); }
+
+  /**
+   * Compute the position of every minipage and the width of its values.
+   */
+  void GetMinipages(const Schema *schema, std::vector<uint32_t> *offsets, std::vector<uint32_t> *widths);
+
+  /** Set the offset of every column of slot, given the minipages. */
+  static void GetColumnOffsets(uint32_t slot, const std::vector<uint32_t> &minipages,
+                               const std::vector<uint32_t> &widths, std::vector<uint32_t> *offsets);
+
+  SlotState GetSlotState(uint32_t slot) { return static_cast<SlotState>(GetData()[OFFSET_SLOT_STATES + slot]); }
+
+  void SetSlotState(uint32_t slot, SlotState state) { GetData()[OFFSET_SLOT_STATES + slot] = state; }
+
+  /** Deserialize the tuple in slot into row, which is cleared first. */
+  void ReadTuple(uint32_t slot, const Schema *schema, Row *row);
+
+  /** Serialize row into slot. */
+  void WriteTuple(uint32_t slot, const Schema *schema, const Row &row);
+
+  static constexpr size_t OFFSET_SLOT_STATES = OFFSET_PAX_SLOT_WIDTH + sizeof(uint32_t);
+};
+
+#endif  // MINISQL_PAX_PAGE_H
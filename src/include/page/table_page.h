@@ -12,9 +12,24 @@
  *  ----------------------------------------------------------------------------
  *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
  *  ----------------------------------------------------------------------------
- *  ----------------------------------------------------------------
- *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
- *  ----------------------------------------------------------------
+ *  ------------------------------------------------------------------------------
+ *  | TupleCount (4) | FreeSlotHint (4) | Layout (2) | Version (2) | ModCount (4) |
+ *  ------------------------------------------------------------------------------
+ *  ---------------------------------------------------
+ *  | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
+ *  ---------------------------------------------------
+ *
+ *  Every slot below FreeSlotHint holds a tuple, so an insert looks for an empty slot to reuse from there on.
+ *
+ *  Layout tells a row page, whose format is described above, from a PAX page (see PaxPage), which shares the header
+ *  up to ModCount. Every method works on both, a PAX page is handed to PaxPage.
+ *
+ *  Version is FORMAT_VERSION for pages in the format above. Pages written before it was added hold the high half of a
+ *  tuple offset, of a tuple size or of the old 4 byte Layout there, never FORMAT_VERSION, and TableHeap::Create does
+ *  not open a heap whose first page is one of them.
+ *
+ *  ModCount is bumped by every change to the tuples of the page, so a reader which let go of the latch can tell
+ *  whether the tuples it saw are still there.
  **/
 
 #include <cstring>
@@ -25,12 +40,33 @@
 #include "concurrency/txn.h"
 #include "page/page.h"
 #include "record/row.h"
+#include "record/row_view.h"
 #include "recovery/log_manager.h"
 
+/**
+ * How the tuples of a table heap are laid out in its pages.
+ */
+enum class TableLayout : uint16_t {
+  kRow = 0,  // slotted page, the columns of a tuple are stored together
+  kPax = 1,  // PAX page, the values of a column are stored together in a minipage
+};
+
+class PaxPage;
+
 class TablePage : public Page {
  public:
   void Init(page_id_t page_id, page_id_t prev_id, LogManager *log_mgr, Txn *txn);
 
+  TableLayout GetLayout() { return *reinterpret_cast<TableLayout *>(GetData() + OFFSET_LAYOUT); }
+
+  bool IsPax() { return GetLayout() == TableLayout::kPax; }
+
+  /** @return version of the format the page was written in, FORMAT_VERSION unless it is from an older build */
+  uint16_t GetFormatVersion() { return *reinterpret_cast<uint16_t *>(GetData() + OFFSET_FORMAT_VERSION); }
+
+  /** @return number of changes made to the tuples of the page, wraps around */
+  uint32_t GetModCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_MOD_COUNT); }
+
   page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
 
   page_id_t GetPrevPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_PREV_PAGE_ID); }
@@ -58,11 +94,75 @@ class TablePage : public Page {
 
   bool GetTuple(Row *row, Schema *schema, Txn *txn, LockManager *lock_manager);
 
+  /**
+   * Point view at the bytes of a tuple in this page instead of copying them.
+   * @param overflow_store where the view reads the fields stored out of line from
+   * @param include_deleted whether a tuple which is marked deleted may be viewed as well
+   * @return false if the tuple does not exist or is deleted
+   */
+  bool GetTupleView(const RowId &rid, const Schema *schema, RowView *view,
+                    const OverflowStore *overflow_store = nullptr, bool include_deleted = false);
+
+  /**
+   * Point views at all live tuples from begin_slot on, in slot order. views only grows, elements after the returned
+   * count keep their buffers for the next call.
+   * @param overflow_store where the views read the fields stored out of line from
+   * @return number of views set
+   */
+  uint32_t GetTupleViews(const Schema *schema, uint32_t begin_slot, std::vector<RowView> *views,
+                         const OverflowStore *overflow_store = nullptr);
+
+  /**
+   * Point views at the tuples marked deleted, e.g. to free their overflow pages before Compact removes them.
+   * @return number of views set
+   */
+  uint32_t GetDeletedTupleViews(const Schema *schema, std::vector<RowView> *views);
+
   bool GetFirstTupleRid(RowId *first_rid);
 
   bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
 
- private:
+  /** @return bytes left for new tuples and their slots */
+  uint32_t GetFreeSpaceRemaining() {
+    if (IsPax()) {
+      // a free slot of a PAX page takes any row the page can hold at all, however long
+      return (GetPaxCapacity() - GetTupleCount()) * (GetPaxSlotWidth() + SIZE_TUPLE);
+    }
+    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
+  }
+
+  /** @return bytes taken by tuples, including the ones marked deleted */
+  uint32_t GetTupleSpace() {
+    return IsPax() ? GetTupleCount() * GetPaxSlotWidth() : PAGE_SIZE - GetFreeSpacePointer();
+  }
+
+  /** @return bytes taken by tuples which are marked deleted */
+  uint32_t GetDeletedTupleSpace();
+
+  /** @return whether the page holds no tuple at all, not even one marked deleted */
+  bool IsEmpty() { return GetTupleCount() == 0; }
+
+  /**
+   * Remove the tuples marked deleted, as ApplyDelete would, and pack the remaining ones at the end of the page in a
+   * single pass. Live tuples keep their slots, empty slots at the end of the slot array are given back.
+   * Must only be called once the transactions which deleted the tuples can no longer roll back.
+   * @return number of tuples removed
+   */
+  uint32_t Compact();
+
+ protected:
+  PaxPage *AsPax() { return reinterpret_cast<PaxPage *>(this); }
+
+  void SetLayout(TableLayout layout) { memcpy(GetData() + OFFSET_LAYOUT, &layout, sizeof(TableLayout)); }
+
+  void SetFormatVersion(uint16_t version) {
+    memcpy(GetData() + OFFSET_FORMAT_VERSION, &version, sizeof(uint16_t));
+  }
+
+  void SetModCount(uint32_t mod_count) { memcpy(GetData() + OFFSET_MOD_COUNT, &mod_count, sizeof(uint32_t)); }
+
+  void BumpModCount() { SetModCount(GetModCount() + 1); }
+
   uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
 
   void SetFreeSpacePointer(uint32_t free_space_pointer) {
@@ -73,9 +173,15 @@ class TablePage : public Page {
 
   void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
 
-  uint32_t GetFreeSpaceRemaining() {
-    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
-  }
+  uint32_t GetFreeSlotHint() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SLOT_HINT); }
+
+  void SetFreeSlotHint(uint32_t slot_num) { memcpy(GetData() + OFFSET_FREE_SLOT_HINT, &slot_num, sizeof(uint32_t)); }
+
+  /** @return number of tuples a PAX page has room for */
+  uint32_t GetPaxCapacity() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_PAX_CAPACITY); }
+
+  /** @return bytes a tuple takes in a PAX page */
+  uint32_t GetPaxSlotWidth() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_PAX_SLOT_WIDTH); }
 
   uint32_t GetTupleOffsetAtSlot(uint32_t slot_num) {
     return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_OFFSET + SIZE_TUPLE * slot_num);
@@ -99,19 +205,26 @@ class TablePage : public Page {
 
   static uint32_t UnsetDeletedFlag(uint32_t tuple_size) { return static_cast<uint32_t>(tuple_size & (~DELETE_MASK)); }
 
- private:
+ protected:
   static_assert(sizeof(page_id_t) == 4);
   static constexpr uint64_t DELETE_MASK = (1U << (8 * sizeof(uint32_t) - 1));
-  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
-  static constexpr size_t SIZE_TUPLE = 8;
+  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 36;
   static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
   static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
   static constexpr size_t OFFSET_FREE_SPACE = 16;
   static constexpr size_t OFFSET_TUPLE_COUNT = 20;
-  static constexpr size_t OFFSET_TUPLE_OFFSET = 24;
-  static constexpr size_t OFFSET_TUPLE_SIZE = 28;
+  static constexpr size_t OFFSET_FREE_SLOT_HINT = 24;
+  static constexpr size_t OFFSET_LAYOUT = 28;
+  static constexpr size_t OFFSET_FORMAT_VERSION = 30;
+  static constexpr size_t OFFSET_MOD_COUNT = 32;
+  static constexpr size_t OFFSET_TUPLE_OFFSET = 36;
+  static constexpr size_t OFFSET_TUPLE_SIZE = 40;
+  static constexpr size_t OFFSET_PAX_CAPACITY = 36;
+  static constexpr size_t OFFSET_PAX_SLOT_WIDTH = 40;
 
  public:
+  static constexpr uint16_t FORMAT_VERSION = 1;
+  static constexpr size_t SIZE_TUPLE = 8;
   static constexpr size_t SIZE_MAX_ROW = PAGE_SIZE - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE;
 };
 
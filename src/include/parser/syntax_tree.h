@@ -41,6 +41,7 @@ typedef enum {
   kNodeCreateIndex,          /** create index command */
   kNodeDropIndex,            /** drop index command */
   kNodeIndexType,            /** type of index */
+  kNodeTableLayout,          /** storage layout of a table: row or column */
   kNodeTrxBegin,             /** begin recovery command */
   kNodeTrxCommit,            /** commit recovery command */
   kNodeTrxRollback           /** rollback recovery command */
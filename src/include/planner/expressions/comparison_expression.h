@@ -15,10 +15,26 @@
  */
 class ComparisonExpression : public AbstractExpression {
  public:
-  /** Creates a new comparison expression representing (left comp_type right). */
+  /**
+   * Creates a new comparison expression representing (left comp_type right). The operator is resolved here, and if
+   * the type of left is known, to the compare kernel of that type, so evaluating a row neither looks at comp_type
+   * nor dispatches on the type of the fields.
+   */
   ComparisonExpression(AbstractExpressionRef left, AbstractExpressionRef right, string comp_type)
       : AbstractExpression({std::move(left), std::move(right)}, TypeId::kTypeInt, ExpressionType::ComparisonExpression),
-        comp_type_{std::move(comp_type)} {}
+        comp_type_{std::move(comp_type)} {
+    if (comp_type_ == "is") {
+      null_test_ = NullTest::kIsNull;
+    } else if (comp_type_ == "not") {
+      null_test_ = NullTest::kIsNotNull;
+    } else {
+      op_ = ParseCompareOp(comp_type_);
+      compare_type_ = GetChildAt(0)->GetReturnType();
+      if (compare_type_ != TypeId::kTypeInvalid) {
+        compare_func_ = Field::GetCompareFunc(compare_type_, op_);
+      }
+    }
+  }
 
   /** e.g. evaluate the result of id = 1 */
   Field Evaluate(const Row *row) const override {
@@ -27,6 +43,12 @@ class ComparisonExpression : public AbstractExpression {
     return Field(kTypeInt, PerformComparison(lhs, rhs));
   }
 
+  Field Evaluate(const RowView &row) const override {
+    Field lhs = GetChildAt(0)->Evaluate(row);
+    Field rhs = GetChildAt(1)->Evaluate(row);
+    return Field(kTypeInt, PerformComparison(lhs, rhs));
+  }
+
   Field EvaluateJoin(const Row *left_row, const Row *right_row) const override {
     Field lhs = GetChildAt(0)->EvaluateJoin(left_row, right_row);
     Field rhs = GetChildAt(1)->EvaluateJoin(left_row, right_row);
@@ -36,28 +58,41 @@ class ComparisonExpression : public AbstractExpression {
   std::string GetComparisonType() { return comp_type_; }
 
  private:
-  CmpBool PerformComparison(const Field &lhs, const Field &rhs) const {
-    if (comp_type_ == "=")
-      return lhs.CompareEquals(rhs);
-    else if (comp_type_ == "<>")
-      return lhs.CompareNotEquals(rhs);
-    else if (comp_type_ == "<")
-      return lhs.CompareLessThan(rhs);
-    else if (comp_type_ == "<=")
-      return lhs.CompareLessThanEquals(rhs);
-    else if (comp_type_ == ">")
-      return lhs.CompareGreaterThan(rhs);
-    else if (comp_type_ == ">=")
-      return lhs.CompareGreaterThanEquals(rhs);
-    else if (comp_type_ == "is")
-      return GetCmpBool(lhs.IsNull());
-    else if (comp_type_ == "not")
-      return GetCmpBool(!lhs.IsNull());
+  enum class NullTest { kNone, kIsNull, kIsNotNull };
+
+  static CompareOp ParseCompareOp(const std::string &comp_type) {
+    if (comp_type == "=")
+      return CompareOp::kEquals;
+    else if (comp_type == "<>")
+      return CompareOp::kNotEquals;
+    else if (comp_type == "<")
+      return CompareOp::kLessThan;
+    else if (comp_type == "<=")
+      return CompareOp::kLessThanEquals;
+    else if (comp_type == ">")
+      return CompareOp::kGreaterThan;
+    else if (comp_type == ">=")
+      return CompareOp::kGreaterThanEquals;
     else
       throw std::logic_error("Unsupported comparison type");
   }
 
+  CmpBool PerformComparison(const Field &lhs, const Field &rhs) const {
+    if (null_test_ != NullTest::kNone) {
+      return GetCmpBool(lhs.IsNull() == (null_test_ == NullTest::kIsNull));
+    }
+    if (lhs.GetTypeId() == compare_type_) {
+      return compare_func_(lhs, rhs);
+    }
+    // 左侧的类型在构造时未知，按字段的类型找比较函数
+    return Field::GetCompareFunc(lhs.GetTypeId(), op_)(lhs, rhs);
+  }
+
   std::string comp_type_;
+  NullTest null_test_{NullTest::kNone};
+  CompareOp op_{CompareOp::kEquals};
+  TypeId compare_type_{TypeId::kTypeInvalid};  // type of the left operand, which compare_func_ was resolved for
+  Field::CompareFunc compare_func_{nullptr};
 };
 
 #endif  // MINISQL_COMPARISON_EXPRESSION_H
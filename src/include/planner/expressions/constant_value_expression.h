@@ -16,11 +16,22 @@ class ConstantValueExpression : public AbstractExpression {
   explicit ConstantValueExpression(const Field &val)
       : AbstractExpression({}, val.GetTypeId(), ExpressionType::ConstantExpression), val_(val) {}
 
-  Field Evaluate(const Row *row) const override { return Field(val_); }
+  /** A char constant is returned without copying its characters, so evaluating a constant never allocates. */
+  Field Evaluate(const Row *row) const override { return GetValue(); }
 
-  Field EvaluateJoin(const Row *left_row, const Row *right_row) const override { return Field(val_); }
+  Field Evaluate(const RowView &) const override { return GetValue(); }
+
+  Field EvaluateJoin(const Row *left_row, const Row *right_row) const override { return GetValue(); }
 
   const Field val_;
+
+ private:
+  Field GetValue() const {
+    if (val_.GetTypeId() == TypeId::kTypeChar && !val_.IsNull()) {
+      return Field(TypeId::kTypeChar, const_cast<char *>(val_.GetData()), val_.GetLength(), false);
+    }
+    return Field(val_);
+  }
 };
 
 #endif  // MINISQL_CONSTANT_VALUE_EXPRESSION_H
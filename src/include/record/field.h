@@ -18,6 +18,10 @@ class Field {
 
   friend class TypeFloat;
 
+  friend class Row;
+
+  friend class KeyManager;
+
  public:
   explicit Field(const TypeId type) : type_id_(type), len_(FIELD_NULL_LEN), is_null_(true) {}
 
@@ -61,12 +65,20 @@ class Field {
     }
   }
 
+  // char stored out of line in a chain of overflow pages, see OverflowStore
+  explicit Field(TypeId type, page_id_t overflow_page_id, uint32_t len)
+      : type_id_(type), len_(len), is_external_(true) {
+    ASSERT(type == TypeId::kTypeChar, "Invalid type.");
+    value_.integer_ = overflow_page_id;
+  }
+
   // copy constructor
   explicit Field(const Field &other) {
     type_id_ = other.type_id_;
     len_ = other.len_;
     is_null_ = other.is_null_;
     manage_data_ = other.manage_data_;
+    is_external_ = other.is_external_;
     if (type_id_ == TypeId::kTypeChar && !is_null_ && manage_data_) {
       value_.chars_ = new char[len_];
       memcpy(value_.chars_, other.value_.chars_, len_);
@@ -75,6 +87,23 @@ class Field {
     }
   }
 
+  // move constructor, takes over the characters of other
+  Field(Field &&other) noexcept
+      : value_(other.value_),
+        type_id_(other.type_id_),
+        len_(other.len_),
+        is_null_(other.is_null_),
+        manage_data_(other.manage_data_),
+        is_external_(other.is_external_) {
+    other.manage_data_ = false;
+  }
+
+  // move
+  Field &operator=(Field &&other) noexcept {
+    Swap(*this, other);
+    return *this;
+  }
+
   // copy
   Field &operator=(Field &other) {
     Swap(*this, other);
@@ -83,42 +112,158 @@ class Field {
 
   inline bool IsNull() const { return is_null_; }
 
-  inline uint32_t GetLength() const { return Type::GetInstance(type_id_)->GetLength(*this); }
+  /** @return whether the characters are not in the field but in overflow pages, GetData must not be used then */
+  inline bool IsExternal() const { return is_external_; }
+
+  inline page_id_t GetOverflowPageId() const { return value_.integer_; }
+
+  inline uint32_t GetLength() const {
+    ASSERT(type_id_ == TypeId::kTypeChar, "GetLength not implemented.");
+    return len_;
+  }
 
   inline TypeId GetTypeId() const { return type_id_; }
 
-  inline const char *GetData() const { return Type::GetInstance(type_id_)->GetData(*this); }
+  inline const char *GetData() const {
+    ASSERT(type_id_ == TypeId::kTypeChar, "GetData not implemented.");
+    ASSERT(!is_external_, "Field is stored in overflow pages.");
+    return value_.chars_;
+  }
 
-  inline uint32_t SerializeTo(char *buf) const { return Type::GetInstance(type_id_)->SerializeTo(*this, buf); }
+  inline uint32_t SerializeTo(char *buf) const {
+    switch (type_id_) {
+      case TypeId::kTypeInt:
+        return SerializeKernel<TypeId::kTypeInt>(*this, buf);
+      case TypeId::kTypeFloat:
+        return SerializeKernel<TypeId::kTypeFloat>(*this, buf);
+      case TypeId::kTypeChar:
+        return SerializeKernel<TypeId::kTypeChar>(*this, buf);
+      default:
+        ASSERT(false, "SerializeTo not implemented.");
+        return 0;
+    }
+  }
 
   inline static uint32_t DeserializeFrom(char *buf, const TypeId type_id, Field **field, bool is_null) {
     return Type::GetInstance(type_id)->DeserializeFrom(buf, field, is_null);
   }
 
-  inline uint32_t GetSerializedSize() const { return Type::GetInstance(type_id_)->GetSerializedSize(*this, is_null_); }
+  inline uint32_t GetSerializedSize() const {
+    switch (type_id_) {
+      case TypeId::kTypeInt:
+        return SerializedSizeKernel<TypeId::kTypeInt>(*this);
+      case TypeId::kTypeFloat:
+        return SerializedSizeKernel<TypeId::kTypeFloat>(*this);
+      case TypeId::kTypeChar:
+        return SerializedSizeKernel<TypeId::kTypeChar>(*this);
+      default:
+        ASSERT(false, "GetSerializedSize not implemented.");
+        return 0;
+    }
+  }
 
   inline bool CheckComparable(const Field &o) const { return type_id_ == o.type_id_; }
 
-  inline CmpBool CompareEquals(const Field &o) const { return Type::GetInstance(type_id_)->CompareEquals(*this, o); }
+  inline CmpBool CompareEquals(const Field &o) const { return Compare<CompareOp::kEquals>(o); }
 
-  inline CmpBool CompareNotEquals(const Field &o) const {
-    return Type::GetInstance(type_id_)->CompareNotEquals(*this, o);
-  }
+  inline CmpBool CompareNotEquals(const Field &o) const { return Compare<CompareOp::kNotEquals>(o); }
 
-  inline CmpBool CompareLessThan(const Field &o) const {
-    return Type::GetInstance(type_id_)->CompareLessThan(*this, o);
+  inline CmpBool CompareLessThan(const Field &o) const { return Compare<CompareOp::kLessThan>(o); }
+
+  inline CmpBool CompareLessThanEquals(const Field &o) const { return Compare<CompareOp::kLessThanEquals>(o); }
+
+  inline CmpBool CompareGreaterThan(const Field &o) const { return Compare<CompareOp::kGreaterThan>(o); }
+
+  inline CmpBool CompareGreaterThanEquals(const Field &o) const { return Compare<CompareOp::kGreaterThanEquals>(o); }
+
+  /** A compare kernel, compares two fields of the type it was chosen for. */
+  using CompareFunc = CmpBool (*)(const Field &left, const Field &right);
+
+  /**
+   * Resolve op on fields of type type_id to its kernel, so that an expression which compares the same column again
+   * and again looks up neither the type nor the operator per row.
+   */
+  static CompareFunc GetCompareFunc(TypeId type_id, CompareOp op) {
+    switch (type_id) {
+      case TypeId::kTypeInt:
+        return GetCompareFunc<TypeId::kTypeInt>(op);
+      case TypeId::kTypeFloat:
+        return GetCompareFunc<TypeId::kTypeFloat>(op);
+      case TypeId::kTypeChar:
+        return GetCompareFunc<TypeId::kTypeChar>(op);
+      default:
+        ASSERT(false, "Unsupported field type.");
+        return nullptr;
+    }
   }
 
-  inline CmpBool CompareLessThanEquals(const Field &o) const {
-    return Type::GetInstance(type_id_)->CompareLessThanEquals(*this, o);
+  /**
+   * Compare kernel of op for fields of type, kNull if one of the fields is null.
+   */
+  template <TypeId type, CompareOp op>
+  static CmpBool CompareKernel(const Field &left, const Field &right) {
+    ASSERT(left.type_id_ == type && right.type_id_ == type, "Not comparable.");
+    if (left.is_null_ || right.is_null_) {
+      return CmpBool::kNull;
+    }
+    switch (type) {
+      case TypeId::kTypeInt:
+        return GetCmpBool(ApplyCompareOp<op>(left.value_.integer_, right.value_.integer_));
+      case TypeId::kTypeFloat:
+        return GetCmpBool(ApplyCompareOp<op>(left.value_.float_, right.value_.float_));
+      default:
+        return GetCmpBool(ApplyCompareOp<op>(
+            CompareStrings(left.GetData(), left.len_, right.GetData(), right.len_), 0));
+    }
   }
 
-  inline CmpBool CompareGreaterThan(const Field &o) const {
-    return Type::GetInstance(type_id_)->CompareGreaterThan(*this, o);
+  /**
+   * Serialize kernel for fields of type. @return bytes written
+   */
+  template <TypeId type>
+  static uint32_t SerializeKernel(const Field &field, char *buf) {
+    switch (type) {
+      case TypeId::kTypeInt:
+        if (field.is_null_) {
+          return 0;
+        }
+        MACH_WRITE_TO(int32_t, buf, field.value_.integer_);
+        return sizeof(int32_t);
+      case TypeId::kTypeFloat:
+        if (field.is_null_) {
+          return 0;
+        }
+        MACH_WRITE_TO(float_t, buf, field.value_.float_);
+        return sizeof(float_t);
+      default:
+        if (field.is_external_) {
+          // 数据在溢出页中，只写长度（带标记）和第一页的页号
+          MACH_WRITE_UINT32(buf, field.len_ | FIELD_OVERFLOW_FLAG);
+          MACH_WRITE_TO(page_id_t, buf + sizeof(uint32_t), field.GetOverflowPageId());
+          return sizeof(uint32_t) + sizeof(page_id_t);
+        }
+        if (field.is_null_) {
+          return 0;
+        }
+        MACH_WRITE_UINT32(buf, field.len_);
+        memcpy(buf + sizeof(uint32_t), field.value_.chars_, field.len_);
+        return sizeof(uint32_t) + field.len_;
+    }
   }
 
-  inline CmpBool CompareGreaterThanEquals(const Field &o) const {
-    return Type::GetInstance(type_id_)->CompareGreaterThanEquals(*this, o);
+  template <TypeId type>
+  static uint32_t SerializedSizeKernel(const Field &field) {
+    if (field.is_null_) {
+      return 0;
+    }
+    switch (type) {
+      case TypeId::kTypeInt:
+        return sizeof(int32_t);
+      case TypeId::kTypeFloat:
+        return sizeof(float_t);
+      default:
+        return field.is_external_ ? sizeof(uint32_t) + sizeof(page_id_t) : sizeof(uint32_t) + field.len_;
+    }
   }
 
   friend void Swap(Field &first, Field &second) {
@@ -127,6 +272,7 @@ class Field {
     std::swap(first.len_, second.len_);
     std::swap(first.is_null_, second.is_null_);
     std::swap(first.manage_data_, second.manage_data_);
+    std::swap(first.is_external_, second.is_external_);
   }
 
   std::string toString() {
@@ -144,6 +290,61 @@ class Field {
     }
   }
 
+ private:
+  template <CompareOp op>
+  inline CmpBool Compare(const Field &o) const {
+    ASSERT(CheckComparable(o), "Not comparable.");
+    switch (type_id_) {
+      case TypeId::kTypeInt:
+        return CompareKernel<TypeId::kTypeInt, op>(*this, o);
+      case TypeId::kTypeFloat:
+        return CompareKernel<TypeId::kTypeFloat, op>(*this, o);
+      case TypeId::kTypeChar:
+        return CompareKernel<TypeId::kTypeChar, op>(*this, o);
+      default:
+        ASSERT(false, "Unsupported field type.");
+        return CmpBool::kNull;
+    }
+  }
+
+  template <TypeId type>
+  static CompareFunc GetCompareFunc(CompareOp op) {
+    switch (op) {
+      case CompareOp::kEquals:
+        return &CompareKernel<type, CompareOp::kEquals>;
+      case CompareOp::kNotEquals:
+        return &CompareKernel<type, CompareOp::kNotEquals>;
+      case CompareOp::kLessThan:
+        return &CompareKernel<type, CompareOp::kLessThan>;
+      case CompareOp::kLessThanEquals:
+        return &CompareKernel<type, CompareOp::kLessThanEquals>;
+      case CompareOp::kGreaterThan:
+        return &CompareKernel<type, CompareOp::kGreaterThan>;
+      case CompareOp::kGreaterThanEquals:
+        return &CompareKernel<type, CompareOp::kGreaterThanEquals>;
+    }
+    return nullptr;
+  }
+
+  template <CompareOp op, typename T>
+  static inline bool ApplyCompareOp(T left, T right) {
+    switch (op) {
+      case CompareOp::kEquals:
+        return left == right;
+      case CompareOp::kNotEquals:
+        return left != right;
+      case CompareOp::kLessThan:
+        return left < right;
+      case CompareOp::kLessThanEquals:
+        return left <= right;
+      case CompareOp::kGreaterThan:
+        return left > right;
+      case CompareOp::kGreaterThanEquals:
+        return left >= right;
+    }
+    return false;
+  }
+
  protected:
   union Val {
     int32_t integer_;
@@ -154,6 +355,7 @@ class Field {
   uint32_t len_;
   bool is_null_{false};
   bool manage_data_{false};
+  bool is_external_{false};
 };
 
 #endif  // MINISQL_FIELD_H
@@ -2,6 +2,7 @@
 #define MINISQL_ROW_H
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "common/macros.h"
@@ -9,6 +10,8 @@
 #include "record/field.h"
 #include "record/schema.h"
 
+class MemoryArena;
+
 /**
  *  Row format:
  * -------------------------------------------
@@ -19,7 +22,15 @@
  * | Field Nums | Null bitmap |
  * -------------------------------------------
  *
+ *  In memory, a row keeps its fields in one buffer: the Field objects one after the other, followed by the
+ *  characters of its char fields. The fields never own their characters but point into the buffer, so building or
+ *  copying a row allocates at most once, and a row which is reused (e.g. by an executor which returns one row after
+ *  the other) keeps its buffer and usually does not allocate at all. Moving a row moves the buffer.
+ *
+ *  The buffer of a row may also be taken from the MemoryArena of a query, then the row never mallocs, but it must not
+ *  be used after the arena is reset. A copy of such a row has its buffer on the heap again.
  *
+ *  A field pointer returned by GetField stays valid until the row is changed.
  */
 class Row {
  public:
@@ -29,21 +40,25 @@ class Row {
    */
   Row(std::vector<Field> &fields) {
     // deep copy
+    uint32_t data_size = 0;
+    for (auto &field : fields) {
+      data_size += GetDataSize(field);
+    }
+    Reserve(fields.size(), data_size);
     for (auto &field : fields) {
-      fields_.push_back(new Field(field));
+      AppendField(field);
     }
   }
 
+  /**
+   * Remove all fields, the buffer is kept for the next ones.
+   */
   void destroy() {
-    if (!fields_.empty()) {
-      for (auto field : fields_) {
-        delete field;
-      }
-      fields_.clear();
-    }
+    field_count_ = 0;
+    data_size_ = 0;
   }
 
-  ~Row() { destroy(); };
+  ~Row() { FreeStorage(storage_); };
 
   /**
    * Row used for deserialize
@@ -55,25 +70,39 @@ class Row {
    */
   Row(RowId rid) : rid_(rid) {}
 
+  /**
+   * Row whose buffer is taken from arena
+   */
+  explicit Row(MemoryArena *arena) : arena_(arena) {}
+
   /**
    * Row copy function, deep copy
    */
-  Row(const Row &other) {
-    destroy();
-    rid_ = other.rid_;
-    for (auto &field : other.fields_) {
-      fields_.push_back(new Field(*field));
+  Row(const Row &other) : rid_(other.rid_) { CopyFields(other); }
+
+  /**
+   * Assign operator, deep copy into the buffer of this row
+   */
+  Row &operator=(const Row &other) {
+    if (this != &other) {
+      rid_ = other.rid_;
+      CopyFields(other);
     }
+    return *this;
   }
 
   /**
-   * Assign operator, deep copy
+   * Move constructor, takes over the buffer of other
    */
-  Row &operator=(const Row &other) {
-    destroy();
-    rid_ = other.rid_;
-    for (auto &field : other.fields_) {
-      fields_.push_back(new Field(*field));
+  Row(Row &&other) noexcept { Swap(other); }
+
+  /**
+   * Move assign operator, other gets the buffer of this row and is left empty
+   */
+  Row &operator=(Row &&other) noexcept {
+    if (this != &other) {
+      Swap(other);
+      other.destroy();
     }
     return *this;
   }
@@ -85,6 +114,12 @@ class Row {
 
   uint32_t DeserializeFrom(char *buf, Schema *schema);
 
+  /**
+   * Deserialize a row whose columns are not stored one after the other, e.g. in a PAX page.
+   * @param offsets offset of every column of schema in buf
+   */
+  void DeserializeFrom(const char *buf, const uint32_t *offsets, const Schema *schema);
+
   /**
    * For empty row, return 0
    * For non-empty row with null fields, eg: |null|null|null|, return header size only
@@ -98,18 +133,78 @@ class Row {
 
   inline void SetRowId(RowId rid) { rid_ = rid; }
 
-  inline std::vector<Field *> &GetFields() { return fields_; }
-
   inline Field *GetField(uint32_t idx) const {
-    ASSERT(idx < fields_.size(), "Failed to access field");
-    return fields_[idx];
+    ASSERT(idx < field_count_, "Failed to access field");
+    return GetFieldArray() + idx;
   }
 
-  inline size_t GetFieldCount() const { return fields_.size(); }
+  inline size_t GetFieldCount() const { return field_count_; }
+
+  /**
+   * Make room for field_count fields with data_size bytes of characters in total, so that appending them does not
+   * allocate.
+   */
+  void Reserve(uint32_t field_count, uint32_t data_size);
+
+  /**
+   * Append a copy of field, its characters are copied into the buffer of the row.
+   * @return the copy in the row
+   */
+  Field *AppendField(const Field &field);
+
+  /**
+   * Replace the field at idx with a copy of field.
+   */
+  void SetField(uint32_t idx, const Field &field);
+
+  /** @return bytes a field takes in the buffer of a row besides the Field itself */
+  static inline uint32_t GetDataSize(const Field &field) {
+    return field.GetTypeId() == TypeId::kTypeChar && !field.IsNull() && !field.IsExternal() ? field.GetLength() : 0;
+  }
 
  private:
+  inline Field *GetFieldArray() const { return reinterpret_cast<Field *>(storage_); }
+
+  inline char *GetDataArea() const { return storage_ + field_capacity_ * sizeof(Field); }
+
+  /**
+   * Move the fields into a buffer of the given capacity.
+   * @return the old buffer, to be deleted by the caller once it is no longer read
+   */
+  char *Grow(uint32_t field_capacity, uint32_t data_capacity);
+
+  /** Free a buffer returned by Grow. */
+  inline void FreeStorage(char *storage) const {
+    if (arena_ == nullptr) {
+      delete[] storage;
+    }
+  }
+
+  /** Copy field into dest, which is uninitialized, with its characters at the end of the data area. */
+  void PlaceField(Field *dest, const Field &field);
+
+  /** Append the field of type serialized at buf. @return bytes read */
+  uint32_t DeserializeField(const char *buf, TypeId type);
+
+  void CopyFields(const Row &other);
+
+  void Swap(Row &other) noexcept {
+    std::swap(rid_, other.rid_);
+    std::swap(storage_, other.storage_);
+    std::swap(field_count_, other.field_count_);
+    std::swap(field_capacity_, other.field_capacity_);
+    std::swap(data_size_, other.data_size_);
+    std::swap(data_capacity_, other.data_capacity_);
+    std::swap(arena_, other.arena_);
+  }
+
   RowId rid_{};
-  std::vector<Field *> fields_; /** Make sure that all field ptr are destructed*/
+  char *storage_{nullptr};       // field_capacity_ fields followed by data_capacity_ bytes of characters
+  uint32_t field_count_{0};      // number of fields
+  uint32_t field_capacity_{0};   // number of fields the buffer has room for
+  uint32_t data_size_{0};        // bytes of characters used, including the ones of replaced fields
+  uint32_t data_capacity_{0};    // bytes of characters the buffer has room for
+  MemoryArena *arena_{nullptr};  // where the buffer is taken from, the heap if null
 };
 
 #endif  // MINISQL_ROW_H
@@ -0,0 +1,113 @@
+#ifndef MINISQL_ROW_VIEW_H
+#define MINISQL_ROW_VIEW_H
+
+#include <string>
+#include <vector>
+
+#include "common/macros.h"
+#include "common/rowid.h"
+#include "record/field.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+class OverflowStore;
+
+/**
+ * RowView is a read-only row which points at a serialized row (see Row for the format) instead of owning its fields,
+ * typically the bytes of a tuple in a pinned table page. Reading a column neither deserializes the other columns nor
+ * copies any data, so a scan can evaluate its predicate on a view and only materialize the rows which qualify.
+ *
+ * A view is only valid as long as the bytes it points at stay where they are: for a tuple, as long as its page is
+ * pinned and the tuple is neither updated nor deleted. The offsets of the columns are kept in a vector which is reused
+ * when the view is reset to another row, so walking over many rows with one view does not allocate.
+ *
+ * A char column stored out of line (see OverflowStore) is only read from its overflow pages when it is accessed, and
+ * kept in the view until the view is reset, so columns which are never looked at cost nothing.
+ */
+class RowView {
+ public:
+  RowView() = default;
+
+  /**
+   * Point the view at the serialized row in data, which must follow schema.
+   * @param overflow_store where the char columns stored out of line are read from, needed if there are any
+   * @return size of the serialized row
+   */
+  uint32_t Reset(const char *data, const Schema *schema, RowId rid, const OverflowStore *overflow_store = nullptr);
+
+  /**
+   * Point the view at a tuple whose columns are not stored one after the other, e.g. in a PAX page.
+   * @param column_offsets offset of every column of the tuple in data
+   */
+  void Reset(const char *data, const Schema *schema, RowId rid, const uint32_t *column_offsets,
+             const OverflowStore *overflow_store = nullptr);
+
+  inline bool IsValid() const { return data_ != nullptr; }
+
+  inline RowId GetRowId() const { return rid_; }
+
+  inline uint32_t GetFieldCount() const { return static_cast<uint32_t>(offsets_.size()); }
+
+  inline TypeId GetTypeId(uint32_t idx) const { return schema_->GetColumn(idx)->GetType(); }
+
+  inline int32_t GetInt(uint32_t idx) const {
+    ASSERT(GetTypeId(idx) == TypeId::kTypeInt, "Not an int column.");
+    return MACH_READ_FROM(int32_t, data_ + offsets_[idx]);
+  }
+
+  inline float GetFloat(uint32_t idx) const {
+    ASSERT(GetTypeId(idx) == TypeId::kTypeFloat, "Not a float column.");
+    return MACH_READ_FROM(float, data_ + offsets_[idx]);
+  }
+
+  /** @return whether a char column is stored in overflow pages */
+  inline bool IsExternal(uint32_t idx) const {
+    return GetTypeId(idx) == TypeId::kTypeChar && (MACH_READ_UINT32(data_ + offsets_[idx]) & FIELD_OVERFLOW_FLAG);
+  }
+
+  /** @return id of the first overflow page of a column stored out of line */
+  inline page_id_t GetOverflowPageId(uint32_t idx) const {
+    ASSERT(IsExternal(idx), "Not an external column.");
+    return MACH_READ_FROM(page_id_t, data_ + offsets_[idx] + sizeof(uint32_t));
+  }
+
+  /** @return the characters of a char column, which are not null terminated */
+  inline const char *GetChars(uint32_t idx, uint32_t *len) const {
+    ASSERT(GetTypeId(idx) == TypeId::kTypeChar, "Not a char column.");
+    *len = MACH_READ_UINT32(data_ + offsets_[idx]);
+    if (*len & FIELD_OVERFLOW_FLAG) {
+      return GetExternalChars(idx, len);
+    }
+    return data_ + offsets_[idx] + sizeof(uint32_t);
+  }
+
+  /**
+   * @param manage_data whether a char field copies the characters, otherwise it refers to the bytes of the view and
+   * must not outlive the view
+   */
+  Field GetField(uint32_t idx, bool manage_data = false) const;
+
+  /**
+   * Deserialize the whole row into row, which owns its fields afterwards.
+   */
+  void Materialize(Row *row) const;
+
+ private:
+  /** Read a char column stored out of line, once per reset. */
+  const char *GetExternalChars(uint32_t idx, uint32_t *len) const;
+
+  /** Forget the columns stored out of line which were read for the previous row. */
+  void ResetExternal();
+
+  const char *data_{nullptr};
+  const Schema *schema_{nullptr};
+  RowId rid_{};
+  uint32_t size_{0};               // size of the serialized row, 0 if its columns are not stored together
+  std::vector<uint32_t> offsets_;  // offset of every column in data_
+  const OverflowStore *overflow_store_{nullptr};
+  mutable bool has_external_{false};           // whether a column stored out of line was read for the current row
+  mutable std::vector<std::string> external_;  // characters of the columns stored out of line which were read
+  mutable std::vector<bool> external_read_;    // whether external_ holds a column for the current row
+};
+
+#endif  // MINISQL_ROW_VIEW_H
@@ -2,15 +2,20 @@
 #define DISK_MGR_H
 
 #include <atomic>
-#include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "common/macros.h"
 #include "page/bitmap_page.h"
 #include "page/disk_file_meta_page.h"
+#include "storage/io_worker_pool.h"
 
 /**
  * DiskManager takes care of the allocation and de allocation of pages within a database. It performs the reading and
@@ -19,6 +24,18 @@
  * Disk page storage format: (Free Page BitMap Size = PAGE_SIZE * 8, we note it as N)
  * | Meta Page | Free Page BitMap 1 | Page 1 | Page 2 | ....
  *      | Page N | Free Page BitMap 2 | Page N+1 | ... | Page 2N | ... |
+ *
+ * Pages are read and written with pread/pwrite on a raw file descriptor, so ReadPage and WritePage of different pages
+ * never serialize on a latch. Only the meta page and the bitmap pages, i.e. page allocation, are protected by
+ * db_io_latch_. The file size is cached and only grows when a page past the end of the file is written.
+ *
+ * The bitmap pages are cached in memory once read. Allocation only changes the cached copy and marks it dirty, the
+ * dirty bitmap pages are written together with the meta page when the disk manager is closed. Every cached bitmap
+ * page keeps its own free-bit hint (next_free_page_), so allocating in an extent resumes after the last page handed
+ * out instead of scanning the bitmap from bit 0, and free_extent_hint_ skips the extents that are known to be full.
+ *
+ * ReadPageAsync and WritePageAsync hand the request to a pool of I/O workers, started on first use, so that callers
+ * can keep many page I/Os in flight. After Close they run synchronously.
  */
 class DiskManager {
  public:
@@ -42,6 +59,27 @@ class DiskManager {
    */
   void WritePage(page_id_t logical_page_id, const char *page_data);
 
+  /**
+   * Write several pages at once. The pages are sorted by their position in the file and every run of pages which are
+   * consecutive on disk is written with a single pwritev, different runs are written in parallel on the I/O workers.
+   * @param pages logical page id and data of every page, reordered by the call
+   */
+  void WritePages(std::vector<std::pair<page_id_t, const char *>> &pages);
+
+  /**
+   * Read a page on an I/O worker. page_data must stay valid until the returned future is ready.
+   * @param callback if not empty, called on the I/O worker after the page has been read
+   */
+  std::future<void> ReadPageAsync(page_id_t logical_page_id, char *page_data,
+                                  std::function<void()> callback = nullptr);
+
+  /**
+   * Write a page on an I/O worker. page_data must stay valid and unchanged until the returned future is ready.
+   * @param callback if not empty, called on the I/O worker after the page has been written
+   */
+  std::future<void> WritePageAsync(page_id_t logical_page_id, const char *page_data,
+                                   std::function<void()> callback = nullptr);
+
   /**
    * Get next free page from disk
    * @return logical page id of allocated page
@@ -63,6 +101,9 @@ class DiskManager {
    */
   void Close();
 
+  /** @return number of write system calls issued so far */
+  inline size_t GetNumWriteCalls() const { return num_write_calls_; }
+
   /**
    * Get Meta Page
    * Note: Used only for debug
@@ -73,9 +114,24 @@ class DiskManager {
 
  private:
   /**
-   * Helper function to get disk file size
+   * @return the cached bitmap page of an extent, read from disk on first use. Called with db_io_latch_ held.
    */
-  int GetFileSize(const std::string &file_name);
+  BitmapPage<PAGE_SIZE> *GetBitmapPage(uint32_t extent_id);
+
+  /**
+   * Write the dirty cached bitmap pages and the meta page. Called with db_io_latch_ held.
+   */
+  void FlushMetaPages();
+
+  /**
+   * Run an I/O request on the worker pool, or on the calling thread once the disk manager is closed
+   */
+  std::future<void> SubmitIO(std::function<void()> request);
+
+  /**
+   * Raise the cached file size to at least new_size
+   */
+  void ExtendFileSize(size_t new_size);
 
   /**
    * Read physical page from disk
@@ -87,17 +143,36 @@ class DiskManager {
    */
   void WritePhysicalPage(page_id_t physical_page_id, const char *page_data);
 
+  /**
+   * Write pages which are consecutive on disk, starting at first_physical_page_id, with as few pwritev as possible
+   */
+  void WritePhysicalPages(page_id_t first_physical_page_id, const std::vector<const char *> &pages_data);
+
   /**
    * Map logical page id to physical page id
    */
   page_id_t MapPageId(page_id_t logical_page_id);
 
  private:
-  // stream to write db file
-  std::fstream db_io_;
+  // file descriptor of the db file
+  int db_fd_{-1};
   std::string file_name_;
-  // with multiple buffer pool instances, need to protect file access
-  std::recursive_mutex db_io_latch_;
+  // size of the db file, reads beyond it return zeroed pages without touching the file
+  std::atomic<size_t> file_size_{0};
+  std::atomic<size_t> num_write_calls_{0};
+  // protects the meta page and the bitmap pages
+  std::mutex db_io_latch_;
+  // cached bitmap page of every extent, nullptr until it is first used. Each one carries the free-bit hint of its extent
+  std::vector<std::unique_ptr<BitmapPage<PAGE_SIZE>>> bitmap_pages_;
+  // whether the cached bitmap page differs from the one on disk
+  std::vector<bool> bitmap_dirty_;
+  // no extent before this one has a free page
+  uint32_t free_extent_hint_{0};
+  // workers of the asynchronous I/O requests, created by the first one
+  std::unique_ptr<IOWorkerPool> io_workers_;
+  // protects io_workers_ and io_workers_stopped_
+  std::mutex io_workers_latch_;
+  bool io_workers_stopped_{false};
   bool closed{false};
   char meta_data_[PAGE_SIZE];
 };
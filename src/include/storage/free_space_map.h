@@ -0,0 +1,98 @@
+#ifndef MINISQL_FREE_SPACE_MAP_H
+#define MINISQL_FREE_SPACE_MAP_H
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "page/free_space_map_page.h"
+
+/**
+ * FreeSpaceMap tells a table heap which of its pages has room for a new tuple, so that an insert does not have to
+ * walk the page chain. It is stored in a chain of FreeSpaceMapPage and mirrored in memory, where a max tree over the
+ * categories finds the first page with enough room in logarithmic time.
+ *
+ * The map is only a hint: it is updated after the heap page has changed, and a page it returns may turn out to be
+ * too full, in which case the caller updates the entry and asks again.
+ */
+class FreeSpaceMap {
+ public:
+  /**
+   * Create an empty map, its first page is allocated right away
+   */
+  explicit FreeSpaceMap(BufferPoolManager *buffer_pool_manager);
+
+  /**
+   * Load a map stored on disk
+   */
+  FreeSpaceMap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id);
+
+  /**
+   * @return id of the first page with at least size bytes free, INVALID_PAGE_ID if there is none
+   */
+  page_id_t FindPage(uint32_t size);
+
+  /**
+   * Record a page which has just been added to the end of the heap
+   */
+  void AddPage(page_id_t heap_page_id, uint32_t free_space);
+
+  /**
+   * Record the free space of a page after a tuple has been inserted, deleted or updated in it
+   */
+  void UpdatePage(page_id_t heap_page_id, uint32_t free_space);
+
+  /**
+   * Forget a page which is about to be unlinked from the heap, so that FindPage and GetLastHeapPageId no longer
+   * return it. Called with the heap page write latched, which orders it with the inserts checking Contains.
+   */
+  void RemovePage(page_id_t heap_page_id);
+
+  /**
+   * @return whether the page is part of the heap. Inserts check it with the heap page latched, a page removed by
+   * VACUUM in the meantime must not take new tuples.
+   */
+  bool Contains(page_id_t heap_page_id);
+
+  /**
+   * Drop the entries of removed pages, the map is rewritten on disk and the pages it no longer needs are freed.
+   */
+  void Compact();
+
+  /**
+   * Free the pages of the map on disk
+   */
+  void Destroy();
+
+  inline page_id_t GetFirstPageId() const { return fsm_pages_.front(); }
+
+  /** @return id of the heap page added last, i.e. the tail of the page chain */
+  page_id_t GetLastHeapPageId();
+
+  /** @return number of heap pages in the map */
+  size_t GetNumHeapPages();
+
+  /** @return ids of the heap pages in the order they were added, which is the order of the page chain */
+  std::vector<page_id_t> GetHeapPageIds();
+
+ private:
+  /** Set the category of an entry in memory. Called with latch_ held. */
+  void SetCategory(size_t index, uint8_t category);
+
+  /** Append an entry in memory. Called with latch_ held. */
+  void AppendEntry(page_id_t heap_page_id, uint8_t category);
+
+  BufferPoolManager *buffer_pool_manager_;
+  std::mutex latch_;                                    // protects everything below
+  std::vector<page_id_t> fsm_pages_;                    // pages of the map, in chain order
+  std::vector<page_id_t> heap_pages_;                   // heap page of every entry in the order they were added,
+                                                        // INVALID_PAGE_ID for a removed page until Compact
+  size_t num_removed_{0};                               // number of removed entries in heap_pages_
+  std::vector<uint8_t> categories_;                     // category of every entry
+  std::unordered_map<page_id_t, size_t> entry_index_;  // heap page id -> entry
+  std::vector<uint8_t> max_tree_;                       // max category of every subtree, the leaves start at capacity_
+  size_t capacity_{1};                                  // number of leaves in max_tree_, a power of 2
+};
+
+#endif  // MINISQL_FREE_SPACE_MAP_H
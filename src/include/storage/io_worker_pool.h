@@ -0,0 +1,40 @@
+#ifndef MINISQL_IO_WORKER_POOL_H
+#define MINISQL_IO_WORKER_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/macros.h"
+
+/**
+ * IOWorkerPool runs blocking I/O requests on a fixed set of worker threads, so that a caller can keep several page
+ * reads and writes in flight at once. Requests are started in submission order. The destructor waits until every
+ * submitted request has finished.
+ */
+class IOWorkerPool {
+ public:
+  explicit IOWorkerPool(size_t num_workers);
+
+  ~IOWorkerPool();
+
+  DISALLOW_COPY_AND_MOVE(IOWorkerPool)
+
+  void Submit(std::function<void()> request);
+
+  inline size_t GetNumWorkers() const { return workers_.size(); }
+
+ private:
+  void WorkerLoop();
+
+  std::vector<std::thread> workers_;
+  std::mutex latch_;                           // protects requests_ and stop_
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> requests_;  // submitted requests which no worker has started yet
+  bool stop_{false};
+};
+
+#endif  // MINISQL_IO_WORKER_POOL_H
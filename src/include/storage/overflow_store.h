@@ -0,0 +1,68 @@
+#ifndef MINISQL_OVERFLOW_STORE_H
+#define MINISQL_OVERFLOW_STORE_H
+
+#include <atomic>
+
+#include "buffer/buffer_pool_manager.h"
+#include "page/overflow_page.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * OverflowStore keeps large char fields of a table heap out of line, in the manner of TOAST: a row whose serialized
+ * size exceeds TOAST_ROW_THRESHOLD has its largest char fields written to chains of OverflowPage, and the row itself
+ * only keeps the length of each such field, flagged with FIELD_OVERFLOW_FLAG, and the id of the first page of its
+ * chain. Rows stay small, so a page holds many of them and a scan which does not read those columns never touches the
+ * overflow pages.
+ *
+ * A chain belongs to exactly one stored row and is freed when the row is removed for good or replaced by an update.
+ */
+class OverflowStore {
+ public:
+  explicit OverflowStore(BufferPoolManager *buffer_pool_manager) : buffer_pool_manager_(buffer_pool_manager) {}
+
+  /**
+   * Write len bytes into a new chain of overflow pages.
+   * @return id of the first page of the chain, INVALID_PAGE_ID if the buffer pool has no frame left
+   */
+  page_id_t Write(const char *data, uint32_t len);
+
+  /**
+   * Read the len bytes stored in the chain starting at first_page_id into buf.
+   * @return false if a page of the chain can not be fetched
+   */
+  bool Read(page_id_t first_page_id, uint32_t len, char *buf) const;
+
+  /**
+   * Free the pages of the chain starting at first_page_id.
+   */
+  void Free(page_id_t first_page_id);
+
+  /**
+   * Move the largest char fields of row to overflow pages, one at a time, until the serialized row is no larger than
+   * TOAST_ROW_THRESHOLD or no char field is left whose pointer would be smaller than the field itself.
+   * @param[out] stored copy of row in which the moved fields refer to their overflow pages
+   * @return false if row is small enough as it is, stored is left untouched then
+   */
+  bool Toast(const Row &row, Schema *schema, Row *stored);
+
+  /**
+   * Replace every field of row which refers to overflow pages by a field holding its characters.
+   * @return false if a chain can not be read
+   */
+  bool Detoast(Row *row) const;
+
+  /**
+   * Free the chains the fields of a stored row refer to.
+   */
+  void FreeFields(const Row &row);
+
+  /** @return number of chains read so far */
+  inline size_t GetReads() const { return reads_; }
+
+ private:
+  BufferPoolManager *buffer_pool_manager_;
+  mutable std::atomic<size_t> reads_{0};
+};
+
+#endif  // MINISQL_OVERFLOW_STORE_H
@@ -1,36 +1,76 @@
 #ifndef MINISQL_TABLE_HEAP_H
 #define MINISQL_TABLE_HEAP_H
 
+#include <memory>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/lock_manager.h"
 #include "page/header_page.h"
+#include "page/pax_page.h"
 #include "page/table_page.h"
 #include "recovery/log_manager.h"
+#include "storage/free_space_map.h"
+#include "storage/overflow_store.h"
 #include "storage/table_iterator.h"
 
+/**
+ * TableHeap is a doubly linked chain of TablePage. A FreeSpaceMap records how much room every page has left, so an
+ * insert goes straight to a page which can take the tuple and only appends a page to the chain if none can.
+ *
+ * Rows larger than TOAST_ROW_THRESHOLD keep their largest char fields in overflow pages, see OverflowStore. GetTuple
+ * and the iterator's rows have them read back in, views only read them when the column is accessed.
+ *
+ * All pages of a heap have the layout chosen when it was created, row by row (TablePage) or column by column within
+ * the page (PaxPage). The layout is recorded in every page, so an existing heap is opened the same way for both.
+ */
 class TableHeap {
   friend class TableIterator;
 
  public:
+  /**
+   * Create a new table heap. A PAX heap requires PaxPage::GetCapacity(schema) > 0.
+   */
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, Schema *schema, Txn *txn, LogManager *log_manager,
-                           LockManager *lock_manager) {
-    return new TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager);
+                           LockManager *lock_manager, TableLayout layout = TableLayout::kRow) {
+    return new TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager, layout);
   }
 
+  /**
+   * Open an existing table heap. Without a free space map a new map is built by walking the page chain once.
+   * @return nullptr if the heap was written in an older page format, which is not read
+   */
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                           LogManager *log_manager, LockManager *lock_manager) {
-    return new TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager);
+                           LogManager *log_manager, LockManager *lock_manager,
+                           page_id_t free_space_map_page_id = INVALID_PAGE_ID) {
+    if (!HasCurrentFormat(buffer_pool_manager, first_page_id)) {
+      return nullptr;
+    }
+    return new TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager,
+                         free_space_map_page_id);
   }
 
   ~TableHeap() {}
 
   /**
-   * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * Insert a tuple into the table. Large char fields are moved to overflow pages first, if the tuple is still too large
+   * (>= page_size), or a value does not fit into its column of a PAX page, return false.
    * @param[in/out] row Tuple Row to insert, the rid of the inserted tuple is wrapped in object row
    * @param[in] txn The recovery performing the insert
+   * @param[in] ring Bulk access strategy of a bulk load, pages are read and created through it if not null
    * @return true iff the insert is successful
    */
-  bool InsertTuple(Row &row, Txn *txn);
+  bool InsertTuple(Row &row, Txn *txn, BufferRing *ring = nullptr);
+
+  /**
+   * Insert a batch of tuples in order. Every page is pinned and write latched once and filled with as many of the
+   * tuples as fit, new pages are chained onto the tail while the tail stays latched.
+   * @param[in/out] rows Tuples to insert, the rid of every inserted tuple is wrapped in its row
+   * @param[in] txn The recovery performing the insert
+   * @param[in] ring Bulk access strategy of a bulk load, pages are read and created through it if not null
+   * @return number of tuples inserted, the insert stops at the first tuple which does not fit into an empty page
+   */
+  size_t InsertTuples(std::vector<Row> &rows, Txn *txn, BufferRing *ring = nullptr);
 
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
@@ -72,26 +112,42 @@ class TableHeap {
   bool GetTuple(Row *row, Txn *txn);
 
   void FreeTableHeap() {
+    free_space_map_->Destroy();
     auto next_page_id = first_page_id_;
     while (next_page_id != INVALID_PAGE_ID) {
       auto old_page_id = next_page_id;
       auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(old_page_id));
       assert(page != nullptr);
+      FreeOverflowPages(page, false);
       next_page_id = page->GetNextPageId();
       buffer_pool_manager_->UnpinPage(old_page_id, false);
       buffer_pool_manager_->DeletePage(old_page_id);
     }
   }
 
+  /**
+   * Compact every page in which tuples marked deleted take at least min_dead_ratio of the tuple bytes, see
+   * TablePage::Compact, and unlink the pages which are left without tuples from the chain and free them. The first
+   * page always stays.
+   *
+   * Deleted tuples are removed for good, so this must only run when no transaction which deleted tuples of this table
+   * can still roll back. Inserts may run concurrently: a page is removed from the free space map before it is
+   * unlinked, and one still pinned by another thread is freed by a later VACUUM.
+   * @param[out] pages_freed if not null, number of pages unlinked from the chain
+   * @return number of deleted tuples removed
+   */
+  size_t Vacuum(double min_dead_ratio = DEFAULT_VACUUM_DEAD_RATIO, size_t *pages_freed = nullptr);
+
   /**
    * Free table heap and release storage in disk file
    */
   void DeleteTable(page_id_t page_id = INVALID_PAGE_ID);
 
   /**
+   * @param ring Bulk access strategy of a large scan, the iterator reads the pages through it if not null
    * @return the begin iterator of this table
    */
-  TableIterator Begin(Txn *txn);
+  TableIterator Begin(Txn *txn, std::shared_ptr<BufferRing> ring = nullptr);
 
   /**
    * @return the end iterator of this table
@@ -103,16 +159,42 @@ class TableHeap {
    */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /**
+   * @return the id of the first page of the free space map of this table
+   */
+  inline page_id_t GetFreeSpaceMapPageId() const { return free_space_map_->GetFirstPageId(); }
+
+  /**
+   * @return the number of pages in this table
+   */
+  inline size_t GetNumPages() const { return free_space_map_->GetNumHeapPages(); }
+
+  /**
+   * @return the ids of the pages of this table in chain order, so that a parallel scan can split them up without
+   * walking the chain
+   */
+  inline std::vector<page_id_t> GetPageIds() const { return free_space_map_->GetHeapPageIds(); }
+
+  /**
+   * @return where the fields of this table which are stored out of line live, for views taken of its pages directly
+   */
+  inline const OverflowStore *GetOverflowStore() const { return &overflow_store_; }
+
+  inline TableLayout GetLayout() const { return layout_; }
+
  private:
   /**
    * create table heap and initialize first page
    */
   explicit TableHeap(BufferPoolManager *buffer_pool_manager, Schema *schema, Txn *txn, LogManager *log_manager,
-                     LockManager *lock_manager)
+                     LockManager *lock_manager, TableLayout layout)
       : buffer_pool_manager_(buffer_pool_manager),
         schema_(schema),
         log_manager_(log_manager),
-        lock_manager_(lock_manager) {
+        lock_manager_(lock_manager),
+        overflow_store_(buffer_pool_manager),
+        layout_(layout) {
+    ASSERT(layout_ == TableLayout::kRow || PaxPage::GetCapacity(schema_) > 0, "Rows too wide for a PAX page.");
     // Allocate a page to be the first page of the table.
     page_id_t page_id;
     auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(page_id));
@@ -120,19 +202,59 @@ class TableHeap {
 
     // Store the page id and initialize the page header.
     this->first_page_id_ = page_id;
-    first_page->Init(first_page_id_, INVALID_PAGE_ID, log_manager_, txn);
+    InitPage(first_page, first_page_id_, INVALID_PAGE_ID, txn);
+
+    // Record the free space of the first page.
+    free_space_map_ = std::make_unique<FreeSpaceMap>(buffer_pool_manager_);
+    free_space_map_->AddPage(first_page_id_, first_page->GetFreeSpaceRemaining());
 
     // Unpin the page after initialization. The page is dirty and must be flushed.
     buffer_pool_manager_->UnpinPage(first_page_id_, true);
   };
 
   explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                     LogManager *log_manager, LockManager *lock_manager)
-      : buffer_pool_manager_(buffer_pool_manager),
-        first_page_id_(first_page_id),
-        schema_(schema),
-        log_manager_(log_manager),
-        lock_manager_(lock_manager) {}
+                     LogManager *log_manager, LockManager *lock_manager, page_id_t free_space_map_page_id);
+
+  /**
+   * @return whether the first page of a heap was written in the current page format
+   */
+  static bool HasCurrentFormat(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id);
+
+  /**
+   * Initialize a new page with the layout of this heap.
+   */
+  void InitPage(TablePage *page, page_id_t page_id, page_id_t prev_id, Txn *txn);
+
+  /**
+   * Append a new page to the chain and insert the row into it.
+   * @param[out] tail_moved set if another insert appended a page first, the caller should look for room again
+   * @return true iff the row was inserted
+   */
+  bool AppendPageAndInsert(Row &row, Txn *txn, BufferRing *ring, bool *tail_moved);
+
+  /**
+   * Insert rows[begin..] into a write latched page until one does not fit.
+   * @return number of rows inserted
+   */
+  size_t FillPage(TablePage *page, std::vector<Row> &rows, size_t begin, Txn *txn);
+
+  /**
+   * Append pages to the chain and fill them with rows[begin..], keeping the current tail latched until the next page
+   * is linked.
+   * @param[out] tail_moved set if another insert appended a page first, the caller should look for room again
+   * @return number of rows inserted
+   */
+  size_t AppendPagesAndInsert(std::vector<Row> &rows, size_t begin, Txn *txn, BufferRing *ring, bool *tail_moved);
+
+  /**
+   * Free the overflow pages of the tuples in page, only of the ones marked deleted if deleted_only is set.
+   */
+  void FreeOverflowPages(TablePage *page, bool deleted_only);
+
+  /**
+   * Free the overflow pages the columns of a tuple refer to.
+   */
+  void FreeOverflowPages(const RowView &view);
 
  private:
   BufferPoolManager *buffer_pool_manager_;
@@ -140,6 +262,10 @@ class TableHeap {
   Schema *schema_;
   [[maybe_unused]] LogManager *log_manager_;
   [[maybe_unused]] LockManager *lock_manager_;
+  std::unique_ptr<FreeSpaceMap> free_space_map_;
+  std::vector<page_id_t> unlinked_pages_;  // pages unlinked by VACUUM which were still pinned, freed by the next one
+  OverflowStore overflow_store_;
+  TableLayout layout_;
 };
 
 #endif  // MINISQL_TABLE_HEAP_H
@@ -1,16 +1,33 @@
 #ifndef MINISQL_TABLE_ITERATOR_H
 #define MINISQL_TABLE_ITERATOR_H
 
+#include <memory>
+#include <vector>
+
+#include "buffer/read_ahead.h"
 #include "common/rowid.h"
 #include "concurrency/txn.h"
 #include "record/row.h"
+#include "record/row_view.h"
 
 class TableHeap;
+class TablePage;
 
+/**
+ * TableIterator walks the live tuples of a table heap in page chain order, a page at a time: it pins a page once,
+ * takes views of all its live tuples under a single read latch and then steps through them without going back to the
+ * buffer pool. The page stays pinned while the iterator is on it, so that the views can refer to the tuples in place.
+ * A tuple is only deserialized into a Row when it is dereferenced.
+ *
+ * If the page is changed while the iterator is on it, e.g. by an update of the current tuple, the views of the
+ * remaining tuples are taken again before they are used.
+ */
 class TableIterator {
 public:
  // you may define your own constructor based on your member variables
- explicit TableIterator(TableHeap *table_heap, RowId rid, Txn *txn);
+ // the iterator starts at the first live tuple at or after rid, pages which are not resident yet are read through ring
+ // if it is not null
+ explicit TableIterator(TableHeap *table_heap, RowId rid, Txn *txn, std::shared_ptr<BufferRing> ring = nullptr);
 
   TableIterator(const TableIterator &other);
 
@@ -24,6 +41,34 @@ public:
 
   Row *operator->();
 
+  /**
+   * @return the current tuple in its page, valid until the iterator moves or the page is changed. Callers which share
+   * the heap with other threads use it between RLatchPage and RUnlatchPage.
+   */
+  inline const RowView &GetRowView() const { return views_[cursor_]; }
+
+  /**
+   * Read latch the current page. If the page has changed since the views were taken they are taken again, and the
+   * iterator moves to the next live tuple of the page if the current one is gone.
+   * @return false if the page has no live tuple left, the caller unlatches and moves on
+   */
+  bool RLatchPage();
+
+  void RUnlatchPage();
+
+  /**
+   * The current tuple and the ones after it in the same page, for callers which process a page at a time together
+   * with NextPage.
+   * @param[out] count number of views
+   * @return views of the tuples in slot order, valid until the iterator moves or the page is changed
+   */
+  const RowView *GetPageRowViews(size_t *count);
+
+  /**
+   * Skip the rest of the current page and move to the first tuple of the next page which has one.
+   */
+  TableIterator &NextPage();
+
   TableIterator &operator=(const TableIterator &itr) noexcept;
 
   TableIterator &operator++();
@@ -31,11 +76,34 @@ public:
   TableIterator operator++(int);
 
 private:
+  /**
+   * Move to the first live tuple at or after begin_slot of page page_id, following the page chain if that page has
+   * none. The page which is pinned so far is released unless it is page_id.
+   */
+  void SeekFrom(page_id_t page_id, uint32_t begin_slot);
+
+  /** Take the views of the live tuples of page_ from begin_slot on. Called with page_ latched. */
+  void LoadViews(uint32_t begin_slot);
+
+  /** Pin page_ again for a copy of an iterator. */
+  void PinPage();
+
+  /** Unpin page_ and reset it to nullptr. */
+  void ReleasePage();
+
   // add your own private member variables here
   TableHeap *table_heap_;
   RowId rid_;
   Txn *txn_;
-  Row *row_;
+  TablePage *page_;             // pinned page of rid_, nullptr at the end
+  std::vector<RowView> views_;  // live tuples of page_ from the current one on
+  size_t num_views_;            // number of valid elements in views_, the others keep their buffers
+  size_t cursor_;               // position of rid_ in views_
+  uint32_t mod_count_;          // modification count of page_ when the views were taken
+  Row row_;                     // rid_ deserialized on first access, reused for every row
+  bool row_loaded_{false};      // whether row_ holds rid_
+  std::shared_ptr<BufferRing> ring_;
+  ReadAhead read_ahead_;  // prefetches the heap pages following the current one
 };
 
 #endif  // MINISQL_TABLE_ITERATOR_H
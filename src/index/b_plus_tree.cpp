@@ -7,50 +7,68 @@
 #include "index/generic_key.h"
 #include "page/index_roots_page.h"
 
+// 叶子和内部节点的右兄弟
+static page_id_t NextPageIdOf(BPlusTreePage *node) {
+  if (node->IsLeafPage()) {
+    return reinterpret_cast<BPlusTreeLeafPage *>(node)->GetNextPageId();
+  }
+  return reinterpret_cast<BPlusTreeInternalPage *>(node)->GetNextPageId();
+}
+
 /**
  * TODO: Student Implement
  */
-BPlusTree::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &KM,
-                     int leaf_max_size, int internal_max_size)
+template <typename KeyManagerType>
+BasicBPlusTree<KeyManagerType>::BasicBPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager,
+                                               const KeyManagerType &KM, int leaf_max_size, int internal_max_size)
     : index_id_(index_id),
       buffer_pool_manager_(buffer_pool_manager),
       processor_(KM),
       leaf_max_size_(leaf_max_size),
       internal_max_size_(internal_max_size) {
   // Step 1: 获取索引根页（INDEX_ROOTS_PAGE_ID）
-  auto root_info = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager->FetchPage(INDEX_ROOTS_PAGE_ID));
+  Page *root_info_page = buffer_pool_manager->FetchPage(INDEX_ROOTS_PAGE_ID);
+  auto root_info = reinterpret_cast<IndexRootsPage *>(root_info_page->GetData());
 
   // Step 2: 从元数据中读取当前索引的根页面ID
-  if (root_info->GetRootId(index_id, &root_page_id_)) {
+  page_id_t root_page_id;
+  root_info_page->RLatch();
+  if (root_info->GetRootId(index_id, &root_page_id)) {
     // 已存在根节点
+    root_page_id_ = root_page_id;
   } else {
     // 没有找到对应的根页面
     root_page_id_ = INVALID_PAGE_ID;
   }
+  root_info_page->RUnlatch();
 
-  // Step 3: 如果未指定大小，则根据页大小自动计算最大容量
+  // Step 3: 如果未指定大小，则根据页大小自动计算最大容量，页尾留出高键的位置
   if (leaf_max_size_ == 0) {
     int key_size = processor_.GetKeySize();
-    leaf_max_size_ = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / (key_size + sizeof(RowId));
+    leaf_max_size_ = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - key_size) / (key_size + sizeof(RowId));
   }
 
   if (internal_max_size_ == 0) {
     int key_size = processor_.GetKeySize();
-    internal_max_size_ = (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (key_size + sizeof(page_id_t));
+    internal_max_size_ = (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE - key_size) / (key_size + sizeof(page_id_t));
   }
 
   // Step 4: 解除对根信息页的 pin
   buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
 }
 
-void BPlusTree::Destroy(page_id_t current_page_id) {
+template <typename KeyManagerType>
+void BasicBPlusTree<KeyManagerType>::Destroy(page_id_t current_page_id) {
   // 如果是无效，代表它就是根
   if (current_page_id == INVALID_PAGE_ID) {
     current_page_id = root_page_id_;
   }
   if (root_page_id_ != INVALID_PAGE_ID) {
-    auto root_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID));
+    Page *page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+    auto root_page = reinterpret_cast<IndexRootsPage *>(page->GetData());
+    page->WLatch();
     root_page->Delete(index_id_);
+    page->WUnlatch();
     buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
   }
 
@@ -76,7 +94,8 @@ void BPlusTree::Destroy(page_id_t current_page_id) {
 /*
  * Helper function to decide whether current b+tree is empty
  */
-bool BPlusTree::IsEmpty() const {
+template <typename KeyManagerType>
+bool BasicBPlusTree<KeyManagerType>::IsEmpty() const {
   return root_page_id_ == INVALID_PAGE_ID;
 }
 
@@ -88,20 +107,21 @@ bool BPlusTree::IsEmpty() const {
  * This method is used for point query
  * @return : true means key exists
  */
-bool BPlusTree::GetValue(const GenericKey *key, std::vector<RowId> &result, Txn *transaction) {
-  Page *page = FindLeafPage(key, root_page_id_);
-  if (IsEmpty() || !page) return false;
+template <typename KeyManagerType>
+bool BasicBPlusTree<KeyManagerType>::GetValue(const GenericKey *key, std::vector<RowId> &result, Txn *) {
+  Page *page = FindLeafPageRead(key, LeafTarget::kKey);
+  if (page == nullptr) return false;
   auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
 
   RowId row_id;
   bool found = leaf->Lookup(key, row_id, processor_);
+  page->RUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
 
   if (found) {
     result.push_back(row_id);
-    return true;
   }
-  return false;
+  return found;
 }
 
 /*****************************************************************************
@@ -109,16 +129,29 @@ bool BPlusTree::GetValue(const GenericKey *key, std::vector<RowId> &result, Txn
  *****************************************************************************/
 /*
  * Insert constant key & value pair into b+ tree
- * if current tree is empty, start new tree, update root page id and insert
- * entry, otherwise insert into leaf page.
+ * The leaf is first reached optimistically and the pair inserted in place when
+ * the leaf will not split; otherwise insertion restarts pessimistically in
+ * InsertIntoLeaf, which also starts a new tree when the tree is empty.
  * @return: since we only support unique key, if user try to insert duplicate
  * keys return false, otherwise return true.
  */
-bool BPlusTree::Insert(GenericKey *key, const RowId &value, Txn *transaction) {
-  if (IsEmpty()) {
-    StartNewTree(key, value);
-    return true;
+template <typename KeyManagerType>
+bool BasicBPlusTree<KeyManagerType>::Insert(GenericKey *key, const RowId &value, Txn *transaction) {
+  bool is_root = false;
+  Page *page = FindLeafPageOptimistic(key, is_root);
+  if (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    if (IsSafe(leaf, Operation::kInsert, is_root)) {
+      int size = leaf->GetSize();
+      bool inserted = leaf->Insert(key, value, processor_) != size;
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), inserted);
+      return inserted;
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
   }
+  // 空树或叶子会分裂，悲观地重新下降
   return InsertIntoLeaf(key, value, transaction);
 }
 /*
@@ -126,8 +159,10 @@ bool BPlusTree::Insert(GenericKey *key, const RowId &value, Txn *transaction) {
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then update b+
  * tree's root page id and insert entry directly into leaf page.
+ * Called with root_latch_ write latched.
  */
-void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
+template <typename KeyManagerType>
+void BasicBPlusTree<KeyManagerType>::StartNewTree(GenericKey *key, const RowId &value) {
   // 分配新页面
   page_id_t new_page_id;
   Page *page = buffer_pool_manager_->NewPage(new_page_id);
@@ -135,61 +170,54 @@ void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
   // 检查内存分配是否成功
   if (page == nullptr) throw std::overflow_error("Error: Out of memory, can't build a new tree");
 
-
-  // 更新当前树的根页面 ID
-  root_page_id_ = new_page_id;
-  // 将该页解释为叶子节点
+  // 将该页解释为叶子节点并初始化，next_page_id 为无效（因为这是唯一的叶子页）
   auto *leaf_node = reinterpret_cast<LeafPage *>(page->GetData());
-
-  // 初始化叶子节点
   leaf_node->Init(new_page_id, INVALID_PAGE_ID, processor_.GetKeySize(), leaf_max_size_);
-  // 设置 next_page_id 为无效（因为这是唯一的叶子页）
-  leaf_node->SetNextPageId(INVALID_PAGE_ID);
 
   // 插入第一个键值对
-  int inserted_count = leaf_node->Insert(key, value, processor_);
-  if (inserted_count < 0) {
-    // 可选：处理插入失败的情况（比如 key 已存在）
-    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-    buffer_pool_manager_->DeletePage(page->GetPageId());
-    throw std::runtime_error("Failed to insert first key-value pair into new B+ Tree");
-  }
+  leaf_node->Insert(key, value, processor_);
 
   // 解除 pin，并标记为 dirty（因为内容被修改了）
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
 
-  // 持久化根页面信息到 header page
+  // 更新当前树的根页面 ID，并持久化到 header page
+  root_page_id_ = new_page_id;
   UpdateRootPageId(true);
 }
 
 /*
- * Insert constant key & value pair into leaf page
+ * Insert constant key & value pair into leaf page, descending pessimistically
  * User needs to first find the right leaf page as insertion target, then look
  * through leaf page to see whether insert key exist or not. If exist, return
  * immediately, otherwise insert entry. Remember to deal with split if necessary.
  * @return: since we only support unique key, if user try to insert duplicate
  * keys return false, otherwise return true.
  */
-bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Txn *transaction) {
-  Page *leaf_page = FindLeafPage(key, root_page_id_, false);
-  if (leaf_page == nullptr)  return false;
-  RowId row_id;
+template <typename KeyManagerType>
+bool BasicBPlusTree<KeyManagerType>::InsertIntoLeaf(GenericKey *key, const RowId &value, Txn *transaction) {
+  WriteSet write_set;
+  Page *leaf_page = FindLeafPageWrite(key, Operation::kInsert, write_set);
+  if (leaf_page == nullptr) {
+    // 空树，此时持有 root_latch_ 的写latch
+    StartNewTree(key, value);
+    ReleaseWriteSet(write_set);
+    return true;
+  }
   auto *leaf = reinterpret_cast<LeafPage *>(leaf_page->GetData());
 
-  // 如果插入后小于（最大个数 - 1），那么就不分裂
-  if (leaf->GetSize() < leaf->GetMaxSize() - 1) {
-    leaf->Insert(key, value, processor_);
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
-    return true;
+  int size = leaf->GetSize();
+  if (leaf->Insert(key, value, processor_) == size) {
+    // 键已存在
+    ReleaseWriteSet(write_set);
+    return false;
   }
-  // 超过的情况，要分裂
-  leaf->Insert(key, value, processor_);
-  if (leaf->GetSize() == leaf->GetMaxSize()) {
+  // 达到最大个数时分裂，分裂会修改的祖先节点都还在 write_set 中
+  if (leaf->GetSize() >= leaf->GetMaxSize()) {
     LeafPage *new_leaf = Split(leaf, transaction);
-    GenericKey *new_key = new_leaf->KeyAt(0);
-    InsertIntoParent(leaf, new_key, new_leaf, transaction);
+    InsertIntoParent(leaf, new_leaf->KeyAt(0), new_leaf, transaction);
+    buffer_pool_manager_->UnpinPage(new_leaf->GetPageId(), true);
   }
-  buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+  ReleaseWriteSet(write_set);
   return true;
 }
 
@@ -199,8 +227,10 @@ bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Txn *transac
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
+ * The new page is returned pinned.
  */
-BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Txn *transaction) {
+template <typename KeyManagerType>
+BPlusTreeInternalPage *BasicBPlusTree<KeyManagerType>::Split(InternalPage *node, Txn *transaction) {
   page_id_t new_page_id;
   Page *new_page = buffer_pool_manager_->NewPage(new_page_id);
   if (new_page == nullptr) throw std::overflow_error("Error: Out of memory, can't build a new page");
@@ -208,26 +238,19 @@ BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Txn *transaction) {
 
   new_node->Init(new_page_id, node->GetParentPageId(), processor_.GetKeySize(), internal_max_size_);
   node->MoveHalfTo(new_node, buffer_pool_manager_);
-  // 解除 pin，并标记为 dirty（因为内容被修改了）
-  buffer_pool_manager_->UnpinPage(new_page_id, true);
-
   return new_node;
 }
 
-BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Txn *transaction) {
+template <typename KeyManagerType>
+BPlusTreeLeafPage *BasicBPlusTree<KeyManagerType>::Split(LeafPage *node, Txn *transaction) {
   page_id_t new_page_id;
   Page *new_page = buffer_pool_manager_->NewPage(new_page_id);
   if (new_page == nullptr) throw std::overflow_error("Error: Out of memory, can't build a new page");
   auto *new_leaf = reinterpret_cast<LeafPage *>(new_page->GetData());
 
   new_leaf->Init(new_page_id, node->GetParentPageId(), processor_.GetKeySize(), leaf_max_size_);
+  // MoveHalfTo也维护了叶子链表：node -> new_leaf -> 原来的下一页
   node->MoveHalfTo(new_leaf);
-  new_leaf->SetNextPageId(node->GetNextPageId());
-  node->SetNextPageId(new_page->GetPageId());
-  // 解除 pin，并标记为 dirty（因为内容被修改了）
-  buffer_pool_manager_->UnpinPage(new_page->GetPageId(), true);         // 新页
-  buffer_pool_manager_->UnpinPage(node->GetPageId(), true);             // 原页
-
   return new_leaf;
 }
 
@@ -239,51 +262,43 @@ BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Txn *transaction) {
  * User needs to first find the parent page of old_node, parent node must be
  * adjusted to take info of new_node into account. Remember to deal with split
  * recursively if necessary.
+ * The parent of old_node, or root_latch_ when old_node is the root, is write
+ * latched by the caller.
  */
-void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node, Txn *transaction) {
+template <typename KeyManagerType>
+void BasicBPlusTree<KeyManagerType>::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node,
+                                                      Txn *transaction) {
   if (old_node->IsRootPage()) {
     // 创建新的根节点
-    Page *new_page = buffer_pool_manager_->NewPage(root_page_id_);
+    page_id_t new_root_id;
+    Page *new_page = buffer_pool_manager_->NewPage(new_root_id);
+    if (new_page == nullptr) throw std::overflow_error("Error: Out of memory, can't build a new root");
     auto *new_root = reinterpret_cast<InternalPage *>(new_page->GetData());
-    new_root->Init(root_page_id_, INVALID_PAGE_ID, processor_.GetKeySize(), internal_max_size_);
+    new_root->Init(new_root_id, INVALID_PAGE_ID, processor_.GetKeySize(), internal_max_size_);
 
-    // 设置子节点
+    // 设置子节点，更新子节点的父指针
     new_root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    old_node->SetParentPageId(new_root_id);
+    new_node->SetParentPageId(new_root_id);
+    buffer_pool_manager_->UnpinPage(new_root_id, true);
 
-    // 更新子节点的父指针
-    old_node->SetParentPageId(root_page_id_);
-    new_node->SetParentPageId(root_page_id_);
-
-    // unpin 旧节点和新节点，Update 默认根节点
-    buffer_pool_manager_->UnpinPage(root_page_id_, true);
+    root_page_id_ = new_root_id;
     UpdateRootPageId(0);
-    buffer_pool_manager_->UnpinPage(old_node->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(new_node->GetPageId(), true);
     return;
   }
 
-  // 获取父节点
+  // 获取父节点，在父节点中插入新的键和指针
   page_id_t parent_id = old_node->GetParentPageId();
-  Page *parent_page = buffer_pool_manager_->FetchPage(parent_id);
-  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
-
-  // 在父节点中插入新的键和指针
+  auto *parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(parent_id)->GetData());
   parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
-
   new_node->SetParentPageId(parent_id);
 
-  // 插入完成后 unpin 旧节点和新节点
-  buffer_pool_manager_->UnpinPage(old_node->GetPageId(), true);
-  buffer_pool_manager_->UnpinPage(new_node->GetPageId(), true);
-
   // 检查是否需要分裂父节点
-  if (parent->GetSize() >= internal_max_size_) {
+  if (parent->GetSize() >= parent->GetMaxSize()) {
     InternalPage *new_parent = Split(parent, transaction);
-    GenericKey *new_key = new_parent->KeyAt(0);
-    InsertIntoParent(parent, new_key, new_parent, transaction);
+    InsertIntoParent(parent, new_parent->KeyAt(0), new_parent, transaction);
     buffer_pool_manager_->UnpinPage(new_parent->GetPageId(), true);
   }
-
   buffer_pool_manager_->UnpinPage(parent_id, true);
 }
 
@@ -296,258 +311,151 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
  * If not, User needs to first find the right leaf page as deletion target, then
  * delete entry from leaf page. Remember to deal with redistribute or merge if
  * necessary.
+ * As with Insert, a delete that leaves the leaf at least half full is done
+ * optimistically and only an underflowing one restarts pessimistically.
  */
-void BPlusTree::Remove(const GenericKey *key, Txn *transaction) {
-  if (IsEmpty()) return; // 空
-  Page *page = FindLeafPage(key, root_page_id_, false);
-  if (page == nullptr) return;  // 没找到
+template <typename KeyManagerType>
+void BasicBPlusTree<KeyManagerType>::Remove(const GenericKey *key, Txn *) {
+  bool is_root = false;
+  Page *page = FindLeafPageOptimistic(key, is_root);
+  if (page == nullptr) return;  // 空树
   auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
-
-  int size = leaf->RemoveAndDeleteRecord(key, processor_);
-  // 如果 key 不存在或删除失败，直接返回
-  if (size == -1 || size == leaf->GetSize()) {
-    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-    return;
-  }
-  // Case 1: 如果是根节点
-  if (leaf->IsRootPage()) {
-    if (leaf->GetSize() == 0 && AdjustRoot(leaf)) {
-      buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
-      buffer_pool_manager_->DeletePage(leaf->GetPageId());
-      return;
-    }
-    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  if (IsSafe(leaf, Operation::kRemove, is_root)) {
+    int size = leaf->GetSize();
+    bool removed = leaf->RemoveAndDeleteRecord(key, processor_) != size;
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), removed);
     return;
   }
-  // Case 2: 非根节点
-  bool should_update_parent = (size >= 0);
-  if (size < leaf->GetMinSize()) {
-    CoalesceOrRedistribute(leaf, transaction);
-    return;
-  }
-  if (should_update_parent) {
-    // 如果没有发生合并或重分布，则更新浮木节点的分隔键
-    page_id_t ParentId = leaf->GetParentPageId();
-    Page *parent_page = buffer_pool_manager_->FetchPage(ParentId);
-    auto *parent_node = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
 
-    int node_index = parent_node->ValueIndex(leaf->GetPageId());
-    // 只有当不是最左子节点时才更新（内部节点中的第一个键是虚拟的）
-    if (node_index > 0) {
-      parent_node->SetKeyAt(node_index, leaf->KeyAt(0));
+  // 叶子会下溢，悲观地重新下降；合并和重分配会把键左移，期间不允许查找
+  smo_latch_.WLock();
+  WriteSet write_set;
+  page = FindLeafPageWrite(key, Operation::kRemove, write_set);
+  if (page != nullptr) {
+    leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    int size = leaf->GetSize();
+    if (leaf->RemoveAndDeleteRecord(key, processor_) != size &&
+        (leaf->IsRootPage() ? leaf->GetSize() == 0 : leaf->GetSize() < leaf->GetMinSize())) {
+      CoalesceOrRedistribute(leaf, write_set);
     }
-
-    buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
   }
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  ReleaseWriteSet(write_set);
+  smo_latch_.WUnlock();
 }
 
-/* todo
+/*
  * User needs to first find the sibling of input page. If sibling's size + input
  * page's size > page's max size, then redistribute. Otherwise, merge.
  * Using template N to represent either internal page or leaf page.
- * @return: true means target leaf page should be deleted, false means no
- * deletion happens
+ * The node and its parent are write latched by the caller, the sibling is
+ * latched here; pages emptied by a merge are left in write_set.deleted.
  */
+template <typename KeyManagerType>
 template <typename N>
-bool BPlusTree::CoalesceOrRedistribute(N *&node, Txn *txn) {
-  // Step 1: 如果是根节点，尝试调整根
-  if (node->IsRootPage() && (!AdjustRoot(node))) {
-    return false;
-  } else if (node->IsRootPage() && AdjustRoot(node)) {
-    buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
-    return true;
+void BasicBPlusTree<KeyManagerType>::CoalesceOrRedistribute(N *node, WriteSet &write_set) {
+  // 根节点只在变空或只剩一个孩子时调整
+  if (node->IsRootPage()) {
+    AdjustRoot(node, write_set);
+    return;
   }
 
-  // Step 2: 获取父节点
-  Page *parent_page = buffer_pool_manager_->FetchPage(node->GetParentPageId());
-  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
-
-  // Step 3: 获取当前节点在父节点中的索引
-  int node_index = parent->ValueIndex(node->GetPageId());
-
-  // Step 4: 如果是叶子节点，更新父节点中对应 key
-  if (node->IsLeafPage()) {
-    parent->SetKeyAt(node_index, node->KeyAt(0));
-  }
-
-  // Step 5: 根据当前节点的位置决定如何处理
-  bool coalesce = false;
-  int parentsize = parent->GetSize();
-  // 定义处理策略
-  // 最左边节点：只能找右边的兄弟
-  auto handle_leftmost = [&]() {
-    N* right = reinterpret_cast<N*>(buffer_pool_manager_->FetchPage(parent->ValueAt(1)));
-    if (right->GetSize() + node->GetSize() <= node->GetMaxSize()) {
-      coalesce = Coalesce(right, node, parent, node_index, txn);
-    } else {
-      Redistribute(right, node, 0); // 向右借
-    }
-    buffer_pool_manager_->UnpinPage(right->GetPageId(), true);
-  };
-
-  // 最右边节点：只能找左边的兄弟
-  auto handle_rightmost = [&]() {
-    N* left = reinterpret_cast<N*>(buffer_pool_manager_->FetchPage(parent->ValueAt(node_index - 1)));
-    if (left->GetSize() + node->GetSize() <= node->GetMaxSize()) {
-      coalesce = Coalesce(node, left, parent, node_index - 1, txn);
-    } else {
-      Redistribute(left, node, 1); // 向左借
-    }
-    buffer_pool_manager_->UnpinPage(left->GetPageId(), true);
-  };
-
-  // 中间节点：尝试左右两个兄弟
-  auto handle_middle = [&]() {
-    N* left = reinterpret_cast<N*>(buffer_pool_manager_->FetchPage(parent->ValueAt(node_index - 1)));
-    N* right = reinterpret_cast<N*>(buffer_pool_manager_->FetchPage(parent->ValueAt(node_index + 1)));
+  page_id_t parent_id = node->GetParentPageId();
+  auto *parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(parent_id)->GetData());
+  int index = parent->ValueIndex(node->GetPageId());
 
-    bool use_left = (left->GetSize() + node->GetSize() <= node->GetMaxSize());
-    bool use_right = (right->GetSize() + node->GetSize() <= node->GetMaxSize());
+  // 最左边的节点找右兄弟，其余找左兄弟；父节点持有写latch，兄弟节点不会被其他悲观操作同时修改
+  Page *sibling_page = buffer_pool_manager_->FetchPage(parent->ValueAt(index == 0 ? 1 : index - 1));
+  sibling_page->WLatch();
+  auto *sibling = reinterpret_cast<N *>(sibling_page->GetData());
 
-    if (use_left) {
-      buffer_pool_manager_->UnpinPage(right->GetPageId(), false);
-      coalesce = Coalesce(node, left, parent, node_index - 1, txn);
-    } else if (use_right) {
-      buffer_pool_manager_->UnpinPage(left->GetPageId(), false);
-      coalesce = Coalesce(node, right, parent, node_index, txn);
+  if (sibling->GetSize() + node->GetSize() < node->GetMaxSize()) {
+    // 合并时总是把右边的节点并入左边
+    if (index == 0) {
+      Coalesce(node, sibling, parent, 1, write_set);
     } else {
-      buffer_pool_manager_->UnpinPage(right->GetPageId(), false);
-      buffer_pool_manager_->UnpinPage(left->GetPageId(), false);
-      Redistribute(left, node, 1);
+      Coalesce(sibling, node, parent, index, write_set);
     }
-
-    if (!use_left) buffer_pool_manager_->UnpinPage(left->GetPageId(), true);
-  };
-
-  // 策略选择
-  if (node_index == 0) {
-    handle_leftmost();
-  } else if (node_index == parentsize - 1) {
-    handle_rightmost();
   } else {
-    handle_middle();
+    Redistribute(sibling, node, parent, index);
   }
+  sibling_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(sibling_page->GetPageId(), true);
 
-  // Step 6: 释放资源
-  buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
-  buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
-
-  return coalesce;
+  // 合并使父节点少了一项，父节点可能继续下溢
+  if (parent->IsRootPage() ? parent->GetSize() == 1 : parent->GetSize() < parent->GetMinSize()) {
+    CoalesceOrRedistribute(parent, write_set);
+  }
+  buffer_pool_manager_->UnpinPage(parent_id, true);
 }
 
 /*
- * Move all the key & value pairs from one page to its sibling page, and notify
- * buffer pool manager to delete this page. Parent page must be adjusted to
- * take info of deletion into account. Remember to deal with coalesce or
- * redistribute recursively if necessary.
- * Using template N to represent either internal page or leaf page.
- * @param   neighbor_node      sibling page of input "node"
- * @param   node               input from method coalesceOrRedistribute()
- * @param   parent             parent page of input "node"
- * @return  true means parent node should be deleted, false means no deletion happened
+ * Move all the key & value pairs from the right page into its left sibling and
+ * remove the right page from the parent. The right page is deleted once the
+ * latches are released.
+ * @param   left      left one of the two siblings, receives the pairs
+ * @param   right     right one of the two siblings
+ * @param   parent    parent page of both
+ * @param   index     index of right in parent
  */
-bool BPlusTree::Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage *&parent, int index,
-                         Txn *transaction) {
-  // Step 1: 移动所有记录到邻居节点
-  node->MoveAllTo(neighbor_node);
-
-  // 更新叶子链表 next 指针
-  // neighbor_node->SetNextPageId(node->GetNextPageId()); MoveAllTo干了这个操作了
-
-  // Step 2: 删除父节点中对应的 key 和子节点指针
+template <typename KeyManagerType>
+void BasicBPlusTree<KeyManagerType>::Coalesce(LeafPage *left, LeafPage *right, InternalPage *parent, int index,
+                                              WriteSet &write_set) {
+  // MoveAllTo同时维护叶子链表 next 指针
+  right->MoveAllTo(left);
   parent->Remove(index);
-
-  // Step 3: 释放当前节点资源
-  buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
-  buffer_pool_manager_->DeletePage(node->GetPageId());
-  int parentsize = parent->GetSize(); // 先获取父节点信息
-  buffer_pool_manager_->UnpinPage(neighbor_node->GetPageId(), true);
-  // Step 4: 判断父节点是否下溢
-  if (parentsize < parent->GetMinSize()) {
-    return CoalesceOrRedistribute(parent, transaction);
-  } else {
-    buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
-  }
-  return false;
+  write_set.deleted.push_back(right->GetPageId());
 }
 
-// 内部节点合并 (Coalesce Internal)
-bool BPlusTree::Coalesce(InternalPage *&neighbor_node, InternalPage *&node, InternalPage *&parent, int index,
-                         Txn *transaction) {
-  node->MoveAllTo(neighbor_node, parent->KeyAt(index), buffer_pool_manager_);
-  // 删除父节点中对应的 key 和子节点指针
+// 内部节点合并 (Coalesce Internal)，父节点中的分隔键下移到左节点
+template <typename KeyManagerType>
+void BasicBPlusTree<KeyManagerType>::Coalesce(InternalPage *left, InternalPage *right, InternalPage *parent, int index,
+                                              WriteSet &write_set) {
+  right->MoveAllTo(left, parent->KeyAt(index), buffer_pool_manager_);
   parent->Remove(index);
-  buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
-  buffer_pool_manager_->DeletePage(node->GetPageId());
-  int parentsize = parent->GetSize();
-  buffer_pool_manager_->UnpinPage(neighbor_node->GetPageId(), true);
-  if (parentsize < parent->GetMinSize()) {
-    return CoalesceOrRedistribute(parent, transaction);
-  } else {
-    buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
-  }
-  return false;
+  write_set.deleted.push_back(right->GetPageId());
 }
 
 /*
  * Redistribute key & value pairs from one page to its sibling page. If index ==
  * 0, move sibling page's first key & value pair into end of input "node",
  * otherwise move sibling page's last key & value pair into head of input
- * "node".
- * Using template N to represent either internal page or leaf page.
+ * "node". The separator key in the parent is updated to match.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
+ * @param   index              index of node in parent
  */
-void BPlusTree::Redistribute(LeafPage *neighbor_node, LeafPage *node, int index) {
-  page_id_t parent_id = neighbor_node->GetParentPageId();
-  Page *parent = buffer_pool_manager_->FetchPage(parent_id);
-  auto *parent_node = reinterpret_cast<InternalPage *>(parent->GetData());
-
-  LeafPage *temp;
+template <typename KeyManagerType>
+void BasicBPlusTree<KeyManagerType>::Redistribute(LeafPage *neighbor_node, LeafPage *node, InternalPage *parent,
+                                                  int index) {
   if (index == 0) {
     // 将右兄弟的第一个元素移动到末尾
     neighbor_node->MoveFirstToEndOf(node);
-    temp = neighbor_node;
+    parent->SetKeyAt(1, neighbor_node->KeyAt(0));
+    node->SetHighKey(neighbor_node->KeyAt(0));
   } else {
     // 将左兄弟的最后一个元素移动到头部
     neighbor_node->MoveLastToFrontOf(node);
-    temp = node;
+    parent->SetKeyAt(index, node->KeyAt(0));
+    neighbor_node->SetHighKey(node->KeyAt(0));
   }
-
-  // 找到当前 node 在父节点中的位置
-  int node_index = parent_node->ValueIndex(temp->GetPageId());
-
-  // 更新父节点的 key
-  node->SetKeyAt(node_index, temp->KeyAt(0));
-
-  // unpin 解锁
-  buffer_pool_manager_->UnpinPage(parent_node->GetPageId(), true);
 }
-void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, int index) {
-  // 获取父节点
-  page_id_t parent_id = neighbor_node->GetParentPageId();
-  Page *parent_page = buffer_pool_manager_->FetchPage(parent_id);
-  auto *parent_node = reinterpret_cast<InternalPage *>(parent_page->GetData());
-  int node_index = 0;
-  InternalPage *temp;
-  // index=0表示node是neighbor的右兄弟，否则是左兄弟
+
+template <typename KeyManagerType>
+void BasicBPlusTree<KeyManagerType>::Redistribute(InternalPage *neighbor_node, InternalPage *node,
+                                                  InternalPage *parent, int index) {
+  // 父节点的分隔键下移，移动后右边节点的 KeyAt(0) 即新的分隔键，也是左边节点的高键
   if (index == 0) {
-    temp = neighbor_node;
-    node_index = parent_node->ValueIndex(temp->GetPageId());
-    // 将右兄弟的第一个元素移动到当前节点的末尾
-    neighbor_node->MoveFirstToEndOf(node, parent_node->KeyAt(node_index), buffer_pool_manager_);
+    neighbor_node->MoveFirstToEndOf(node, parent->KeyAt(1), buffer_pool_manager_);
+    parent->SetKeyAt(1, neighbor_node->KeyAt(0));
+    node->SetHighKey(neighbor_node->KeyAt(0));
   } else {
-    temp = node;
-    node_index = parent_node->ValueIndex(temp->GetPageId());
-    // 将左兄弟的最后一个元素移动到当前节点的头部
-    neighbor_node->MoveLastToFrontOf(node, parent_node->KeyAt(node_index), buffer_pool_manager_);
+    neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(index), buffer_pool_manager_);
+    parent->SetKeyAt(index, node->KeyAt(0));
+    neighbor_node->SetHighKey(node->KeyAt(0));
   }
-  // 更新父节点的分隔键
-  parent_node->SetKeyAt(node_index, temp->KeyAt(0));
-
-  buffer_pool_manager_->UnpinPage(parent_id, true);
 }
 /*
  * Update root page if necessary
@@ -556,36 +464,27 @@ void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, in
  * case 1: when you delete the last element in root page, but root page still
  * has one last child
  * case 2: when you delete the last element in whole b+ tree
- * @return : true means root page should be deleted, false means no deletion
- * happened
+ * The old root is deleted once the latches are released. Called with
+ * root_latch_ write latched.
  */
-bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
-  // 情况1：删除后根节点仍有子节点
+template <typename KeyManagerType>
+void BasicBPlusTree<KeyManagerType>::AdjustRoot(BPlusTreePage *old_root_node, WriteSet &write_set) {
   if (!old_root_node->IsLeafPage() && old_root_node->GetSize() == 1) {
+    // 情况1：删除后根节点只剩一个子节点，子节点成为新的根
     auto *internal = reinterpret_cast<InternalPage *>(old_root_node);
-    root_page_id_ = internal->ValueAt(0);
-
-    // 更新新根节点的父指针
-    Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
-    auto *new_root = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    page_id_t child_id = internal->RemoveAndReturnOnlyChild();
+    auto *new_root = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(child_id)->GetData());
     new_root->SetParentPageId(INVALID_PAGE_ID);
-    buffer_pool_manager_->UnpinPage(root_page_id_, true);
-
-    // 释放旧根节点
-    buffer_pool_manager_->UnpinPage(old_root_node->GetPageId(), true);
-    buffer_pool_manager_->DeletePage(old_root_node->GetPageId());
-
-    UpdateRootPageId(0);
-    return true;
-  }
-  // 情况2：树中最后一个元素被删除
-  else if (old_root_node->IsLeafPage() && old_root_node->GetSize() == 0) {
+    buffer_pool_manager_->UnpinPage(child_id, true);
+    root_page_id_ = child_id;
+  } else if (old_root_node->IsLeafPage() && old_root_node->GetSize() == 0) {
+    // 情况2：树中最后一个元素被删除
     root_page_id_ = INVALID_PAGE_ID;
-    UpdateRootPageId(0);
-    return true;
+  } else {
+    return;
   }
-  // 情况3：不应到达的地方
-  return false;
+  write_set.deleted.push_back(old_root_node->GetPageId());
+  UpdateRootPageId(0);
 }
 
 /*****************************************************************************
@@ -596,12 +495,11 @@ bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
  * index iterator
  * @return : index iterator
  */
-IndexIterator BPlusTree::Begin() {
-  Page *page = FindLeafPage(nullptr, INVALID_PAGE_ID, true);
+template <typename KeyManagerType>
+IndexIterator BasicBPlusTree<KeyManagerType>::Begin() {
+  Page *page = FindLeafPageRead(nullptr, LeafTarget::kLeftMost);
   if (page == nullptr) {return IndexIterator();}
-  int page_id = page->GetPageId();
-  buffer_pool_manager_->UnpinPage(page_id, false);
-  return IndexIterator(page_id, buffer_pool_manager_);
+  return IndexIterator(buffer_pool_manager_, LeafFinder(), page);
 }
 
 /*
@@ -609,13 +507,12 @@ IndexIterator BPlusTree::Begin() {
  * first, then construct index iterator
  * @return : index iterator
  */
-IndexIterator BPlusTree::Begin(const GenericKey *key) {
-  Page *page = FindLeafPage(key, INVALID_PAGE_ID, true);
+template <typename KeyManagerType>
+IndexIterator BasicBPlusTree<KeyManagerType>::Begin(const GenericKey *key) {
+  int index = 0;
+  Page *page = LeafFinder()(key, &index);
   if (page == nullptr) {return IndexIterator();}
-  int page_id = page->GetPageId();
-  auto *node = reinterpret_cast<LeafPage *>(page);
-  buffer_pool_manager_->UnpinPage(page_id, false);
-  return IndexIterator(page_id, buffer_pool_manager_, node->KeyIndex(key, processor_));
+  return IndexIterator(buffer_pool_manager_, LeafFinder(), page, index);
 }
 
 /*
@@ -623,18 +520,28 @@ IndexIterator BPlusTree::Begin(const GenericKey *key) {
  * of the key/value pair in the leaf node
  * @return : index iterator
  */
-IndexIterator BPlusTree::End() {
-  auto *node = reinterpret_cast<LeafPage *>(FindLeafPage(nullptr, INVALID_PAGE_ID, true));
-  BPlusTreeLeafPage *next_node;
-  if (node == nullptr) {return IndexIterator();}
-  while (node->GetNextPageId() != INVALID_PAGE_ID) {
-    next_node = reinterpret_cast<LeafPage *>(buffer_pool_manager_->FetchPage(node->GetNextPageId()));
-    buffer_pool_manager_->UnpinPage(node->GetPageId(), false);
-    node = next_node;
-  }
-  page_id_t page_id = node->GetPageId();
-  buffer_pool_manager_->UnpinPage(page_id, false);
-  return IndexIterator(page_id, buffer_pool_manager_, node->GetSize());
+template <typename KeyManagerType>
+IndexIterator BasicBPlusTree<KeyManagerType>::End() {
+  // 最右边的叶子就是叶子链表的最后一个
+  Page *page = FindLeafPageRead(nullptr, LeafTarget::kRightMost);
+  if (page == nullptr) {return IndexIterator();}
+  int size = reinterpret_cast<LeafPage *>(page->GetData())->GetSize();
+  return IndexIterator(buffer_pool_manager_, LeafFinder(), page, size);
+}
+
+/*
+ * Lookup the iterators move to the next leaf with: the leaf which holds key,
+ * pinned and read latched, and the position of key in it.
+ */
+template <typename KeyManagerType>
+IndexIterator::FindLeafFn BasicBPlusTree<KeyManagerType>::LeafFinder() {
+  return [this](const GenericKey *key, int *index) {
+    Page *page = FindLeafPageRead(key, LeafTarget::kKey);
+    if (page != nullptr) {
+      *index = reinterpret_cast<LeafPage *>(page->GetData())->KeyIndex(key, processor_);
+    }
+    return page;
+  };
 }
 
 /*****************************************************************************
@@ -645,35 +552,177 @@ IndexIterator BPlusTree::End() {
  * the left most leaf page
  * Note: the leaf page is pinned, you need to unpin it after use.
  */
-Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool leftMost) {
-  if (page_id == INVALID_PAGE_ID) {
-    page_id = root_page_id_;
+template <typename KeyManagerType>
+Page *BasicBPlusTree<KeyManagerType>::FindLeafPage(const GenericKey *key, bool leftMost) {
+  Page *page = FindLeafPageRead(key, leftMost ? LeafTarget::kLeftMost : LeafTarget::kKey);
+  if (page != nullptr) {
+    page->RUnlatch();
   }
+  return page;
+}
+
+/*
+ * Lehman-Yao descent: hold one read latch at a time, and move right to the
+ * sibling while the key is not below the high key of the page, i.e. a split
+ * moved it after the pointer to the page was read. The leaf is returned
+ * pinned and read latched, nullptr if the tree is empty.
+ */
+template <typename KeyManagerType>
+Page *BasicBPlusTree<KeyManagerType>::FindLeafPageRead(const GenericKey *key, LeafTarget target) {
+  smo_latch_.RLock();
+  page_id_t page_id = root_page_id_;
   if (page_id == INVALID_PAGE_ID) {
+    smo_latch_.RUnlock();
     return nullptr;
   }
-
   Page *page = buffer_pool_manager_->FetchPage(page_id);
-  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  page->RLatch();
+
+  while (true) {
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    page_id_t next_page_id = NextPageIdOf(node);
+    if (next_page_id != INVALID_PAGE_ID &&
+        (target == LeafTarget::kRightMost ||
+         (target == LeafTarget::kKey && processor_.CompareKeys(key, node->GetHighKey()) >= 0))) {
+      page_id = next_page_id;
+    } else if (node->IsLeafPage()) {
+      break;
+    } else {
+      auto *internal = reinterpret_cast<InternalPage *>(node);
+      if (target == LeafTarget::kLeftMost) {
+        page_id = internal->ValueAt(0);
+      } else if (target == LeafTarget::kRightMost) {
+        page_id = internal->ValueAt(internal->GetSize() - 1);
+      } else {
+        page_id = internal->Lookup(key, processor_);
+      }
+    }
+    // 先 pin 住下一页再放开当前页的latch，不持有两个latch
+    Page *next = buffer_pool_manager_->FetchPage(page_id);
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    next->RLatch();
+    page = next;
+  }
+  // 叶子已加latch，之后的合并要等这个latch
+  smo_latch_.RUnlock();
+  return page;
+}
 
-  // 递归查找直到叶子节点
-  while (!node->IsLeafPage()) {
-    auto *internal = reinterpret_cast<InternalPage *>(node);
-    page_id_t child_page_id;
+/*
+ * Optimistic descent for Insert and Remove: crab down with read latches like
+ * FindLeafPageRead but write latch the leaf. The leaf is returned pinned and
+ * write latched, is_root tells whether it is the root.
+ */
+template <typename KeyManagerType>
+Page *BasicBPlusTree<KeyManagerType>::FindLeafPageOptimistic(const GenericKey *key, bool &is_root) {
+  root_latch_.RLock();
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  // 页类型在页的生命周期内不变，持有父节点（或根）的latch时页不会被删除，可以在加latch前读取
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  bool is_leaf = reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage();
+  is_leaf ? page->WLatch() : page->RLatch();
+  root_latch_.RUnlock();
+  is_root = true;
+
+  while (!is_leaf) {
+    page_id_t child_page_id = reinterpret_cast<InternalPage *>(page->GetData())->Lookup(key, processor_);
+    Page *child = buffer_pool_manager_->FetchPage(child_page_id);
+    is_leaf = reinterpret_cast<BPlusTreePage *>(child->GetData())->IsLeafPage();
+    is_leaf ? child->WLatch() : child->RLatch();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child;
+    is_root = false;
+  }
+  return page;
+}
 
-    if (leftMost) {
-      child_page_id = internal->ValueAt(0);
-    } else {
-      child_page_id = internal->Lookup(key, processor_);
+/*
+ * Pessimistic descent for Insert and Remove: write latch every page on the
+ * path, starting with root_latch_, and release the ancestors whenever a page
+ * is safe for op. Returns the leaf, nullptr if the tree is empty (with
+ * root_latch_ still held).
+ */
+template <typename KeyManagerType>
+Page *BasicBPlusTree<KeyManagerType>::FindLeafPageWrite(const GenericKey *key, Operation op, WriteSet &write_set) {
+  root_latch_.WLock();
+  write_set.root_latched = true;
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  page_id_t page_id = root_page_id_;
+  bool is_root = true;
+  while (true) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    page->WLatch();
+    write_set.pages.push_back(page);
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (IsSafe(node, op, is_root)) {
+      ReleaseAncestors(write_set);
     }
+    if (node->IsLeafPage()) {
+      return page;
+    }
+    page_id = reinterpret_cast<InternalPage *>(node)->Lookup(key, processor_);
+    is_root = false;
+  }
+}
 
-    buffer_pool_manager_->UnpinPage(page_id, false);
-    page_id = child_page_id;
-    page = buffer_pool_manager_->FetchPage(page_id);
-    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+/*
+ * A page is safe for op if applying op below it cannot change it structurally:
+ * an insert will not split it, a remove will not make it underflow.
+ */
+template <typename KeyManagerType>
+bool BasicBPlusTree<KeyManagerType>::IsSafe(BPlusTreePage *node, Operation op, bool is_root) const {
+  if (op == Operation::kInsert) {
+    return node->GetSize() < node->GetMaxSize() - 1;
+  }
+  // 根节点只在变空（叶子）或只剩一个孩子（内部节点）时调整
+  if (is_root) {
+    return node->GetSize() > (node->IsLeafPage() ? 1 : 2);
   }
+  return node->GetSize() > node->GetMinSize();
+}
 
-  return page;
+/*
+ * Release root_latch_ and every page of write_set except the last one.
+ */
+template <typename KeyManagerType>
+void BasicBPlusTree<KeyManagerType>::ReleaseAncestors(WriteSet &write_set) {
+  if (write_set.root_latched) {
+    root_latch_.WUnlock();
+    write_set.root_latched = false;
+  }
+  for (size_t i = 0; i + 1 < write_set.pages.size(); i++) {
+    write_set.pages[i]->WUnlatch();
+    buffer_pool_manager_->UnpinPage(write_set.pages[i]->GetPageId(), false);
+  }
+  write_set.pages.erase(write_set.pages.begin(), write_set.pages.end() - 1);
+}
+
+/*
+ * Release every latch of write_set, then delete the pages it freed.
+ */
+template <typename KeyManagerType>
+void BasicBPlusTree<KeyManagerType>::ReleaseWriteSet(WriteSet &write_set) {
+  for (Page *page : write_set.pages) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  }
+  write_set.pages.clear();
+  if (write_set.root_latched) {
+    root_latch_.WUnlock();
+    write_set.root_latched = false;
+  }
+  // 被删除的页已从树中摘除，其他线程无法再到达
+  for (page_id_t page_id : write_set.deleted) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  write_set.deleted.clear();
 }
 
 /*
@@ -684,15 +733,18 @@ Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool lef
  * insert a record <index_name, current_page_id> into header page instead of
  * updating it.
  */
-void BPlusTree::UpdateRootPageId(int insert_record) {
+template <typename KeyManagerType>
+void BasicBPlusTree<KeyManagerType>::UpdateRootPageId(int insert_record) {
   Page *page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
   auto *root_page = reinterpret_cast<IndexRootsPage *>(page->GetData());
 
-  if (insert_record) {
-    root_page->Insert(index_id_, root_page_id_);
-  } else {
+  // 所有索引共用这一页
+  page->WLatch();
+  // 树被删空后记录仍在，重新建树时更新它
+  if (!insert_record || !root_page->Insert(index_id_, root_page_id_)) {
     root_page->Update(index_id_, root_page_id_);
   }
+  page->WUnlatch();
 
   buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
 }
@@ -700,7 +752,9 @@ void BPlusTree::UpdateRootPageId(int insert_record) {
 /**
  * This method is used for debug only, You don't need to modify
  */
-void BPlusTree::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out, Schema *schema) const {
+template <typename KeyManagerType>
+void BasicBPlusTree<KeyManagerType>::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out,
+                                             Schema *schema) const {
   std::string leaf_prefix("LEAF_");
   std::string internal_prefix("INT_");
   if (page->IsLeafPage()) {
@@ -791,7 +845,8 @@ void BPlusTree::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstre
 /**
  * This function is for debug only, you don't need to modify
  */
-void BPlusTree::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const {
+template <typename KeyManagerType>
+void BasicBPlusTree<KeyManagerType>::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const {
   if (page->IsLeafPage()) {
     auto *leaf = reinterpret_cast<LeafPage *>(page);
     std::cout << "Leaf Page: " << leaf->GetPageId() << " parent: " << leaf->GetParentPageId()
@@ -816,10 +871,15 @@ void BPlusTree::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const {
   }
 }
 
-bool BPlusTree::Check() {
+template <typename KeyManagerType>
+bool BasicBPlusTree<KeyManagerType>::Check() {
   bool all_unpinned = buffer_pool_manager_->CheckAllUnpinned();
   if (!all_unpinned) {
     LOG(ERROR) << "problem in page unpin" << endl;
   }
   return all_unpinned;
-}
\ No newline at end of file
+}
+
+template class BasicBPlusTree<KeyManager>;
+
+template class BasicBPlusTree<FixedKeyManager>;
@@ -2,13 +2,16 @@
 
 #include "index/generic_key.h"
 #include "utils/tree_file_mgr.h"
-BPlusTreeIndex::BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
-                               BufferPoolManager *buffer_pool_manager)
+
+template <typename KeyManagerType>
+BasicBPlusTreeIndex<KeyManagerType>::BasicBPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema,
+                                                         size_t key_size, BufferPoolManager *buffer_pool_manager)
     : Index(index_id, key_schema),
       processor_(key_schema_, key_size),
       container_(index_id, buffer_pool_manager, processor_) {}
 
-dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Txn *txn) {
+template <typename KeyManagerType>
+dberr_t BasicBPlusTreeIndex<KeyManagerType>::InsertEntry(const Row &key, RowId row_id, Txn *txn) {
   // ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
   GenericKey *index_key = processor_.InitKey();
   processor_.SerializeFromKey(index_key, key, key_schema_);
@@ -26,7 +29,8 @@ dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Txn *txn) {
   return DB_SUCCESS;
 }
 
-dberr_t BPlusTreeIndex::RemoveEntry(const Row &key, RowId row_id, Txn *txn) {
+template <typename KeyManagerType>
+dberr_t BasicBPlusTreeIndex<KeyManagerType>::RemoveEntry(const Row &key, RowId row_id, Txn *txn) {
   GenericKey *index_key = processor_.InitKey();
   processor_.SerializeFromKey(index_key, key, key_schema_);
 
@@ -35,7 +39,8 @@ dberr_t BPlusTreeIndex::RemoveEntry(const Row &key, RowId row_id, Txn *txn) {
   return DB_SUCCESS;
 }
 
-dberr_t BPlusTreeIndex::ScanKey(const Row &key, vector<RowId> &result, Txn *txn, string compare_operator) {
+template <typename KeyManagerType>
+dberr_t BasicBPlusTreeIndex<KeyManagerType>::ScanKey(const Row &key, vector<RowId> &result, Txn *txn, string compare_operator) {
   GenericKey *index_key = processor_.InitKey();
   processor_.SerializeFromKey(index_key, key, key_schema_);
   auto end_iter = GetEndIterator();
@@ -78,19 +83,27 @@ dberr_t BPlusTreeIndex::ScanKey(const Row &key, vector<RowId> &result, Txn *txn,
     return DB_KEY_NOT_FOUND;
 }
 
-dberr_t BPlusTreeIndex::Destroy() {
+template <typename KeyManagerType>
+dberr_t BasicBPlusTreeIndex<KeyManagerType>::Destroy() {
   container_.Destroy();
   return DB_SUCCESS;
 }
 
-IndexIterator BPlusTreeIndex::GetBeginIterator() {
+template <typename KeyManagerType>
+IndexIterator BasicBPlusTreeIndex<KeyManagerType>::GetBeginIterator() {
   return container_.Begin();
 }
 
-IndexIterator BPlusTreeIndex::GetBeginIterator(GenericKey *key) {
+template <typename KeyManagerType>
+IndexIterator BasicBPlusTreeIndex<KeyManagerType>::GetBeginIterator(GenericKey *key) {
   return container_.Begin(key);
 }
 
-IndexIterator BPlusTreeIndex::GetEndIterator() {
+template <typename KeyManagerType>
+IndexIterator BasicBPlusTreeIndex<KeyManagerType>::GetEndIterator() {
   return container_.End();
-}
\ No newline at end of file
+}
+
+template class BasicBPlusTreeIndex<KeyManager>;
+
+template class BasicBPlusTreeIndex<FixedKeyManager>;
@@ -1,56 +1,90 @@
 #include "index/index_iterator.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "index/basic_comparator.h"
 #include "index/generic_key.h"
 
+static page_id_t NextLeafPageId(Page *page) {
+  return reinterpret_cast<BPlusTreeLeafPage *>(page->GetData())->GetNextPageId();
+}
+
 IndexIterator::IndexIterator() = default;
 
-IndexIterator::IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int index)
-    : current_page_id(page_id), item_index(index), buffer_pool_manager(bpm) {
-  page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(current_page_id)->GetData());
+IndexIterator::IndexIterator(BufferPoolManager *bpm, FindLeafFn find_leaf, Page *leaf, int index)
+    : buffer_pool_manager(bpm), find_leaf_(std::move(find_leaf)), read_ahead_(bpm, NextLeafPageId) {
+  Load(leaf, index);
+  // 起始位置在叶子末尾时从后面的叶子开始，和 operator++ 走出叶子时一致
+  MoveRight();
 }
 
-IndexIterator::~IndexIterator() {
-  if (current_page_id != INVALID_PAGE_ID)
-    buffer_pool_manager->UnpinPage(current_page_id, false);
+void IndexIterator::Load(Page *leaf, int index) {
+  auto *page = reinterpret_cast<LeafPage *>(leaf->GetData());
+  current_page_id = leaf->GetPageId();
+  key_size_ = page->GetKeySize();
+  first_index_ = item_index = index;
+  int size = std::max(page->GetSize() - index, 0);
+  keys_.resize(static_cast<size_t>(size) * key_size_);
+  values_.resize(size);
+  for (int i = 0; i < size; i++) {
+    memcpy(keys_.data() + static_cast<size_t>(i) * key_size_, page->KeyAt(index + i), key_size_);
+    values_[i] = page->ValueAt(index + i);
+  }
+  high_key_.clear();
+  if (page->GetNextPageId() != INVALID_PAGE_ID) {
+    auto high_key = reinterpret_cast<char *>(page->GetHighKey());
+    high_key_.assign(high_key, high_key + key_size_);
+  }
+  leaf->RUnlatch();
+  read_ahead_.Advance(current_page_id);
+  buffer_pool_manager->UnpinPage(current_page_id, false);
 }
 
 /**
  * TODO: Student Implement
  */
 std::pair<GenericKey *, RowId> IndexIterator::operator*() {
-  return page->GetItem(item_index);
+  int i = item_index - first_index_;
+  return {reinterpret_cast<GenericKey *>(keys_.data() + static_cast<size_t>(i) * key_size_), values_[i]};
 }
 
 /**
  * TODO: Student Implement
  */
 IndexIterator &IndexIterator::operator++() {
-  if (current_page_id == INVALID_PAGE_ID || page == nullptr) {
+  if (IsEnd()) {
     return *this;
   }
-  // 如果对不上就移动到当前页的下一个元素
-  if (item_index != page->GetSize()) {
-    item_index++;
-  } else {
-    page_id_t next_page_id = page->GetNextPageId();
-
-    // 释放当前页
-    buffer_pool_manager->UnpinPage(current_page_id, false);
-    // 获取下一页
-    current_page_id = next_page_id;
-    Page *next_page = buffer_pool_manager->FetchPage(current_page_id);
-    page = reinterpret_cast<LeafPage *>(next_page->GetData());
-    item_index = 0;
-  }
-
+  // 移动到当前叶子的下一个元素，走出叶子时转到下一个叶子；最后一个叶子停在末尾，即End()
+  item_index++;
+  MoveRight();
   return *this;
 }
 
+void IndexIterator::MoveRight() {
+  while (item_index == first_index_ + static_cast<int>(values_.size()) && !high_key_.empty()) {
+    // 当前叶子可能已被合并释放，高键之后的键总能从根找到
+    int index = 0;
+    Page *leaf = find_leaf_(reinterpret_cast<GenericKey *>(high_key_.data()), &index);
+    if (leaf == nullptr) {
+      // 树已被删空
+      values_.clear();
+      high_key_.clear();
+      first_index_ = item_index = 0;
+      return;
+    }
+    Load(leaf, index);
+  }
+}
+
 bool IndexIterator::operator==(const IndexIterator &itr) const {
+  if (IsEnd() || itr.IsEnd()) {
+    return IsEnd() && itr.IsEnd();
+  }
   return current_page_id == itr.current_page_id && item_index == itr.item_index;
 }
 
 bool IndexIterator::operator!=(const IndexIterator &itr) const {
   return !(*this == itr);
-}
\ No newline at end of file
+}
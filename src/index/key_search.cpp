@@ -0,0 +1,56 @@
+#include "index/key_search.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+int KeySearch::CountLessScalar(const char *keys, int stride, int count, uint64_t word, bool or_equal) {
+  // 比较结果直接累加，循环中没有分支
+  int less = 0;
+  for (int i = 0; i < count; i++) {
+    uint64_t key_word = ReadWord(keys + i * stride);
+    less += or_equal ? key_word <= word : key_word < word;
+  }
+  return less;
+}
+
+#if defined(__x86_64__)
+
+__attribute__((target("avx2"))) static int CountLessAvx2(const char *keys, int stride, int count, uint64_t word,
+                                                         bool or_equal) {
+  // 每次从四个键中各取8字节，字节序反转后按无符号数比较
+  const __m256i offsets = _mm256_set_epi64x(3LL * stride, 2LL * stride, stride, 0);
+  const __m256i reverse = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1,
+                                           0, 15, 14, 13, 12, 11, 10, 9, 8);
+  const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+  // key < word 即 word > key，key <= word 即 word + 1 > key（word 为最大值时所有键都满足）
+  if (or_equal && word == UINT64_MAX) {
+    return count;
+  }
+  const __m256i target = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(word + (or_equal ? 1 : 0))), sign);
+  int less = 0;
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m256i words = _mm256_i64gather_epi64(reinterpret_cast<const long long *>(keys + i * stride), offsets, 1);
+    words = _mm256_xor_si256(_mm256_shuffle_epi8(words, reverse), sign);
+    int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(target, words)));
+    less += __builtin_popcount(mask);
+  }
+  return less + KeySearch::CountLessScalar(keys + i * stride, stride, count - i, word, or_equal);
+}
+
+int KeySearch::CountLess(const char *keys, int stride, int count, uint64_t word, bool or_equal) {
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+  if (has_avx2) {
+    return CountLessAvx2(keys, stride, count, word, or_equal);
+  }
+  return CountLessScalar(keys, stride, count, word, or_equal);
+}
+
+#else
+
+int KeySearch::CountLess(const char *keys, int stride, int count, uint64_t word, bool or_equal) {
+  return CountLessScalar(keys, stride, count, word, or_equal);
+}
+
+#endif
@@ -25,6 +25,18 @@ void InternalPage::Init(page_id_t page_id, page_id_t parent_id, int key_size, in
   SetParentPageId(parent_id);
   SetKeySize(key_size);
   SetMaxSize(max_size);
+  SetNextPageId(INVALID_PAGE_ID);
+}
+
+/*
+ * Helper methods to get/set the right sibling
+ */
+page_id_t InternalPage::GetNextPageId() const {
+  return next_page_id_;
+}
+
+void InternalPage::SetNextPageId(page_id_t next_page_id) {
+  next_page_id_ = next_page_id;
 }
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
@@ -70,20 +82,16 @@ void InternalPage::PairCopy(void *dest, void *src, int pair_num) {
  * Start the search from the second key(the first key should always be invalid)
  * 用了二分查找
  */
-page_id_t InternalPage::Lookup(const GenericKey *key, const KeyManager &KM) {
-  int left_index = 1;
-  int right_index = GetSize() - 1;
-  while (left_index <= right_index) {
-    int mid_index = (left_index + right_index) / 2;
-    if (KM.CompareKeys(KeyAt(mid_index), key) <= 0) {
-      left_index = mid_index + 1;
-    } else if (KM.CompareKeys(KeyAt(mid_index), key) > 0) {
-      right_index = mid_index - 1;
-    }
-  }
-  return ValueAt(left_index - 1);
+template <typename KeyManagerType>
+page_id_t InternalPage::Lookup(const GenericKey *key, const KeyManagerType &KM) {
+  // 找到第一个 > key 的键，它左边的指针指向的子树包含 key
+  int index = KM.SearchKeys(pairs_off + key_off, pair_size, 1, GetSize(), key, true);
+  return ValueAt(index - 1);
 }
 
+template page_id_t InternalPage::Lookup<KeyManager>(const GenericKey *key, const KeyManager &KM);
+template page_id_t InternalPage::Lookup<FixedKeyManager>(const GenericKey *key, const FixedKeyManager &KM);
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -127,6 +135,11 @@ void InternalPage::MoveHalfTo(InternalPage *recipient, BufferPoolManager *buffer
   int size = GetSize();
   recipient->CopyNFrom(PairPtrAt(size - size / 2), size / 2, buffer_pool_manager);
   IncreaseSize(-(size / 2));
+  // 新页接在右边，继承原来的高键；原页的高键变为新页的分隔键
+  recipient->SetNextPageId(GetNextPageId());
+  recipient->SetHighKey(GetHighKey());
+  SetNextPageId(recipient->GetPageId());
+  SetHighKey(recipient->KeyAt(0));
 }
 
 /* Copy entries into me, starting from {items} and copy {size} entries.
@@ -154,9 +167,7 @@ void InternalPage::CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool
  * NOTE: store key&value pair continuously after deletion
  */
 void InternalPage::Remove(int index) {
-  for (int i = index; i < GetSize(); i++) {
-    PairCopy(PairPtrAt(i), PairPtrAt(i + 1), 1);
-  }
+  PairCopy(PairPtrAt(index), PairPtrAt(index + 1), GetSize() - index - 1);
   IncreaseSize(-1);
 }
 
@@ -182,6 +193,8 @@ page_id_t InternalPage::RemoveAndReturnOnlyChild() {
 void InternalPage::MoveAllTo(InternalPage *recipient, GenericKey *middle_key, BufferPoolManager *buffer_pool_manager) {
   recipient->CopyLastFrom(middle_key, ValueAt(0), buffer_pool_manager);
   recipient->CopyNFrom(PairPtrAt(1), GetSize() - 1, buffer_pool_manager);
+  recipient->SetNextPageId(GetNextPageId());
+  recipient->SetHighKey(GetHighKey());
   SetSize(0);
 }
 
@@ -226,7 +239,9 @@ void InternalPage::CopyLastFrom(GenericKey *key, const page_id_t value, BufferPo
 void InternalPage::MoveLastToFrontOf(InternalPage *recipient, GenericKey *middle_key,
                                      BufferPoolManager *buffer_pool_manager) {
   recipient->CopyFirstFrom(ValueAt(GetSize() - 1), buffer_pool_manager);
-  recipient->SetKeyAt(0, middle_key);
+  // 原来的第一个指针右移到 1，middle_key 成为它的键；移过去的键留在 KeyAt(0)，作为父节点的新分隔键
+  recipient->SetKeyAt(1, middle_key);
+  recipient->SetKeyAt(0, KeyAt(GetSize() - 1));
   IncreaseSize(-1);
 }
 
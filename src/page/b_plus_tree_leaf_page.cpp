@@ -53,19 +53,10 @@ void LeafPage::SetNextPageId(page_id_t next_page_id) {
  * NOTE: This method is only used when generating index iterator
  * 二分查找
  */
-int LeafPage::KeyIndex(const GenericKey *key, const KeyManager &KM) {
-  // 二分查找第一个 >= key 的位置
-  int left = 0, right = GetSize() - 1;
-  while (left <= right) {
-    int mid = left + (right - left) / 2;
-    GenericKey *mid_key = KeyAt(mid);
-    if (KM.CompareKeys(mid_key, key) < 0) {
-      left = mid + 1;
-    } else {
-      right = mid - 1;
-    }
-  }
-  return left; // 返回插入位置
+template <typename KeyManagerType>
+int LeafPage::KeyIndex(const GenericKey *key, const KeyManagerType &KM) {
+  // 二分查找第一个 >= key 的位置，定长键的查找见 FixedKeyManager::SearchKeys
+  return KM.SearchKeys(pairs_off + key_off, pair_size, 0, GetSize(), key, false);
 }
 
 /*
@@ -108,7 +99,8 @@ std::pair<GenericKey *, RowId> LeafPage::GetItem(int index) { return {KeyAt(inde
  * Insert key & value pair into leaf page ordered by key
  * @return page size after insertion
  */
-int LeafPage::Insert(GenericKey *key, const RowId &value, const KeyManager &KM) {
+template <typename KeyManagerType>
+int LeafPage::Insert(GenericKey *key, const RowId &value, const KeyManagerType &KM) {
   int index = KeyIndex(key, KM); // 找到插入位置
   if (index < GetSize() && KM.CompareKeys(KeyAt(index), key) == 0) {
     return GetSize(); // 键已存在，直接返回当前大小
@@ -132,9 +124,11 @@ void LeafPage::MoveHalfTo(LeafPage *recipient) {
   int split_index = GetMinSize(); // 分裂点
   recipient->CopyNFrom(PairPtrAt(split_index), GetSize() - split_index);
   SetSize(split_index); // 更新当前页大小
-  // 更新链表指针
+  // 更新链表指针，新页继承原来的高键，原页的高键变为新页的第一个键
   recipient->SetNextPageId(GetNextPageId());
+  recipient->SetHighKey(GetHighKey());
   SetNextPageId(recipient->GetPageId());
+  SetHighKey(recipient->KeyAt(0));
 }
 
 /*
@@ -154,7 +148,8 @@ void LeafPage::CopyNFrom(void *src, int size) {
  * does, then store its corresponding value in input "value" and return true.
  * If the key does not exist, then return false
  */
-bool LeafPage::Lookup(const GenericKey *key, RowId &value, const KeyManager &KM) {
+template <typename KeyManagerType>
+bool LeafPage::Lookup(const GenericKey *key, RowId &value, const KeyManagerType &KM) {
   int index = KeyIndex(key, KM);
   if (index < GetSize() && KM.CompareKeys(KeyAt(index), key) == 0) {
     value = ValueAt(index); // 返回对应的RowId
@@ -172,7 +167,8 @@ bool LeafPage::Lookup(const GenericKey *key, RowId &value, const KeyManager &KM)
  * NOTE: store key&value pair continuously after deletion
  * @return  page size after deletion
  */
-int LeafPage::RemoveAndDeleteRecord(const GenericKey *key, const KeyManager &KM) {
+template <typename KeyManagerType>
+int LeafPage::RemoveAndDeleteRecord(const GenericKey *key, const KeyManagerType &KM) {
   int index = KeyIndex(key, KM);
   if (index >= GetSize() || KM.CompareKeys(KeyAt(index), key) != 0) {
     return GetSize(); // 键不存在，直接返回当前大小
@@ -193,6 +189,7 @@ int LeafPage::RemoveAndDeleteRecord(const GenericKey *key, const KeyManager &KM)
 void LeafPage::MoveAllTo(LeafPage *recipient) {
   recipient->CopyNFrom(PairPtrAt(0), GetSize());
   recipient->SetNextPageId(GetNextPageId()); // 维护链表指针
+  recipient->SetHighKey(GetHighKey());
   SetSize(0); // 清空当前页
 }
 
@@ -250,4 +247,13 @@ void LeafPage::CopyFirstFrom(GenericKey *key, const RowId value) {
   SetKeyAt(0, key);
   SetValueAt(0, value);
   IncreaseSize(1);
-}
\ No newline at end of file
+}
+
+template int LeafPage::KeyIndex<KeyManager>(const GenericKey *key, const KeyManager &KM);
+template int LeafPage::KeyIndex<FixedKeyManager>(const GenericKey *key, const FixedKeyManager &KM);
+template int LeafPage::Insert<KeyManager>(GenericKey *key, const RowId &value, const KeyManager &KM);
+template int LeafPage::Insert<FixedKeyManager>(GenericKey *key, const RowId &value, const FixedKeyManager &KM);
+template bool LeafPage::Lookup<KeyManager>(const GenericKey *key, RowId &value, const KeyManager &KM);
+template bool LeafPage::Lookup<FixedKeyManager>(const GenericKey *key, RowId &value, const FixedKeyManager &KM);
+template int LeafPage::RemoveAndDeleteRecord<KeyManager>(const GenericKey *key, const KeyManager &KM);
+template int LeafPage::RemoveAndDeleteRecord<FixedKeyManager>(const GenericKey *key, const FixedKeyManager &KM);
@@ -107,4 +107,15 @@ void BPlusTreePage::SetPageId(page_id_t page_id) {
  */
 void BPlusTreePage::SetLSN(lsn_t lsn) {
   lsn_ = lsn;
+}
+
+/*
+ * Helper methods to get/set the high key stored at the end of the page
+ */
+GenericKey *BPlusTreePage::GetHighKey() {
+  return reinterpret_cast<GenericKey *>(reinterpret_cast<char *>(this) + PAGE_SIZE - key_size_);
+}
+
+void BPlusTreePage::SetHighKey(const GenericKey *key) {
+  memcpy(GetHighKey(), key, key_size_);
 }
\ No newline at end of file
@@ -0,0 +1,11 @@
+#include "page/free_space_map_page.h"
+
+bool FreeSpaceMapPage::Append(page_id_t heap_page_id, uint8_t category) {
+  if (count_ >= MAX_ENTRIES) {
+    return false;
+  }
+  heap_page_ids_[count_] = heap_page_id;
+  SetCategory(count_, category);
+  count_++;
+  return true;
+}
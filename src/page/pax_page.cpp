@@ -0,0 +1,262 @@
+#include "page/pax_page.h"
+
+#include <algorithm>
+
+uint32_t PaxPage::GetColumnWidth(const Column *column) {
+  if (column->GetType() == TypeId::kTypeChar) {
+    // 长度加上声明的最大长度，放不下溢出指针时按溢出指针的大小
+    return sizeof(uint32_t) + std::max<uint32_t>(column->GetLength(), sizeof(page_id_t));
+  }
+  return Type::GetTypeSize(column->GetType());
+}
+
+uint32_t PaxPage::GetCapacity(const Schema *schema) {
+  uint32_t slot_width = 0;
+  for (auto column : schema->GetColumns()) {
+    slot_width += GetColumnWidth(column);
+  }
+  // 每个槽还要一个字节的状态，状态数组最多补齐3个字节
+  return (PAGE_SIZE - OFFSET_SLOT_STATES - 3) / (slot_width + 1);
+}
+
+bool PaxPage::CanHold(const Row &row, const Schema *schema) {
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    if (row.GetField(i)->GetSerializedSize() > GetColumnWidth(schema->GetColumn(i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void PaxPage::Init(page_id_t page_id, page_id_t prev_id, const Schema *schema, LogManager *log_mgr, Txn *txn) {
+  TablePage::Init(page_id, prev_id, log_mgr, txn);
+  SetLayout(TableLayout::kPax);
+  uint32_t capacity = GetCapacity(schema);
+  uint32_t slot_width = 0;
+  for (auto column : schema->GetColumns()) {
+    slot_width += GetColumnWidth(column);
+  }
+  memcpy(GetData() + OFFSET_PAX_CAPACITY, &capacity, sizeof(uint32_t));
+  memcpy(GetData() + OFFSET_PAX_SLOT_WIDTH, &slot_width, sizeof(uint32_t));
+  memset(GetData() + OFFSET_SLOT_STATES, kSlotEmpty, capacity);
+}
+
+void PaxPage::GetMinipages(const Schema *schema, std::vector<uint32_t> *offsets, std::vector<uint32_t> *widths) {
+  uint32_t capacity = GetPaxCapacity();
+  uint32_t offset = GetMinipagesOffset(capacity);
+  offsets->clear();
+  widths->clear();
+  for (auto column : schema->GetColumns()) {
+    uint32_t width = GetColumnWidth(column);
+    offsets->push_back(offset);
+    widths->push_back(width);
+    offset += capacity * width;
+  }
+}
+
+void PaxPage::GetColumnOffsets(uint32_t slot, const std::vector<uint32_t> &minipages,
+                               const std::vector<uint32_t> &widths, std::vector<uint32_t> *offsets) {
+  offsets->resize(minipages.size());
+  for (size_t i = 0; i < minipages.size(); i++) {
+    (*offsets)[i] = minipages[i] + slot * widths[i];
+  }
+}
+
+void PaxPage::ReadTuple(uint32_t slot, const Schema *schema, Row *row) {
+  std::vector<uint32_t> minipages, widths, offsets;
+  GetMinipages(schema, &minipages, &widths);
+  GetColumnOffsets(slot, minipages, widths, &offsets);
+  row->DeserializeFrom(GetData(), offsets.data(), schema);
+}
+
+void PaxPage::WriteTuple(uint32_t slot, const Schema *schema, const Row &row) {
+  uint32_t capacity = GetPaxCapacity();
+  uint32_t offset = GetMinipagesOffset(capacity);
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    uint32_t width = GetColumnWidth(schema->GetColumn(i));
+    row.GetField(i)->SerializeTo(GetData() + offset + slot * width);
+    offset += capacity * width;
+  }
+}
+
+bool PaxPage::InsertTuple(Row &row, Schema *schema, Txn *, LockManager *, LogManager *) {
+  if (GetTupleCount() == GetPaxCapacity() || !CanHold(row, schema)) {
+    return false;
+  }
+  // 提示之前的槽都已占用，从提示处找第一个空槽
+  uint32_t slot = GetFreeSlotHint();
+  while (GetSlotState(slot) != kSlotEmpty) {
+    slot++;
+  }
+  WriteTuple(slot, schema, row);
+  SetSlotState(slot, kSlotLive);
+  SetTupleCount(GetTupleCount() + 1);
+  SetFreeSlotHint(slot + 1);
+  BumpModCount();
+  row.SetRowId(RowId(GetTablePageId(), slot));
+  return true;
+}
+
+bool PaxPage::MarkDelete(const RowId &rid, Txn *, LockManager *, LogManager *) {
+  uint32_t slot = rid.GetSlotNum();
+  if (slot >= GetPaxCapacity() || GetSlotState(slot) != kSlotLive) {
+    return false;
+  }
+  SetSlotState(slot, kSlotDeleted);
+  BumpModCount();
+  return true;
+}
+
+bool PaxPage::UpdateTuple(Row &new_row, Row *old_row, Schema *schema, Txn *, LockManager *, LogManager *) {
+  ASSERT(old_row != nullptr && old_row->GetRowId().Get() != INVALID_ROWID.Get(), "invalid old row.");
+  uint32_t slot = old_row->GetRowId().GetSlotNum();
+  if (slot >= GetPaxCapacity() || GetSlotState(slot) != kSlotLive || !CanHold(new_row, schema)) {
+    return false;
+  }
+  // 每个值都有固定的位置，直接原地覆盖
+  ReadTuple(slot, schema, old_row);
+  WriteTuple(slot, schema, new_row);
+  BumpModCount();
+  return true;
+}
+
+void PaxPage::ApplyDelete(const RowId &rid, Txn *, LogManager *) {
+  uint32_t slot = rid.GetSlotNum();
+  ASSERT(slot < GetPaxCapacity() && GetSlotState(slot) != kSlotEmpty, "Applying delete to an empty slot.");
+  SetSlotState(slot, kSlotEmpty);
+  SetTupleCount(GetTupleCount() - 1);
+  SetFreeSlotHint(std::min(GetFreeSlotHint(), slot));
+  BumpModCount();
+}
+
+void PaxPage::RollbackDelete(const RowId &rid, Txn *, LogManager *) {
+  uint32_t slot = rid.GetSlotNum();
+  ASSERT(slot < GetPaxCapacity(), "We can't have more slots than tuples.");
+  if (GetSlotState(slot) == kSlotDeleted) {
+    SetSlotState(slot, kSlotLive);
+  }
+  BumpModCount();
+}
+
+bool PaxPage::GetTuple(Row *row, Schema *schema, Txn *, LockManager *) {
+  ASSERT(row != nullptr && row->GetRowId().Get() != INVALID_ROWID.Get(), "Invalid row.");
+  uint32_t slot = row->GetRowId().GetSlotNum();
+  if (slot >= GetPaxCapacity() || GetSlotState(slot) != kSlotLive) {
+    return false;
+  }
+  ReadTuple(slot, schema, row);
+  return true;
+}
+
+bool PaxPage::GetTupleView(const RowId &rid, const Schema *schema, RowView *view,
+                           const OverflowStore *overflow_store, bool include_deleted) {
+  uint32_t slot = rid.GetSlotNum();
+  if (slot >= GetPaxCapacity()) {
+    return false;
+  }
+  SlotState state = GetSlotState(slot);
+  if (state == kSlotEmpty || (state == kSlotDeleted && !include_deleted)) {
+    return false;
+  }
+  std::vector<uint32_t> minipages, widths, offsets;
+  GetMinipages(schema, &minipages, &widths);
+  GetColumnOffsets(slot, minipages, widths, &offsets);
+  view->Reset(GetData(), schema, rid, offsets.data(), overflow_store);
+  return true;
+}
+
+uint32_t PaxPage::GetTupleViews(const Schema *schema, uint32_t begin_slot, std::vector<RowView> *views,
+                                const OverflowStore *overflow_store) {
+  uint32_t count = 0;
+  uint32_t capacity = GetPaxCapacity();
+  uint32_t remaining = GetTupleCount();
+  // 槽号之前的元组也计入TupleCount，只有从头开始时才能提前结束
+  bool count_remaining = begin_slot == 0;
+  std::vector<uint32_t> minipages, widths, offsets;
+  GetMinipages(schema, &minipages, &widths);
+  for (uint32_t i = begin_slot; i < capacity && (!count_remaining || remaining > 0); i++) {
+    SlotState state = GetSlotState(i);
+    if (state == kSlotEmpty) {
+      continue;
+    }
+    remaining--;
+    if (state == kSlotDeleted) {
+      continue;
+    }
+    if (count == views->size()) {
+      views->emplace_back();
+    }
+    GetColumnOffsets(i, minipages, widths, &offsets);
+    (*views)[count++].Reset(GetData(), schema, RowId(GetTablePageId(), i), offsets.data(), overflow_store);
+  }
+  return count;
+}
+
+uint32_t PaxPage::GetDeletedTupleViews(const Schema *schema, std::vector<RowView> *views) {
+  uint32_t count = 0;
+  std::vector<uint32_t> minipages, widths, offsets;
+  GetMinipages(schema, &minipages, &widths);
+  for (uint32_t i = 0; i < GetPaxCapacity(); i++) {
+    if (GetSlotState(i) != kSlotDeleted) {
+      continue;
+    }
+    if (count == views->size()) {
+      views->emplace_back();
+    }
+    GetColumnOffsets(i, minipages, widths, &offsets);
+    (*views)[count++].Reset(GetData(), schema, RowId(GetTablePageId(), i), offsets.data());
+  }
+  return count;
+}
+
+bool PaxPage::GetFirstTupleRid(RowId *first_rid) {
+  for (uint32_t i = 0; i < GetPaxCapacity(); i++) {
+    if (GetSlotState(i) == kSlotLive) {
+      first_rid->Set(GetTablePageId(), i);
+      return true;
+    }
+  }
+  first_rid->Set(INVALID_PAGE_ID, 0);
+  return false;
+}
+
+bool PaxPage::GetNextTupleRid(const RowId &cur_rid, RowId *next_rid) {
+  ASSERT(cur_rid.GetPageId() == GetTablePageId(), "Wrong table!");
+  for (uint32_t i = cur_rid.GetSlotNum() + 1; i < GetPaxCapacity(); i++) {
+    if (GetSlotState(i) == kSlotLive) {
+      next_rid->Set(GetTablePageId(), i);
+      return true;
+    }
+  }
+  next_rid->Set(INVALID_PAGE_ID, 0);
+  return false;
+}
+
+uint32_t PaxPage::GetDeletedTupleSpace() {
+  uint32_t deleted = 0;
+  for (uint32_t i = 0; i < GetPaxCapacity(); i++) {
+    if (GetSlotState(i) == kSlotDeleted) {
+      deleted++;
+    }
+  }
+  return deleted * GetPaxSlotWidth();
+}
+
+uint32_t PaxPage::Compact() {
+  // 值的位置由槽号决定，只需要把标记删除的槽置空
+  uint32_t removed = 0;
+  uint32_t hint = GetPaxCapacity();
+  for (uint32_t i = 0; i < GetPaxCapacity(); i++) {
+    if (GetSlotState(i) == kSlotDeleted) {
+      SetSlotState(i, kSlotEmpty);
+      removed++;
+    }
+    if (GetSlotState(i) == kSlotEmpty) {
+      hint = std::min(hint, i);
+    }
+  }
+  SetTupleCount(GetTupleCount() - removed);
+  SetFreeSlotHint(hint);
+  BumpModCount();
+  return removed;
+}
@@ -1,5 +1,9 @@
 #include "page/table_page.h"
 
+#include <algorithm>
+
+#include "page/pax_page.h"
+
 // TODO: Update interface implementation if apply recovery
 
 void TablePage::Init(page_id_t page_id, page_id_t prev_id, LogManager *log_mgr, Txn *txn) {
@@ -8,23 +12,32 @@ void TablePage::Init(page_id_t page_id, page_id_t prev_id, LogManager *log_mgr,
   SetNextPageId(INVALID_PAGE_ID);
   SetFreeSpacePointer(PAGE_SIZE);
   SetTupleCount(0);
+  SetFreeSlotHint(0);
+  SetLayout(TableLayout::kRow);
+  SetFormatVersion(FORMAT_VERSION);
+  SetModCount(0);
 }
 
 bool TablePage::InsertTuple(Row &row, Schema *schema, Txn *txn, LockManager *lock_manager, LogManager *log_manager) {
+  if (IsPax()) {
+    return AsPax()->InsertTuple(row, schema, txn, lock_manager, log_manager);
+  }
   uint32_t serialized_size = row.GetSerializedSize(schema);
   ASSERT(serialized_size > 0, "Can not have empty row.");
-  if (GetFreeSpaceRemaining() < serialized_size + SIZE_TUPLE) {
-    return false;
-  }
-  // Try to find a free slot to reuse.
+  // Try to find a free slot to reuse, the slots below the hint are all taken.
   uint32_t i;
-  for (i = 0; i < GetTupleCount(); i++) {
+  for (i = GetFreeSlotHint(); i < GetTupleCount(); i++) {
     // If the slot is empty, i.e. its tuple has size 0,
     if (GetTupleSize(i) == 0) {
       // Then we break out of the loop at index i.
       break;
     }
   }
+  // A reused slot needs no room in the slot array.
+  if (GetFreeSpaceRemaining() < serialized_size + (i == GetTupleCount() ? SIZE_TUPLE : 0)) {
+    return false;
+  }
+  SetFreeSlotHint(i + 1);
   // Otherwise we claim available free space..
   SetFreeSpacePointer(GetFreeSpacePointer() - serialized_size);
   uint32_t __attribute__((unused)) write_bytes = row.SerializeTo(GetData() + GetFreeSpacePointer(), schema);
@@ -38,10 +51,14 @@ bool TablePage::InsertTuple(Row &row, Schema *schema, Txn *txn, LockManager *loc
   if (i == GetTupleCount()) {
     SetTupleCount(GetTupleCount() + 1);
   }
+  BumpModCount();
   return true;
 }
 
 bool TablePage::MarkDelete(const RowId &rid, Txn *txn, LockManager *lock_manager, LogManager *log_manager) {
+  if (IsPax()) {
+    return AsPax()->MarkDelete(rid, txn, lock_manager, log_manager);
+  }
   uint32_t slot_num = rid.GetSlotNum();
   // If the slot number is invalid, abort.
   if (slot_num >= GetTupleCount()) {
@@ -56,11 +73,15 @@ bool TablePage::MarkDelete(const RowId &rid, Txn *txn, LockManager *lock_manager
   if (tuple_size > 0) {
     SetTupleSize(slot_num, SetDeletedFlag(tuple_size));
   }
+  BumpModCount();
   return true;
 }
 
 bool TablePage::UpdateTuple(Row &new_row, Row *old_row, Schema *schema, Txn *txn, LockManager *lock_manager,
                             LogManager *log_manager) {
+  if (IsPax()) {
+    return AsPax()->UpdateTuple(new_row, old_row, schema, txn, lock_manager, log_manager);
+  }
   ASSERT(old_row != nullptr && old_row->GetRowId().Get() != INVALID_ROWID.Get(), "invalid old row.");
   uint32_t serialized_size = new_row.GetSerializedSize(schema);
   ASSERT(serialized_size > 0, "Can not have empty row.");
@@ -97,10 +118,15 @@ bool TablePage::UpdateTuple(Row &new_row, Row *old_row, Schema *schema, Txn *txn
       SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - new_row.GetSerializedSize(schema));
     }
   }
+  BumpModCount();
   return true;
 }
 
 void TablePage::ApplyDelete(const RowId &rid, Txn *txn, LogManager *log_manager) {
+  if (IsPax()) {
+    AsPax()->ApplyDelete(rid, txn, log_manager);
+    return;
+  }
   uint32_t slot_num = rid.GetSlotNum();
   ASSERT(slot_num < GetTupleCount(), "Cannot have more slots than tuples.");
 
@@ -119,6 +145,7 @@ void TablePage::ApplyDelete(const RowId &rid, Txn *txn, LogManager *log_manager)
   SetFreeSpacePointer(free_space_pointer + tuple_size);
   SetTupleSize(slot_num, 0);
   SetTupleOffsetAtSlot(slot_num, 0);
+  SetFreeSlotHint(std::min(GetFreeSlotHint(), slot_num));
 
   // Update all tuple offsets.
   for (uint32_t i = 0; i < GetTupleCount(); ++i) {
@@ -127,9 +154,14 @@ void TablePage::ApplyDelete(const RowId &rid, Txn *txn, LogManager *log_manager)
       SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size);
     }
   }
+  BumpModCount();
 }
 
 void TablePage::RollbackDelete(const RowId &rid, Txn *txn, LogManager *log_manager) {
+  if (IsPax()) {
+    AsPax()->RollbackDelete(rid, txn, log_manager);
+    return;
+  }
   uint32_t slot_num = rid.GetSlotNum();
   ASSERT(slot_num < GetTupleCount(), "We can't have more slots than tuples.");
   uint32_t tuple_size = GetTupleSize(slot_num);
@@ -138,9 +170,68 @@ void TablePage::RollbackDelete(const RowId &rid, Txn *txn, LogManager *log_manag
   if (IsDeleted(tuple_size)) {
     SetTupleSize(slot_num, UnsetDeletedFlag(tuple_size));
   }
+  BumpModCount();
+}
+
+uint32_t TablePage::GetDeletedTupleSpace() {
+  if (IsPax()) {
+    return AsPax()->GetDeletedTupleSpace();
+  }
+  uint32_t deleted_space = 0;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    uint32_t tuple_size = GetTupleSize(i);
+    if (tuple_size != 0 && IsDeleted(tuple_size)) {
+      deleted_space += UnsetDeletedFlag(tuple_size);
+    }
+  }
+  return deleted_space;
+}
+
+uint32_t TablePage::Compact() {
+  if (IsPax()) {
+    return AsPax()->Compact();
+  }
+  // 存活的元组按槽号依次拷贝到临时页的末尾，再整体拷回，槽号不变
+  char buffer[PAGE_SIZE];
+  uint32_t free_space_pointer = PAGE_SIZE;
+  uint32_t removed = 0;
+  uint32_t tuple_count = GetTupleCount();
+  for (uint32_t i = 0; i < tuple_count; i++) {
+    uint32_t tuple_size = GetTupleSize(i);
+    if (tuple_size == 0) {
+      continue;
+    }
+    if (IsDeleted(tuple_size)) {
+      SetTupleSize(i, 0);
+      SetTupleOffsetAtSlot(i, 0);
+      removed++;
+      continue;
+    }
+    free_space_pointer -= tuple_size;
+    memcpy(buffer + free_space_pointer, GetData() + GetTupleOffsetAtSlot(i), tuple_size);
+    SetTupleOffsetAtSlot(i, free_space_pointer);
+  }
+  memcpy(GetData() + free_space_pointer, buffer + free_space_pointer, PAGE_SIZE - free_space_pointer);
+  SetFreeSpacePointer(free_space_pointer);
+
+  // 归还末尾的空槽，并重新找到第一个空槽
+  while (tuple_count > 0 && GetTupleSize(tuple_count - 1) == 0) {
+    tuple_count--;
+  }
+  SetTupleCount(tuple_count);
+  uint32_t hint = 0;
+  while (hint < tuple_count && GetTupleSize(hint) != 0) {
+    hint++;
+  }
+  SetFreeSlotHint(hint);
+  BumpModCount();
+  return removed;
 }
 
 bool TablePage::GetTuple(Row *row, Schema *schema, Txn *txn, LockManager *lock_manager) {
+  if (IsPax()) {
+    return AsPax()->GetTuple(row, schema, txn, lock_manager);
+  }
   ASSERT(row != nullptr && row->GetRowId().Get() != INVALID_ROWID.Get(), "Invalid row.");
   // Get the current slot number.
   uint32_t slot_num = row->GetRowId().GetSlotNum();
@@ -161,7 +252,76 @@ bool TablePage::GetTuple(Row *row, Schema *schema, Txn *txn, LockManager *lock_m
   return true;
 }
 
+bool TablePage::GetTupleView(const RowId &rid, const Schema *schema, RowView *view,
+                             const OverflowStore *overflow_store, bool include_deleted) {
+  if (IsPax()) {
+    return AsPax()->GetTupleView(rid, schema, view, overflow_store, include_deleted);
+  }
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount()) {
+    return false;
+  }
+  uint32_t tuple_size = GetTupleSize(slot_num);
+  if (tuple_size == 0 || (IsDeleted(tuple_size) && !include_deleted)) {
+    return false;
+  }
+  tuple_size = UnsetDeletedFlag(tuple_size);
+  // 视图直接指向页中的元组，不做反序列化
+  uint32_t __attribute__((unused)) view_bytes =
+      view->Reset(GetData() + GetTupleOffsetAtSlot(slot_num), schema, rid, overflow_store);
+  ASSERT(tuple_size == view_bytes, "Unexpected behavior in tuple view.");
+  return true;
+}
+
+uint32_t TablePage::GetTupleViews(const Schema *schema, uint32_t begin_slot, std::vector<RowView> *views,
+                                  const OverflowStore *overflow_store) {
+  if (IsPax()) {
+    return AsPax()->GetTupleViews(schema, begin_slot, views, overflow_store);
+  }
+  uint32_t count = 0;
+  uint32_t tuple_count = GetTupleCount();
+  for (uint32_t i = begin_slot; i < tuple_count; i++) {
+    uint32_t tuple_size = GetTupleSize(i);
+    if (IsDeleted(tuple_size)) {
+      continue;
+    }
+    if (count == views->size()) {
+      views->emplace_back();
+    }
+    uint32_t __attribute__((unused)) view_bytes =
+        (*views)[count++].Reset(GetData() + GetTupleOffsetAtSlot(i), schema, RowId(GetTablePageId(), i),
+                                overflow_store);
+    ASSERT(tuple_size == view_bytes, "Unexpected behavior in tuple view.");
+  }
+  return count;
+}
+
+uint32_t TablePage::GetDeletedTupleViews(const Schema *schema, std::vector<RowView> *views) {
+  if (IsPax()) {
+    return AsPax()->GetDeletedTupleViews(schema, views);
+  }
+  uint32_t count = 0;
+  uint32_t tuple_count = GetTupleCount();
+  for (uint32_t i = 0; i < tuple_count; i++) {
+    uint32_t tuple_size = GetTupleSize(i);
+    // 只要被标记删除、还没有真正移除的元组
+    if (tuple_size == 0 || !IsDeleted(tuple_size)) {
+      continue;
+    }
+    if (count == views->size()) {
+      views->emplace_back();
+    }
+    uint32_t __attribute__((unused)) view_bytes =
+        (*views)[count++].Reset(GetData() + GetTupleOffsetAtSlot(i), schema, RowId(GetTablePageId(), i));
+    ASSERT(UnsetDeletedFlag(tuple_size) == view_bytes, "Unexpected behavior in tuple view.");
+  }
+  return count;
+}
+
 bool TablePage::GetFirstTupleRid(RowId *first_rid) {
+  if (IsPax()) {
+    return AsPax()->GetFirstTupleRid(first_rid);
+  }
   // Find and return the first valid tuple.
   for (uint32_t i = 0; i < GetTupleCount(); i++) {
     if (!IsDeleted(GetTupleSize(i))) {
@@ -174,6 +334,9 @@ bool TablePage::GetFirstTupleRid(RowId *first_rid) {
 }
 
 bool TablePage::GetNextTupleRid(const RowId &cur_rid, RowId *next_rid) {
+  if (IsPax()) {
+    return AsPax()->GetNextTupleRid(cur_rid, next_rid);
+  }
   ASSERT(cur_rid.GetPageId() == GetTablePageId(), "Wrong table!");
   // Find and return the first valid tuple after our current slot number.
   for (auto i = cur_rid.GetSlotNum() + 1; i < GetTupleCount(); i++) {
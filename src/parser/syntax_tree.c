@@ -165,6 +165,8 @@ const char *GetSyntaxNodeTypeStr(SyntaxNodeType type) {
       return "kNodeCreateIndex";
     case kNodeDropIndex:
       return "kNodeDropIndex";
+    case kNodeTableLayout:
+      return "kNodeTableLayout";
     case kNodeTrxBegin:
       return "kNodeTrxBegin";
     case kNodeTrxCommit:
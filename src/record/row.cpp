@@ -1,5 +1,10 @@
 #include "record/row.h"
 
+#include <algorithm>
+#include <new>
+
+#include "common/memory_arena.h"
+
 /**
  * Serialize Row to buffer
  */
@@ -8,7 +13,7 @@ uint32_t Row::SerializeTo(char *buf, Schema *schema) const {
   // Serialize each field in the row
   for (uint32_t i = 0; i < schema->GetColumnCount(); ++i) {
     // Serialize the current field into the buffer
-    size += fields_[i]->SerializeTo(buf + size);
+    size += GetField(i)->SerializeTo(buf + size);
   }
   return size;
 }
@@ -17,20 +22,76 @@ uint32_t Row::SerializeTo(char *buf, Schema *schema) const {
  * Deserialize Row from buffer
  */
 uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
+  destroy();
+  // 先算出字符串的总长度，缓冲区一次分配够
+  uint32_t column_count = schema->GetColumnCount();
   uint32_t offset = 0;
-  
-  // Initialize fields_ to the size of schema's columns
-  fields_.clear();
-  for (uint32_t i = 0; i < schema->GetColumnCount(); ++i) {
-    // Allocate a new Field for each column
-    Field* field = nullptr;
-    offset += Field::DeserializeFrom(buf + offset, schema->GetColumn(i)->GetType(), &field, false);
-    fields_.push_back(field);  // Add the deserialized field to the fields_ vector
+  uint32_t data_size = 0;
+  for (uint32_t i = 0; i < column_count; ++i) {
+    TypeId type = schema->GetColumn(i)->GetType();
+    if (type == TypeId::kTypeChar) {
+      uint32_t len = MACH_READ_UINT32(buf + offset);
+      if (len & FIELD_OVERFLOW_FLAG) {
+        offset += sizeof(uint32_t) + sizeof(page_id_t);
+      } else {
+        data_size += len;
+        offset += sizeof(uint32_t) + len;
+      }
+    } else {
+      offset += Type::GetTypeSize(type);
+    }
   }
+  Reserve(column_count, data_size);
 
+  offset = 0;
+  for (uint32_t i = 0; i < column_count; ++i) {
+    offset += DeserializeField(buf + offset, schema->GetColumn(i)->GetType());
+  }
   return offset;
 }
 
+void Row::DeserializeFrom(const char *buf, const uint32_t *offsets, const Schema *schema) {
+  destroy();
+  uint32_t column_count = schema->GetColumnCount();
+  uint32_t data_size = 0;
+  for (uint32_t i = 0; i < column_count; ++i) {
+    if (schema->GetColumn(i)->GetType() == TypeId::kTypeChar) {
+      uint32_t len = MACH_READ_UINT32(buf + offsets[i]);
+      data_size += (len & FIELD_OVERFLOW_FLAG) ? 0 : len;
+    }
+  }
+  Reserve(column_count, data_size);
+  for (uint32_t i = 0; i < column_count; ++i) {
+    DeserializeField(buf + offsets[i], schema->GetColumn(i)->GetType());
+  }
+}
+
+uint32_t Row::DeserializeField(const char *buf, TypeId type) {
+  switch (type) {
+    case TypeId::kTypeInt:
+      AppendField(Field(TypeId::kTypeInt, MACH_READ_FROM(int32_t, buf)));
+      return sizeof(int32_t);
+    case TypeId::kTypeFloat:
+      AppendField(Field(TypeId::kTypeFloat, MACH_READ_FROM(float, buf)));
+      return sizeof(float);
+    case TypeId::kTypeChar: {
+      uint32_t len = MACH_READ_UINT32(buf);
+      if (len & FIELD_OVERFLOW_FLAG) {
+        AppendField(Field(TypeId::kTypeChar, MACH_READ_FROM(page_id_t, buf + sizeof(uint32_t)),
+                          len & ~FIELD_OVERFLOW_FLAG));
+        return sizeof(uint32_t) + sizeof(page_id_t);
+      }
+      // 字段只是临时指向buf，字符会被拷贝到行的缓冲区中
+      AppendField(Field(TypeId::kTypeChar, const_cast<char *>(buf + sizeof(uint32_t)), len, false));
+      return sizeof(uint32_t) + len;
+    }
+    default:
+      break;
+  }
+  ASSERT(false, "Unsupported field type.");
+  return 0;
+}
+
 /**
  * Get the size of the serialized Row
  */
@@ -39,7 +100,7 @@ uint32_t Row::GetSerializedSize(Schema *schema) const {
   
   // Get the size of each field in the row
   for (uint32_t i = 0; i < schema->GetColumnCount(); ++i) {
-    size += fields_[i]->GetSerializedSize();
+    size += GetField(i)->GetSerializedSize();
   }
 
   return size;
@@ -49,17 +110,101 @@ uint32_t Row::GetSerializedSize(Schema *schema) const {
  * Generate a key Row based on the schema and key schema
  */
 void Row::GetKeyFromRow(const Schema *schema, const Schema *key_schema, Row &key_row) {
-  auto columns = key_schema->GetColumns();
-  std::vector<Field> fields;
+  const auto &columns = key_schema->GetColumns();
+  uint32_t data_size = 0;
+  for (auto column : columns) {
+    uint32_t idx;
+    schema->GetColumnIndex(column->GetName(), idx);
+    data_size += GetDataSize(*GetField(idx));
+  }
 
-  uint32_t idx;
-  // Generate the key row by using the columns in key_schema
+  // 直接拷贝到key_row的缓冲区中
+  key_row.destroy();
+  key_row.Reserve(columns.size(), data_size);
   for (auto column : columns) {
-    // Get the index of the column in the schema
+    uint32_t idx;
     schema->GetColumnIndex(column->GetName(), idx);
-    fields.emplace_back(*this->GetField(idx));  // Get the field from current row
+    key_row.AppendField(*GetField(idx));
+  }
+}
+
+void Row::Reserve(uint32_t field_count, uint32_t data_size) {
+  if (field_count > field_capacity_ || data_size > data_capacity_) {
+    FreeStorage(Grow(std::max(field_count, field_capacity_), std::max(data_size, data_capacity_)));
+  }
+}
+
+char *Row::Grow(uint32_t field_capacity, uint32_t data_capacity) {
+  size_t size = field_capacity * sizeof(Field) + data_capacity;
+  char *storage = arena_ == nullptr ? new char[size] : static_cast<char *>(arena_->Allocate(size, alignof(Field)));
+  auto *fields = reinterpret_cast<Field *>(storage);
+  char *data = storage + field_capacity * sizeof(Field);
+  // 字段不拥有字符，可以直接按字节搬过去，再让字符串字段指向新缓冲区
+  if (field_count_ > 0) {
+    memcpy(static_cast<void *>(fields), storage_, field_count_ * sizeof(Field));
+    memcpy(data, GetDataArea(), data_size_);
+    for (uint32_t i = 0; i < field_count_; i++) {
+      if (GetDataSize(fields[i]) > 0) {
+        fields[i].value_.chars_ = data + (fields[i].value_.chars_ - GetDataArea());
+      }
+    }
+  }
+  std::swap(storage_, storage);
+  field_capacity_ = field_capacity;
+  data_capacity_ = data_capacity;
+  return storage;
+}
+
+void Row::PlaceField(Field *dest, const Field &field) {
+  // 先把字符拷贝到数据区末尾，field可能就是dest
+  Field::Val value = field.value_;
+  uint32_t len = GetDataSize(field);
+  if (len > 0) {
+    value.chars_ = GetDataArea() + data_size_;
+    memcpy(value.chars_, field.value_.chars_, len);
+    data_size_ += len;
   }
+  uint32_t field_len = field.len_;
+  bool is_null = field.is_null_;
+  bool is_external = field.is_external_;
+  auto *copy = new (dest) Field(field.type_id_);
+  copy->value_ = value;
+  copy->len_ = field_len;
+  copy->is_null_ = is_null;
+  copy->is_external_ = is_external;
+}
+
+Field *Row::AppendField(const Field &field) {
+  uint32_t len = GetDataSize(field);
+  char *old_storage = nullptr;
+  if (field_count_ == field_capacity_ || data_size_ + len > data_capacity_) {
+    // field可能就在本行的旧缓冲区中，拷贝完之后再释放
+    old_storage =
+        Grow(std::max(field_count_ + 1, field_capacity_ * 2), std::max(data_size_ + len, data_capacity_ * 2));
+  }
+  Field *dest = GetFieldArray() + field_count_;
+  PlaceField(dest, field);
+  field_count_++;
+  FreeStorage(old_storage);
+  return dest;
+}
 
-  // Set the key_row to a new Row with the generated fields
-  key_row = Row(fields);
+void Row::SetField(uint32_t idx, const Field &field) {
+  ASSERT(idx < field_count_, "Failed to access field");
+  uint32_t len = GetDataSize(field);
+  char *old_storage = nullptr;
+  if (data_size_ + len > data_capacity_) {
+    old_storage = Grow(field_capacity_, std::max(data_size_ + len, data_capacity_ * 2));
+  }
+  // 旧值的字符留在缓冲区中，直到整行被清空
+  PlaceField(GetFieldArray() + idx, field);
+  FreeStorage(old_storage);
+}
+
+void Row::CopyFields(const Row &other) {
+  destroy();
+  Reserve(other.field_count_, other.data_size_);
+  for (uint32_t i = 0; i < other.field_count_; i++) {
+    AppendField(*other.GetField(i));
+  }
 }
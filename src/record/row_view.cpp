@@ -0,0 +1,100 @@
+#include "record/row_view.h"
+
+#include <algorithm>
+
+#include "storage/overflow_store.h"
+
+/**
+ * 依次计算每一列在序列化数据中的偏移，定长类型直接跳过，字符串先读出长度
+ */
+uint32_t RowView::Reset(const char *data, const Schema *schema, RowId rid, const OverflowStore *overflow_store) {
+  data_ = data;
+  schema_ = schema;
+  rid_ = rid;
+  overflow_store_ = overflow_store;
+  ResetExternal();
+  uint32_t column_count = schema->GetColumnCount();
+  offsets_.resize(column_count);  // 复用上一行的容量，不会重新分配
+  uint32_t offset = 0;
+  for (uint32_t i = 0; i < column_count; i++) {
+    offsets_[i] = offset;
+    TypeId type = schema->GetColumn(i)->GetType();
+    if (type == TypeId::kTypeChar) {
+      uint32_t len = MACH_READ_UINT32(data + offset);
+      // 存在溢出页中的字段，行中只有长度和溢出页的页号
+      offset += sizeof(uint32_t) + ((len & FIELD_OVERFLOW_FLAG) ? sizeof(page_id_t) : len);
+    } else {
+      offset += Type::GetTypeSize(type);
+    }
+  }
+  size_ = offset;
+  return size_;
+}
+
+void RowView::Reset(const char *data, const Schema *schema, RowId rid, const uint32_t *column_offsets,
+                    const OverflowStore *overflow_store) {
+  data_ = data;
+  schema_ = schema;
+  rid_ = rid;
+  overflow_store_ = overflow_store;
+  ResetExternal();
+  // 只记下各列的位置，不读任何一列的数据
+  offsets_.assign(column_offsets, column_offsets + schema->GetColumnCount());
+  size_ = 0;
+}
+
+void RowView::ResetExternal() {
+  if (has_external_) {
+    // 上一行读出的溢出字段作废
+    std::fill(external_read_.begin(), external_read_.end(), false);
+    has_external_ = false;
+  }
+}
+
+Field RowView::GetField(uint32_t idx, bool manage_data) const {
+  ASSERT(idx < offsets_.size(), "Failed to access field");
+  switch (GetTypeId(idx)) {
+    case TypeId::kTypeInt:
+      return Field(TypeId::kTypeInt, GetInt(idx));
+    case TypeId::kTypeFloat:
+      return Field(TypeId::kTypeFloat, GetFloat(idx));
+    case TypeId::kTypeChar: {
+      uint32_t len;
+      const char *chars = GetChars(idx, &len);
+      // 默认不拷贝字符串，直接指向页中的数据
+      return Field(TypeId::kTypeChar, const_cast<char *>(chars), len, manage_data);
+    }
+    default:
+      break;
+  }
+  ASSERT(false, "Unsupported field type.");
+  return Field(GetTypeId(idx));
+}
+
+const char *RowView::GetExternalChars(uint32_t idx, uint32_t *len) const {
+  ASSERT(overflow_store_ != nullptr, "Row view without overflow store.");
+  *len &= ~FIELD_OVERFLOW_FLAG;
+  if (external_read_.size() < offsets_.size()) {
+    external_read_.resize(offsets_.size(), false);
+    external_.resize(offsets_.size());
+  }
+  // 第一次访问时才读溢出页
+  if (!external_read_[idx]) {
+    external_[idx].resize(*len);
+    bool __attribute__((unused)) read = overflow_store_->Read(GetOverflowPageId(idx), *len, &external_[idx][0]);
+    ASSERT(read, "Failed to read overflow pages.");
+    external_read_[idx] = true;
+    has_external_ = true;
+  }
+  return external_[idx].data();
+}
+
+void RowView::Materialize(Row *row) const {
+  ASSERT(IsValid(), "Materializing an invalid row view.");
+  row->SetRowId(rid_);
+  // 各列的位置已经算好，直接按列拷贝到行的缓冲区中
+  row->DeserializeFrom(data_, offsets_.data(), schema_);
+  if (overflow_store_ != nullptr) {
+    overflow_store_->Detoast(row);
+  }
+}
@@ -3,18 +3,6 @@
 #include "common/macros.h"
 #include "record/field.h"
 
-inline int CompareStrings(const char *str1, int len1, const char *str2, int len2) {
-  assert(str1 != nullptr);
-  assert(len1 >= 0);
-  assert(str2 != nullptr);
-  assert(len2 >= 0);
-  int ret = memcmp(str1, str2, static_cast<size_t>(std::min(len1, len2)));
-  if (ret == 0 && len1 != len2) {
-    ret = len1 - len2;
-  }
-  return ret;
-}
-
 // ==============================Type=============================
 
 Type *Type::type_singletons_[] = {new Type(TypeId::kTypeInvalid), new TypeInt(), new TypeFloat(), new TypeChar()};
@@ -77,11 +65,7 @@ CmpBool Type::CompareGreaterThanEquals(const Field &left, const Field &right) co
 // ==============================TypeInt=================================
 
 uint32_t TypeInt::SerializeTo(const Field &field, char *buf) const {
-  if (!field.IsNull()) {
-    MACH_WRITE_TO(int32_t, buf, field.value_.integer_);
-    return GetTypeSize(type_id_);
-  }
-  return 0;
+  return Field::SerializeKernel<TypeId::kTypeInt>(field, buf);
 }
 
 uint32_t TypeInt::DeserializeFrom(char *storage, Field **field, bool is_null) const {
@@ -102,61 +86,33 @@ uint32_t TypeInt::GetSerializedSize(const Field &field, bool is_null) const {
 }
 
 CmpBool TypeInt::CompareEquals(const Field &left, const Field &right) const {
-  ASSERT(left.CheckComparable(right), "Not comparable.");
-  if (left.IsNull() || right.IsNull()) {
-    return CmpBool::kNull;
-  }
-  return GetCmpBool(left.value_.integer_ == right.value_.integer_);
+  return Field::CompareKernel<TypeId::kTypeInt, CompareOp::kEquals>(left, right);
 }
 
 CmpBool TypeInt::CompareNotEquals(const Field &left, const Field &right) const {
-  ASSERT(left.CheckComparable(right), "Not comparable.");
-  if (left.IsNull() || right.IsNull()) {
-    return CmpBool::kNull;
-  }
-  return GetCmpBool(left.value_.integer_ != right.value_.integer_);
+  return Field::CompareKernel<TypeId::kTypeInt, CompareOp::kNotEquals>(left, right);
 }
 
 CmpBool TypeInt::CompareLessThan(const Field &left, const Field &right) const {
-  ASSERT(left.CheckComparable(right), "Not comparable.");
-  if (left.IsNull() || right.IsNull()) {
-    return CmpBool::kNull;
-  }
-  return GetCmpBool(left.value_.integer_ < right.value_.integer_);
+  return Field::CompareKernel<TypeId::kTypeInt, CompareOp::kLessThan>(left, right);
 }
 
 CmpBool TypeInt::CompareLessThanEquals(const Field &left, const Field &right) const {
-  ASSERT(left.CheckComparable(right), "Not comparable.");
-  if (left.IsNull() || right.IsNull()) {
-    return CmpBool::kNull;
-  }
-  return GetCmpBool(left.value_.integer_ <= right.value_.integer_);
+  return Field::CompareKernel<TypeId::kTypeInt, CompareOp::kLessThanEquals>(left, right);
 }
 
 CmpBool TypeInt::CompareGreaterThan(const Field &left, const Field &right) const {
-  ASSERT(left.CheckComparable(right), "Not comparable.");
-  if (left.IsNull() || right.IsNull()) {
-    return CmpBool::kNull;
-  }
-  return GetCmpBool(left.value_.integer_ > right.value_.integer_);
+  return Field::CompareKernel<TypeId::kTypeInt, CompareOp::kGreaterThan>(left, right);
 }
 
 CmpBool TypeInt::CompareGreaterThanEquals(const Field &left, const Field &right) const {
-  ASSERT(left.CheckComparable(right), "Not comparable.");
-  if (left.IsNull() || right.IsNull()) {
-    return CmpBool::kNull;
-  }
-  return GetCmpBool(left.value_.integer_ >= right.value_.integer_);
+  return Field::CompareKernel<TypeId::kTypeInt, CompareOp::kGreaterThanEquals>(left, right);
 }
 
 // ==============================TypeFloat=============================
 
 uint32_t TypeFloat::SerializeTo(const Field &field, char *buf) const {
-  if (!field.IsNull()) {
-    MACH_WRITE_TO(float_t, buf, field.value_.float_);
-    return GetTypeSize(type_id_);
-  }
-  return 0;
+  return Field::SerializeKernel<TypeId::kTypeFloat>(field, buf);
 }
 
 uint32_t TypeFloat::DeserializeFrom(char *storage, Field **field, bool is_null) const {
@@ -177,62 +133,32 @@ uint32_t TypeFloat::GetSerializedSize(const Field &field, bool is_null) const {
 }
 
 CmpBool TypeFloat::CompareEquals(const Field &left, const Field &right) const {
-  ASSERT(left.CheckComparable(right), "Not comparable.");
-  if (left.IsNull() || right.IsNull()) {
-    return CmpBool::kNull;
-  }
-  return GetCmpBool(left.value_.float_ == right.value_.float_);
+  return Field::CompareKernel<TypeId::kTypeFloat, CompareOp::kEquals>(left, right);
 }
 
 CmpBool TypeFloat::CompareNotEquals(const Field &left, const Field &right) const {
-  ASSERT(left.CheckComparable(right), "Not comparable.");
-  if (left.IsNull() || right.IsNull()) {
-    return CmpBool::kNull;
-  }
-  return GetCmpBool(left.value_.float_ != right.value_.float_);
+  return Field::CompareKernel<TypeId::kTypeFloat, CompareOp::kNotEquals>(left, right);
 }
 
 CmpBool TypeFloat::CompareLessThan(const Field &left, const Field &right) const {
-  ASSERT(left.CheckComparable(right), "Not comparable.");
-  if (left.IsNull() || right.IsNull()) {
-    return CmpBool::kNull;
-  }
-  return GetCmpBool(left.value_.float_ < right.value_.float_);
+  return Field::CompareKernel<TypeId::kTypeFloat, CompareOp::kLessThan>(left, right);
 }
 
 CmpBool TypeFloat::CompareLessThanEquals(const Field &left, const Field &right) const {
-  ASSERT(left.CheckComparable(right), "Not comparable.");
-  if (left.IsNull() || right.IsNull()) {
-    return CmpBool::kNull;
-  }
-  return GetCmpBool(left.value_.float_ <= right.value_.float_);
+  return Field::CompareKernel<TypeId::kTypeFloat, CompareOp::kLessThanEquals>(left, right);
 }
 
 CmpBool TypeFloat::CompareGreaterThan(const Field &left, const Field &right) const {
-  ASSERT(left.CheckComparable(right), "Not comparable.");
-  if (left.IsNull() || right.IsNull()) {
-    return CmpBool::kNull;
-  }
-  return GetCmpBool(left.value_.float_ > right.value_.float_);
+  return Field::CompareKernel<TypeId::kTypeFloat, CompareOp::kGreaterThan>(left, right);
 }
 
 CmpBool TypeFloat::CompareGreaterThanEquals(const Field &left, const Field &right) const {
-  ASSERT(left.CheckComparable(right), "Not comparable.");
-  if (left.IsNull() || right.IsNull()) {
-    return CmpBool::kNull;
-  }
-  return GetCmpBool(left.value_.float_ >= right.value_.float_);
+  return Field::CompareKernel<TypeId::kTypeFloat, CompareOp::kGreaterThanEquals>(left, right);
 }
 
 // ==============================TypeChar=============================
 uint32_t TypeChar::SerializeTo(const Field &field, char *buf) const {
-  if (!field.IsNull()) {
-    uint32_t len = GetLength(field);
-    memcpy(buf, &len, sizeof(uint32_t));
-    memcpy(buf + sizeof(uint32_t), field.value_.chars_, len);
-    return len + sizeof(uint32_t);
-  }
-  return 0;
+  return Field::SerializeKernel<TypeId::kTypeChar>(field, buf);
 }
 
 uint32_t TypeChar::DeserializeFrom(char *storage, Field **field, bool is_null) const {
@@ -241,6 +167,11 @@ uint32_t TypeChar::DeserializeFrom(char *storage, Field **field, bool is_null) c
     return 0;
   }
   uint32_t len = MACH_READ_UINT32(storage);
+  if (len & FIELD_OVERFLOW_FLAG) {
+    *field = new Field(TypeId::kTypeChar, MACH_READ_FROM(page_id_t, storage + sizeof(uint32_t)),
+                       len & ~FIELD_OVERFLOW_FLAG);
+    return sizeof(uint32_t) + sizeof(page_id_t);
+  }
   *field = new Field(TypeId::kTypeChar, storage + sizeof(uint32_t), len, true);
   return len + sizeof(uint32_t);
 }
@@ -249,11 +180,15 @@ uint32_t TypeChar::GetSerializedSize(const Field &field, bool is_null) const {
   if (is_null) {
     return 0;
   }
+  if (field.IsExternal()) {
+    return sizeof(uint32_t) + sizeof(page_id_t);
+  }
   uint32_t len = GetLength(field);
   return len + sizeof(uint32_t);
 }
 
 const char *TypeChar::GetData(const Field &val) const {
+  ASSERT(!val.IsExternal(), "Field is stored in overflow pages.");
   return val.value_.chars_;
 }
 
@@ -262,49 +197,25 @@ uint32_t TypeChar::GetLength(const Field &val) const {
 }
 
 CmpBool TypeChar::CompareEquals(const Field &left, const Field &right) const {
-  ASSERT(left.CheckComparable(right), "Not comparable.");
-  if (left.IsNull() || right.IsNull()) {
-    return CmpBool::kNull;
-  }
-  return GetCmpBool(CompareStrings(left.GetData(), left.GetLength(), right.GetData(), right.GetLength()) == 0);
+  return Field::CompareKernel<TypeId::kTypeChar, CompareOp::kEquals>(left, right);
 }
 
 CmpBool TypeChar::CompareNotEquals(const Field &left, const Field &right) const {
-  ASSERT(left.CheckComparable(right), "Not comparable.");
-  if (left.IsNull() || right.IsNull()) {
-    return CmpBool::kNull;
-  }
-  return GetCmpBool(CompareStrings(left.GetData(), left.GetLength(), right.GetData(), right.GetLength()) != 0);
+  return Field::CompareKernel<TypeId::kTypeChar, CompareOp::kNotEquals>(left, right);
 }
 
 CmpBool TypeChar::CompareLessThan(const Field &left, const Field &right) const {
-  ASSERT(left.CheckComparable(right), "Not comparable.");
-  if (left.IsNull() || right.IsNull()) {
-    return CmpBool::kNull;
-  }
-  return GetCmpBool(CompareStrings(left.GetData(), left.GetLength(), right.GetData(), right.GetLength()) < 0);
+  return Field::CompareKernel<TypeId::kTypeChar, CompareOp::kLessThan>(left, right);
 }
 
 CmpBool TypeChar::CompareLessThanEquals(const Field &left, const Field &right) const {
-  ASSERT(left.CheckComparable(right), "Not comparable.");
-  if (left.IsNull() || right.IsNull()) {
-    return CmpBool::kNull;
-  }
-  return GetCmpBool(CompareStrings(left.GetData(), left.GetLength(), right.GetData(), right.GetLength()) <= 0);
+  return Field::CompareKernel<TypeId::kTypeChar, CompareOp::kLessThanEquals>(left, right);
 }
 
 CmpBool TypeChar::CompareGreaterThan(const Field &left, const Field &right) const {
-  ASSERT(left.CheckComparable(right), "Not comparable.");
-  if (left.IsNull() || right.IsNull()) {
-    return CmpBool::kNull;
-  }
-  return GetCmpBool(CompareStrings(left.GetData(), left.GetLength(), right.GetData(), right.GetLength()) > 0);
+  return Field::CompareKernel<TypeId::kTypeChar, CompareOp::kGreaterThan>(left, right);
 }
 
 CmpBool TypeChar::CompareGreaterThanEquals(const Field &left, const Field &right) const {
-  ASSERT(left.CheckComparable(right), "Not comparable.");
-  if (left.IsNull() || right.IsNull()) {
-    return CmpBool::kNull;
-  }
-  return GetCmpBool(CompareStrings(left.GetData(), left.GetLength(), right.GetData(), right.GetLength()) >= 0);
+  return Field::CompareKernel<TypeId::kTypeChar, CompareOp::kGreaterThanEquals>(left, right);
 }
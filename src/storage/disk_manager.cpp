@@ -1,7 +1,14 @@
 #include "storage/disk_manager.h"
 
+#include <fcntl.h>
+#include <limits.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
+#include <cerrno>
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
 #include <stdexcept>
 
@@ -9,36 +16,44 @@
 #include "page/bitmap_page.h"
 
 DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
-  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    std::filesystem::path p = db_file;
-    if (p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw std::exception();
-    }
+  std::scoped_lock<std::mutex> lock(db_io_latch_);
+  // directory does not exist
+  std::filesystem::path p = db_file;
+  if (p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
+  db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (db_fd_ < 0) {
+    throw std::exception();
+  }
+  // 文件大小只在启动时查询一次，之后由写操作维护
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) == 0) {
+    file_size_ = stat_buf.st_size;
   }
   ReadPhysicalPage(META_PAGE_ID, meta_data_);
 }
 
 void DiskManager::Close() {
-  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
-  WritePhysicalPage(META_PAGE_ID, meta_data_);
+  // 先等待所有异步I/O完成，再关闭文件
+  std::unique_ptr<IOWorkerPool> io_workers;
+  {
+    std::scoped_lock<std::mutex> lock(io_workers_latch_);
+    io_workers = std::move(io_workers_);
+    io_workers_stopped_ = true;
+  }
+  io_workers.reset();
+
+  std::scoped_lock<std::mutex> lock(db_io_latch_);
   if (!closed) {
-    db_io_.close();
+    FlushMetaPages();
+    close(db_fd_);
+    db_fd_ = -1;
     closed = true;
   }
 }
 
 void DiskManager::ReadPage(page_id_t logical_page_id, char *page_data) {
   ASSERT(logical_page_id >= 0, "Invalid page id.");
+  // 数据页的读写由pread/pwrite保证原子性，不需要加锁
   ReadPhysicalPage(MapPageId(logical_page_id), page_data);
 }
 
@@ -47,34 +62,99 @@ void DiskManager::WritePage(page_id_t logical_page_id, const char *page_data) {
   WritePhysicalPage(MapPageId(logical_page_id), page_data);
 }
 
+void DiskManager::WritePages(std::vector<std::pair<page_id_t, const char *>> &pages) {
+  // 逻辑页号递增时物理页号也递增，按逻辑页号排序即按磁盘位置排序
+  std::sort(pages.begin(), pages.end(),
+            [](const auto &a, const auto &b) { return a.first < b.first; });
+
+  // 把物理上连续的页分成一段段
+  std::vector<std::pair<page_id_t, std::vector<const char *>>> runs;
+  page_id_t last_physical_page_id = INVALID_PAGE_ID;
+  for (auto &page : pages) {
+    ASSERT(page.first >= 0, "Invalid page id.");
+    page_id_t physical_page_id = MapPageId(page.first);
+    if (runs.empty() || physical_page_id != last_physical_page_id + 1) {
+      runs.emplace_back(physical_page_id, std::vector<const char *>());
+    }
+    runs.back().second.push_back(page.second);
+    last_physical_page_id = physical_page_id;
+  }
+  if (runs.size() == 1) {
+    WritePhysicalPages(runs[0].first, runs[0].second);
+    return;
+  }
+  // 多段之间互不相关，同时提交
+  std::vector<std::future<void>> writes;
+  writes.reserve(runs.size());
+  for (auto &run : runs) {
+    writes.push_back(SubmitIO([this, &run] { WritePhysicalPages(run.first, run.second); }));
+  }
+  for (auto &write : writes) {
+    write.wait();
+  }
+}
+
+std::future<void> DiskManager::ReadPageAsync(page_id_t logical_page_id, char *page_data,
+                                             std::function<void()> callback) {
+  ASSERT(logical_page_id >= 0, "Invalid page id.");
+  return SubmitIO([this, logical_page_id, page_data, callback = std::move(callback)] {
+    ReadPage(logical_page_id, page_data);
+    if (callback) {
+      callback();
+    }
+  });
+}
+
+std::future<void> DiskManager::WritePageAsync(page_id_t logical_page_id, const char *page_data,
+                                              std::function<void()> callback) {
+  ASSERT(logical_page_id >= 0, "Invalid page id.");
+  return SubmitIO([this, logical_page_id, page_data, callback = std::move(callback)] {
+    WritePage(logical_page_id, page_data);
+    if (callback) {
+      callback();
+    }
+  });
+}
+
+std::future<void> DiskManager::SubmitIO(std::function<void()> request) {
+  auto task = std::make_shared<std::packaged_task<void()>>(std::move(request));
+  auto future = task->get_future();
+  std::unique_lock<std::mutex> lock(io_workers_latch_);
+  if (io_workers_stopped_) {
+    // 关闭后没有worker，直接在当前线程执行
+    lock.unlock();
+    (*task)();
+    return future;
+  }
+  if (io_workers_ == nullptr) {
+    io_workers_ = std::make_unique<IOWorkerPool>(DEFAULT_IO_WORKERS);
+  }
+  io_workers_->Submit([task] { (*task)(); });
+  return future;
+}
+
 /**
  * TODO: Student Implement
  */
 page_id_t DiskManager::AllocatePage() {
+  std::scoped_lock<std::mutex> lock(db_io_latch_);
   // 获取元数据页的指针
   auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
 
-  // 尝试在现有分区中分配页面
-  for (uint32_t extent_id = 0; extent_id < meta_page->num_extents_; extent_id++) {
+  // 尝试在现有分区中分配页面，free_extent_hint_之前的分区都已满
+  for (uint32_t extent_id = free_extent_hint_; extent_id < meta_page->num_extents_; extent_id++) {
     // 检查当前分区是否还有空闲页面
     if (meta_page->extent_used_page_[extent_id] < BITMAP_SIZE) {
-      // 计算位图页面的ID
-      page_id_t bitmap_page_id = 1 + extent_id * (1 + BITMAP_SIZE);
-
-      // 读取位图页面的数据
-      char bitmap_data[PAGE_SIZE];
-      ReadPhysicalPage(bitmap_page_id, bitmap_data);
-      auto *bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(bitmap_data);
-
-      // 在位图中分配一个页面
+      free_extent_hint_ = extent_id;
+      // 在缓存的位图中分配一个页面，位图从自己的空闲位提示处开始查找
       uint32_t page_offset;
-      if (bitmap->AllocatePage(page_offset)) {
+      if (GetBitmapPage(extent_id)->AllocatePage(page_offset)) {
         // 更新元数据中的已使用页面数量
         meta_page->extent_used_page_[extent_id]++;
         // 更新元数据中的总分配页面数量
         meta_page->num_allocated_pages_++;
-        // 将更新后的位图写回磁盘
-        WritePhysicalPage(bitmap_page_id, bitmap_data);
+        // 位图与元数据页一起写回
+        bitmap_dirty_[extent_id] = true;
         // 返回新分配页面的ID
         return extent_id * BITMAP_SIZE + page_offset;
       }
@@ -83,23 +163,23 @@ page_id_t DiskManager::AllocatePage() {
 
   // 如果所有现有分区都满了，则创建一个新的分区
   uint32_t new_extent_id = meta_page->num_extents_;
-  // 计算新分区的位图页面ID
-  page_id_t new_bitmap_page_id = 1 + new_extent_id * (1 + BITMAP_SIZE);
+  ASSERT(static_cast<page_id_t>((new_extent_id + 1) * BITMAP_SIZE) <= MAX_VALID_PAGE_ID, "Disk file is full.");
+  meta_page->num_extents_++;
+  free_extent_hint_ = new_extent_id;
 
-  // 初始化新的位图页面
-  BitmapPage<PAGE_SIZE> new_bitmap;
-  uint32_t page_offset;
+  // 初始化新的位图页面，磁盘上还没有这个位图页
+  bitmap_pages_.resize(meta_page->num_extents_);
+  bitmap_dirty_.resize(meta_page->num_extents_, false);
+  bitmap_pages_[new_extent_id] = std::make_unique<BitmapPage<PAGE_SIZE>>();
+  bitmap_dirty_[new_extent_id] = true;
   // 在新位图中分配一个页面
-  new_bitmap.AllocatePage(page_offset);
+  uint32_t page_offset;
+  bitmap_pages_[new_extent_id]->AllocatePage(page_offset);
 
   // 更新元数据中的新分区信息
   meta_page->extent_used_page_[new_extent_id] = 1;
-  meta_page->num_extents_++;
   meta_page->num_allocated_pages_++;
 
-  // 将新位图页面写入磁盘
-  WritePhysicalPage(new_bitmap_page_id, reinterpret_cast<char *>(&new_bitmap));
-
   // 返回新分配页面的ID
   return new_extent_id * BITMAP_SIZE + page_offset;
 }
@@ -108,6 +188,7 @@ page_id_t DiskManager::AllocatePage() {
  * TODO: Student Implement
  */
 void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
+  std::scoped_lock<std::mutex> lock(db_io_latch_);
   // 计算要释放页面所在的分区ID
   uint32_t extent_id = logical_page_id / BITMAP_SIZE;
   // 计算要释放页面在分区中的偏移量
@@ -118,23 +199,15 @@ void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
   // 如果分区ID超出了当前存在的分区数量，则直接返回
   if (extent_id >= meta_page->num_extents_) return;
 
-  // 计算位图页面的ID
-  page_id_t bitmap_page_id = 1 + extent_id * (1 + BITMAP_SIZE);
-  // 定义一个字符数组来存储位图页面的数据
-  char bitmap_data[PAGE_SIZE];
-  // 从磁盘读取位图页面的数据
-  ReadPhysicalPage(bitmap_page_id, bitmap_data);
-
-  // 将读取到的位图数据转换为位图对象
-  auto *bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(bitmap_data);
-  // 在位图中释放指定偏移量的页面
-  if (bitmap->DeAllocatePage(page_offset)) {
+  // 在缓存的位图中释放指定偏移量的页面
+  if (GetBitmapPage(extent_id)->DeAllocatePage(page_offset)) {
     // 更新元数据中的已使用页面数量
     meta_page->extent_used_page_[extent_id]--;
     // 更新元数据中的总分配页面数量
     meta_page->num_allocated_pages_--;
-    // 将更新后的位图写回磁盘
-    WritePhysicalPage(bitmap_page_id, bitmap_data);
+    bitmap_dirty_[extent_id] = true;
+    // 该分区又有了空闲页
+    free_extent_hint_ = std::min(free_extent_hint_, extent_id);
   }
 }
 
@@ -142,18 +215,36 @@ void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
  * TODO: Student Implement
  */
 bool DiskManager::IsPageFree(page_id_t logical_page_id) {
+  std::scoped_lock<std::mutex> lock(db_io_latch_);
   uint32_t extent_id = logical_page_id / BITMAP_SIZE;
   uint32_t page_offset = logical_page_id % BITMAP_SIZE;
 
   auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
   if (extent_id >= meta_page->num_extents_) return true;
 
-  page_id_t bitmap_page_id = 1 + extent_id * (1 + BITMAP_SIZE);
-  char bitmap_data[PAGE_SIZE];
-  ReadPhysicalPage(bitmap_page_id, bitmap_data);
+  return GetBitmapPage(extent_id)->IsPageFree(page_offset);
+}
+
+BitmapPage<PAGE_SIZE> *DiskManager::GetBitmapPage(uint32_t extent_id) {
+  if (extent_id >= bitmap_pages_.size()) {
+    bitmap_pages_.resize(extent_id + 1);
+    bitmap_dirty_.resize(extent_id + 1, false);
+  }
+  if (bitmap_pages_[extent_id] == nullptr) {
+    bitmap_pages_[extent_id] = std::make_unique<BitmapPage<PAGE_SIZE>>();
+    ReadPhysicalPage(1 + extent_id * (1 + BITMAP_SIZE), reinterpret_cast<char *>(bitmap_pages_[extent_id].get()));
+  }
+  return bitmap_pages_[extent_id].get();
+}
 
-  auto *bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(bitmap_data);
-  return bitmap->IsPageFree(page_offset);
+void DiskManager::FlushMetaPages() {
+  for (uint32_t extent_id = 0; extent_id < bitmap_pages_.size(); extent_id++) {
+    if (bitmap_dirty_[extent_id]) {
+      WritePhysicalPage(1 + extent_id * (1 + BITMAP_SIZE), reinterpret_cast<char *>(bitmap_pages_[extent_id].get()));
+      bitmap_dirty_[extent_id] = false;
+    }
+  }
+  WritePhysicalPage(META_PAGE_ID, meta_data_);
 }
 
 /**
@@ -170,45 +261,97 @@ page_id_t DiskManager::MapPageId(page_id_t logical_page_id) {
   return 1 + extent_num * (1 + BITMAP_SIZE) + 1 + page_offset;
 }
 
-int DiskManager::GetFileSize(const std::string &file_name) {
-  struct stat stat_buf;
-  int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? stat_buf.st_size : -1;
+void DiskManager::ExtendFileSize(size_t new_size) {
+  size_t old_size = file_size_.load();
+  while (old_size < new_size && !file_size_.compare_exchange_weak(old_size, new_size)) {
+  }
 }
 
 void DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data) {
-  int offset = physical_page_id * PAGE_SIZE;
+  size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
   // check if read beyond file length
-  if (offset >= GetFileSize(file_name_)) {
+  if (offset >= file_size_) {
 #ifdef ENABLE_BPM_DEBUG
     LOG(INFO) << "Read less than a page" << std::endl;
 #endif
     memset(page_data, 0, PAGE_SIZE);
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
+    return;
+  }
+  size_t read_count = 0;
+  while (read_count < PAGE_SIZE) {
+    ssize_t rc = pread(db_fd_, page_data + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc < 0) {
+      LOG(ERROR) << "I/O error while reading: " << strerror(errno);
+      break;
+    }
+    if (rc == 0) {
+      break;  // 文件末尾
+    }
+    read_count += rc;
+  }
+  // if file ends before reading PAGE_SIZE
+  if (read_count < PAGE_SIZE) {
 #ifdef ENABLE_BPM_DEBUG
-      LOG(INFO) << "Read less than a page" << std::endl;
+    LOG(INFO) << "Read less than a page" << std::endl;
 #endif
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
-    }
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
   }
 }
 
 void DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page_data) {
   size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
-  // set write cursor to offset
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG(ERROR) << "I/O error while writing";
-    return;
+  size_t write_count = 0;
+  while (write_count < PAGE_SIZE) {
+    ssize_t rc = pwrite(db_fd_, page_data + write_count, PAGE_SIZE - write_count, offset + write_count);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    // check for I/O error
+    if (rc <= 0) {
+      LOG(ERROR) << "I/O error while writing: " << strerror(errno);
+      return;
+    }
+    write_count += rc;
+  }
+  num_write_calls_++;
+  // 写到文件末尾之后时扩展缓存的文件大小
+  ExtendFileSize(offset + PAGE_SIZE);
+}
+
+void DiskManager::WritePhysicalPages(page_id_t first_physical_page_id, const std::vector<const char *> &pages_data) {
+  size_t offset = static_cast<size_t>(first_physical_page_id) * PAGE_SIZE;
+  std::vector<struct iovec> iov(pages_data.size());
+  for (size_t i = 0; i < pages_data.size(); i++) {
+    iov[i].iov_base = const_cast<char *>(pages_data[i]);
+    iov[i].iov_len = PAGE_SIZE;
+  }
+  // 一次最多提交IOV_MAX个缓冲区，写了一部分时从没写完的位置继续
+  size_t next = 0;
+  size_t written = 0;
+  while (next < iov.size()) {
+    int count = static_cast<int>(std::min(iov.size() - next, static_cast<size_t>(IOV_MAX)));
+    ssize_t rc = pwritev(db_fd_, &iov[next], count, offset + written);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    // check for I/O error
+    if (rc <= 0) {
+      LOG(ERROR) << "I/O error while writing: " << strerror(errno);
+      return;
+    }
+    num_write_calls_++;
+    written += rc;
+    while (next < iov.size() && static_cast<size_t>(rc) >= iov[next].iov_len) {
+      rc -= iov[next].iov_len;
+      next++;
+    }
+    if (rc > 0) {
+      iov[next].iov_base = static_cast<char *>(iov[next].iov_base) + rc;
+      iov[next].iov_len -= rc;
+    }
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
-}
\ No newline at end of file
+  ExtendFileSize(offset + written);
+}
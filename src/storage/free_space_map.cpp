@@ -0,0 +1,218 @@
+#include "storage/free_space_map.h"
+
+FreeSpaceMap::FreeSpaceMap(BufferPoolManager *buffer_pool_manager)
+    : buffer_pool_manager_(buffer_pool_manager), max_tree_(2, 0) {
+  page_id_t page_id;
+  auto *page = buffer_pool_manager_->NewPage(page_id);
+  ASSERT(page != nullptr, "Failed to create the free space map.");
+  reinterpret_cast<FreeSpaceMapPage *>(page->GetData())->Init();
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  fsm_pages_.push_back(page_id);
+}
+
+FreeSpaceMap::FreeSpaceMap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id)
+    : buffer_pool_manager_(buffer_pool_manager), max_tree_(2, 0) {
+  // 把整条链读进内存
+  page_id_t page_id = first_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *page = buffer_pool_manager_->FetchPage(page_id);
+    ASSERT(page != nullptr, "Failed to load the free space map.");
+    auto *fsm_page = reinterpret_cast<FreeSpaceMapPage *>(page->GetData());
+    fsm_pages_.push_back(page_id);
+    for (uint32_t i = 0; i < fsm_page->GetCount(); i++) {
+      AppendEntry(fsm_page->GetHeapPageId(i), fsm_page->GetCategory(i));
+    }
+    page_id_t next_page_id = fsm_page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+page_id_t FreeSpaceMap::FindPage(uint32_t size) {
+  uint32_t category = FreeSpaceMapPage::RequiredCategory(size);
+  std::lock_guard<std::mutex> lock(latch_);
+  if (max_tree_[1] < category || heap_pages_.empty()) {
+    return INVALID_PAGE_ID;
+  }
+  // 从根往下，优先走左子树，找到最靠前的足够大的页
+  size_t node = 1;
+  while (node < capacity_) {
+    node = max_tree_[2 * node] >= category ? 2 * node : 2 * node + 1;
+  }
+  return node - capacity_ < heap_pages_.size() ? heap_pages_[node - capacity_] : INVALID_PAGE_ID;
+}
+
+void FreeSpaceMap::AddPage(page_id_t heap_page_id, uint32_t free_space) {
+  uint8_t category = FreeSpaceMapPage::ToCategory(free_space);
+  std::lock_guard<std::mutex> lock(latch_);
+  AppendEntry(heap_page_id, category);
+
+  // 写入磁盘上的最后一页，满了就在链尾加一页
+  page_id_t last_page_id = fsm_pages_.back();
+  auto *page = buffer_pool_manager_->FetchPage(last_page_id);
+  ASSERT(page != nullptr, "Failed to fetch the free space map.");
+  auto *fsm_page = reinterpret_cast<FreeSpaceMapPage *>(page->GetData());
+  if (!fsm_page->Append(heap_page_id, category)) {
+    page_id_t new_page_id;
+    auto *new_page = buffer_pool_manager_->NewPage(new_page_id);
+    ASSERT(new_page != nullptr, "Failed to extend the free space map.");
+    auto *new_fsm_page = reinterpret_cast<FreeSpaceMapPage *>(new_page->GetData());
+    new_fsm_page->Init();
+    new_fsm_page->Append(heap_page_id, category);
+    fsm_page->SetNextPageId(new_page_id);
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+    fsm_pages_.push_back(new_page_id);
+  }
+  buffer_pool_manager_->UnpinPage(last_page_id, true);
+}
+
+void FreeSpaceMap::UpdatePage(page_id_t heap_page_id, uint32_t free_space) {
+  uint8_t category = FreeSpaceMapPage::ToCategory(free_space);
+  std::lock_guard<std::mutex> lock(latch_);
+  auto it = entry_index_.find(heap_page_id);
+  if (it == entry_index_.end() || categories_[it->second] == category) {
+    return;
+  }
+  size_t index = it->second;
+  SetCategory(index, category);
+
+  // 只有类别变化时才写磁盘上的页
+  page_id_t page_id = fsm_pages_[index / FreeSpaceMapPage::MAX_ENTRIES];
+  auto *page = buffer_pool_manager_->FetchPage(page_id);
+  ASSERT(page != nullptr, "Failed to fetch the free space map.");
+  reinterpret_cast<FreeSpaceMapPage *>(page->GetData())->SetCategory(index % FreeSpaceMapPage::MAX_ENTRIES, category);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
+void FreeSpaceMap::RemovePage(page_id_t heap_page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  auto it = entry_index_.find(heap_page_id);
+  if (it == entry_index_.end()) {
+    return;
+  }
+  size_t index = it->second;
+  entry_index_.erase(it);
+  // 条目先留在原位，Compact时再去掉，其他条目在磁盘上的位置不变
+  SetCategory(index, 0);
+  heap_pages_[index] = INVALID_PAGE_ID;
+  num_removed_++;
+
+  page_id_t page_id = fsm_pages_[index / FreeSpaceMapPage::MAX_ENTRIES];
+  auto *page = buffer_pool_manager_->FetchPage(page_id);
+  ASSERT(page != nullptr, "Failed to fetch the free space map.");
+  auto *fsm_page = reinterpret_cast<FreeSpaceMapPage *>(page->GetData());
+  fsm_page->SetHeapPageId(index % FreeSpaceMapPage::MAX_ENTRIES, INVALID_PAGE_ID);
+  fsm_page->SetCategory(index % FreeSpaceMapPage::MAX_ENTRIES, 0);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
+bool FreeSpaceMap::Contains(page_id_t heap_page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  return entry_index_.count(heap_page_id) > 0;
+}
+
+void FreeSpaceMap::Compact() {
+  std::lock_guard<std::mutex> lock(latch_);
+  std::vector<page_id_t> heap_pages;
+  std::vector<uint8_t> categories;
+  heap_pages.swap(heap_pages_);
+  categories.swap(categories_);
+  entry_index_.clear();
+  num_removed_ = 0;
+  capacity_ = 1;
+  max_tree_.assign(2, 0);
+  for (size_t i = 0; i < heap_pages.size(); i++) {
+    if (heap_pages[i] != INVALID_PAGE_ID) {
+      AppendEntry(heap_pages[i], categories[i]);
+    }
+  }
+
+  // 从第一页开始重写磁盘上的链，多余的页释放掉
+  size_t num_fsm_pages = std::max<size_t>(1, (heap_pages_.size() + FreeSpaceMapPage::MAX_ENTRIES - 1) /
+                                                 FreeSpaceMapPage::MAX_ENTRIES);
+  for (size_t i = num_fsm_pages; i < fsm_pages_.size(); i++) {
+    buffer_pool_manager_->DeletePage(fsm_pages_[i]);
+  }
+  fsm_pages_.resize(std::min(fsm_pages_.size(), num_fsm_pages));
+  for (size_t i = 0; i < fsm_pages_.size(); i++) {
+    auto *page = buffer_pool_manager_->FetchPage(fsm_pages_[i]);
+    ASSERT(page != nullptr, "Failed to fetch the free space map.");
+    auto *fsm_page = reinterpret_cast<FreeSpaceMapPage *>(page->GetData());
+    fsm_page->Init();
+    size_t end = std::min(heap_pages_.size(), (i + 1) * FreeSpaceMapPage::MAX_ENTRIES);
+    for (size_t index = i * FreeSpaceMapPage::MAX_ENTRIES; index < end; index++) {
+      fsm_page->Append(heap_pages_[index], categories_[index]);
+    }
+    fsm_page->SetNextPageId(i + 1 < fsm_pages_.size() ? fsm_pages_[i + 1] : INVALID_PAGE_ID);
+    buffer_pool_manager_->UnpinPage(fsm_pages_[i], true);
+  }
+}
+
+void FreeSpaceMap::Destroy() {
+  std::lock_guard<std::mutex> lock(latch_);
+  for (auto page_id : fsm_pages_) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+}
+
+page_id_t FreeSpaceMap::GetLastHeapPageId() {
+  std::lock_guard<std::mutex> lock(latch_);
+  // 链尾被摘除时，前面最后一个没被摘除的页是新的链尾
+  for (auto it = heap_pages_.rbegin(); it != heap_pages_.rend(); ++it) {
+    if (*it != INVALID_PAGE_ID) {
+      return *it;
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+size_t FreeSpaceMap::GetNumHeapPages() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return heap_pages_.size() - num_removed_;
+}
+
+std::vector<page_id_t> FreeSpaceMap::GetHeapPageIds() {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (num_removed_ == 0) {
+    return heap_pages_;
+  }
+  std::vector<page_id_t> heap_pages;
+  heap_pages.reserve(heap_pages_.size() - num_removed_);
+  for (auto heap_page_id : heap_pages_) {
+    if (heap_page_id != INVALID_PAGE_ID) {
+      heap_pages.push_back(heap_page_id);
+    }
+  }
+  return heap_pages;
+}
+
+void FreeSpaceMap::SetCategory(size_t index, uint8_t category) {
+  categories_[index] = category;
+  size_t node = capacity_ + index;
+  max_tree_[node] = category;
+  for (node /= 2; node >= 1; node /= 2) {
+    max_tree_[node] = std::max(max_tree_[2 * node], max_tree_[2 * node + 1]);
+  }
+}
+
+void FreeSpaceMap::AppendEntry(page_id_t heap_page_id, uint8_t category) {
+  size_t index = heap_pages_.size();
+  // 叶子不够时容量翻倍，重建整棵树
+  if (index >= capacity_) {
+    capacity_ *= 2;
+    max_tree_.assign(2 * capacity_, 0);
+    std::copy(categories_.begin(), categories_.end(), max_tree_.begin() + capacity_);
+    for (size_t node = capacity_ - 1; node >= 1; node--) {
+      max_tree_[node] = std::max(max_tree_[2 * node], max_tree_[2 * node + 1]);
+    }
+  }
+  heap_pages_.push_back(heap_page_id);
+  categories_.push_back(category);
+  // 加载磁盘上的表时可能遇到被摘除的页留下的条目
+  if (heap_page_id != INVALID_PAGE_ID) {
+    entry_index_[heap_page_id] = index;
+  } else {
+    num_removed_++;
+  }
+  SetCategory(index, category);
+}
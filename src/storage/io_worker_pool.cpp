@@ -0,0 +1,43 @@
+#include "storage/io_worker_pool.h"
+
+IOWorkerPool::IOWorkerPool(size_t num_workers) {
+  ASSERT(num_workers > 0, "An I/O worker pool needs at least one worker.");
+  for (size_t i = 0; i < num_workers; i++) {
+    workers_.emplace_back([this] { WorkerLoop(); });
+  }
+}
+
+IOWorkerPool::~IOWorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void IOWorkerPool::Submit(std::function<void()> request) {
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    requests_.push_back(std::move(request));
+  }
+  cv_.notify_one();
+}
+
+void IOWorkerPool::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    cv_.wait(lock, [this] { return stop_ || !requests_.empty(); });
+    // 停止前先处理完已提交的请求
+    if (requests_.empty()) {
+      return;
+    }
+    auto request = std::move(requests_.front());
+    requests_.pop_front();
+    lock.unlock();
+    request();
+    lock.lock();
+  }
+}
@@ -0,0 +1,135 @@
+#include "storage/overflow_store.h"
+
+#include <algorithm>
+
+page_id_t OverflowStore::Write(const char *data, uint32_t len) {
+  page_id_t first_page_id = INVALID_PAGE_ID;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  OverflowPage *prev_page = nullptr;
+  uint32_t offset = 0;
+  // 从前往后逐页写入，前一页在链上下一页之后才放开
+  do {
+    page_id_t page_id;
+    auto *page = buffer_pool_manager_->NewPage(page_id);
+    if (page == nullptr) {
+      if (prev_page != nullptr) {
+        buffer_pool_manager_->UnpinPage(prev_page_id, true);
+      }
+      Free(first_page_id);
+      return INVALID_PAGE_ID;
+    }
+    auto *overflow_page = reinterpret_cast<OverflowPage *>(page->GetData());
+    overflow_page->Init();
+    uint32_t size = std::min(len - offset, OverflowPage::CAPACITY);
+    memcpy(overflow_page->GetData(), data + offset, size);
+    overflow_page->SetSize(size);
+    offset += size;
+    if (prev_page != nullptr) {
+      prev_page->SetNextPageId(page_id);
+      buffer_pool_manager_->UnpinPage(prev_page_id, true);
+    } else {
+      first_page_id = page_id;
+    }
+    prev_page = overflow_page;
+    prev_page_id = page_id;
+  } while (offset < len);
+  buffer_pool_manager_->UnpinPage(prev_page_id, true);
+  return first_page_id;
+}
+
+bool OverflowStore::Read(page_id_t first_page_id, uint32_t len, char *buf) const {
+  reads_++;
+  uint32_t offset = 0;
+  page_id_t page_id = first_page_id;
+  while (offset < len && page_id != INVALID_PAGE_ID) {
+    auto *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      return false;
+    }
+    // 溢出页写入之后不再修改，读的时候不需要加锁
+    auto *overflow_page = reinterpret_cast<const OverflowPage *>(page->GetData());
+    uint32_t size = std::min(len - offset, overflow_page->GetSize());
+    memcpy(buf + offset, overflow_page->GetData(), size);
+    offset += size;
+    page_id_t next_page_id = overflow_page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return offset == len;
+}
+
+void OverflowStore::Free(page_id_t first_page_id) {
+  page_id_t page_id = first_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *page = buffer_pool_manager_->FetchPage(page_id);
+    ASSERT(page != nullptr, "Failed to fetch an overflow page.");
+    page_id_t next_page_id = reinterpret_cast<OverflowPage *>(page->GetData())->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+bool OverflowStore::Toast(const Row &row, Schema *schema, Row *stored) {
+  uint32_t size = row.GetSerializedSize(schema);
+  if (size <= TOAST_ROW_THRESHOLD) {
+    return false;
+  }
+  bool moved = false;
+  while (size > TOAST_ROW_THRESHOLD) {
+    // 每次移出剩下的最大的字符串字段
+    const Row &current = moved ? *stored : row;
+    uint32_t max_idx = 0;
+    uint32_t max_size = sizeof(uint32_t) + sizeof(page_id_t);
+    for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+      Field *field = current.GetField(i);
+      if (field->GetTypeId() == TypeId::kTypeChar && !field->IsNull() && !field->IsExternal() &&
+          field->GetSerializedSize() > max_size) {
+        max_idx = i;
+        max_size = field->GetSerializedSize();
+      }
+    }
+    if (max_size == sizeof(uint32_t) + sizeof(page_id_t)) {
+      break;  // 没有可以移出的字段
+    }
+    Field *field = current.GetField(max_idx);
+    page_id_t page_id = Write(field->GetData(), field->GetLength());
+    if (page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    if (!moved) {
+      *stored = row;
+      moved = true;
+    }
+    Field external(TypeId::kTypeChar, page_id, field->GetLength());
+    size -= max_size - external.GetSerializedSize();
+    stored->SetField(max_idx, external);
+  }
+  return moved;
+}
+
+bool OverflowStore::Detoast(Row *row) const {
+  for (uint32_t i = 0; i < row->GetFieldCount(); i++) {
+    Field *field = row->GetField(i);
+    if (!field->IsExternal()) {
+      continue;
+    }
+    uint32_t len = field->GetLength();
+    auto *data = new char[len];
+    if (!Read(field->GetOverflowPageId(), len, data)) {
+      delete[] data;
+      return false;
+    }
+    row->SetField(i, Field(TypeId::kTypeChar, data, len, false));
+    delete[] data;
+  }
+  return true;
+}
+
+void OverflowStore::FreeFields(const Row &row) {
+  for (size_t i = 0; i < row.GetFieldCount(); i++) {
+    if (row.GetField(i)->IsExternal()) {
+      Free(row.GetField(i)->GetOverflowPageId());
+    }
+  }
+}
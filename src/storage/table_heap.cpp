@@ -1,47 +1,260 @@
 #include "storage/table_heap.h"
 
-bool TableHeap::InsertTuple(Row &row, Txn *txn) { 
+TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
+                     LogManager *log_manager, LockManager *lock_manager, page_id_t free_space_map_page_id)
+    : buffer_pool_manager_(buffer_pool_manager),
+      first_page_id_(first_page_id),
+      schema_(schema),
+      log_manager_(log_manager),
+      lock_manager_(lock_manager),
+      overflow_store_(buffer_pool_manager) {
+    // 每一页都记录了布局，从第一页读出
+    auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+    ASSERT(first_page != nullptr, "Failed to fetch the first table page.");
+    layout_ = first_page->GetLayout();
+    buffer_pool_manager_->UnpinPage(first_page_id_, false);
+    if (free_space_map_page_id != INVALID_PAGE_ID) {
+        free_space_map_ = std::make_unique<FreeSpaceMap>(buffer_pool_manager_, free_space_map_page_id);
+        return;
+    }
+    // 没有空闲空间表时遍历一遍页链表建一个
+    free_space_map_ = std::make_unique<FreeSpaceMap>(buffer_pool_manager_);
     page_id_t page_id = first_page_id_;
-    TablePage *page = nullptr;
+    while (page_id != INVALID_PAGE_ID) {
+        auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+        ASSERT(page != nullptr, "Failed to fetch a table page.");
+        page->RLatch();
+        free_space_map_->AddPage(page_id, page->GetFreeSpaceRemaining());
+        page_id_t next_page_id = page->GetNextPageId();
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        page_id = next_page_id;
+    }
+}
+
+bool TableHeap::HasCurrentFormat(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id) {
+    auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager->FetchPage(first_page_id));
+    if (first_page == nullptr) {
+        return false;
+    }
+    // 旧版本写下的页头格式不同，不能按现在的格式读
+    bool current = first_page->GetFormatVersion() == TablePage::FORMAT_VERSION;
+    buffer_pool_manager->UnpinPage(first_page_id, false);
+    return current;
+}
+
+bool TableHeap::InsertTuple(Row &row, Txn *txn, BufferRing *ring) {
+    // PAX页按声明的列宽存值，超出列宽的行不做溢出处理，直接拒绝
+    if (layout_ == TableLayout::kPax && !PaxPage::CanHold(row, schema_)) {
+        return false;
+    }
+    // 过大的记录先把大字段移到溢出页，插入的是只留指针的副本
+    Row stored;
+    if (overflow_store_.Toast(row, schema_, &stored)) {
+        bool inserted = InsertTuple(stored, txn, ring);
+        if (inserted) {
+            row.SetRowId(stored.GetRowId());
+        } else {
+            overflow_store_.FreeFields(stored);
+        }
+        return inserted;
+    }
+
+    uint32_t size = row.GetSerializedSize(schema_) + TablePage::SIZE_TUPLE;
+    if (size > TablePage::SIZE_MAX_ROW + TablePage::SIZE_TUPLE) {
+        return false;  // 一页都放不下
+    }
 
     while (true) {
-        page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+        // 空闲空间表中足够大的第一页，没有时在链表末尾追加一页
+        page_id_t page_id = free_space_map_->FindPage(size);
+        if (page_id == INVALID_PAGE_ID) {
+            bool tail_moved = false;
+            if (AppendPageAndInsert(row, txn, ring, &tail_moved)) {
+                return true;
+            }
+            if (!tail_moved) {
+                return false;
+            }
+            continue;
+        }
+
+        auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id, ring));
         if (page == nullptr) return false;
-        
         page->WLatch();
-        if (page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_)) {
+        // 加锁之前VACUUM可能已经把这一页摘除了
+        if (!free_space_map_->Contains(page_id)) {
             page->WUnlatch();
-            buffer_pool_manager_->UnpinPage(page_id, true);
+            buffer_pool_manager_->UnpinPage(page_id, false);
+            continue;
+        }
+        bool inserted = page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+        // 不论是否插入成功都更新该页的空闲空间，避免再次选中已满的页
+        free_space_map_->UpdatePage(page_id, page->GetFreeSpaceRemaining());
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(page_id, inserted);
+        if (inserted) {
             return true;
         }
+    }
+}
 
-        page_id_t next_page_id = page->GetNextPageId();
-        if (next_page_id == INVALID_PAGE_ID) {
-            page_id_t new_page_id;
-            TablePage *new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id));
-            if (new_page == nullptr) {
-                page->WUnlatch();
-                buffer_pool_manager_->UnpinPage(page_id, false);
-                return false;
+void TableHeap::InitPage(TablePage *page, page_id_t page_id, page_id_t prev_id, Txn *txn) {
+    if (layout_ == TableLayout::kPax) {
+        reinterpret_cast<PaxPage *>(page)->Init(page_id, prev_id, schema_, log_manager_, txn);
+    } else {
+        page->Init(page_id, prev_id, log_manager_, txn);
+    }
+}
+
+bool TableHeap::AppendPageAndInsert(Row &row, Txn *txn, BufferRing *ring, bool *tail_moved) {
+    page_id_t last_page_id = free_space_map_->GetLastHeapPageId();
+    auto last_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id, ring));
+    if (last_page == nullptr) return false;
+
+    last_page->WLatch();
+    // 其他线程已经追加了新页或VACUUM摘除了末页，由调用者重新查找
+    if (last_page->GetNextPageId() != INVALID_PAGE_ID || !free_space_map_->Contains(last_page_id)) {
+        *tail_moved = true;
+        last_page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(last_page_id, false);
+        return false;
+    }
+    page_id_t new_page_id;
+    auto new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id, ring));
+    if (new_page == nullptr) {
+        last_page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(last_page_id, false);
+        return false;
+    }
+    new_page->WLatch();
+    InitPage(new_page, new_page_id, last_page_id, txn);
+    bool inserted = new_page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+    last_page->SetNextPageId(new_page_id);
+    // 持有末页的latch时登记新页，等待末页的线程之后一定能看到它
+    free_space_map_->AddPage(new_page_id, new_page->GetFreeSpaceRemaining());
+    new_page->WUnlatch();
+    last_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+    buffer_pool_manager_->UnpinPage(last_page_id, true);
+    return inserted;
+}
+
+size_t TableHeap::InsertTuples(std::vector<Row> &rows, Txn *txn, BufferRing *ring) {
+    // 有过大的记录时插入一份把大字段移到溢出页之后的副本
+    std::vector<Row> stored_rows;
+    for (size_t i = 0; i < rows.size(); i++) {
+        // PAX页放不下的行及其之后的行都不插入，和InsertTuple一样在溢出处理之前检查
+        if (layout_ == TableLayout::kPax && !PaxPage::CanHold(rows[i], schema_)) {
+            break;
+        }
+        Row stored;
+        if (overflow_store_.Toast(rows[i], schema_, &stored)) {
+            if (stored_rows.empty()) {
+                stored_rows.assign(rows.begin(), rows.begin() + i);
+            }
+            stored_rows.push_back(stored);
+        } else if (!stored_rows.empty()) {
+            stored_rows.push_back(rows[i]);
+        }
+    }
+    if (!stored_rows.empty()) {
+        size_t inserted = InsertTuples(stored_rows, txn, ring);
+        for (size_t i = 0; i < stored_rows.size(); i++) {
+            if (i < inserted) {
+                rows[i].SetRowId(stored_rows[i].GetRowId());
+            } else {
+                overflow_store_.FreeFields(stored_rows[i]);
             }
+        }
+        return inserted;
+    }
 
-            new_page->WLatch();
-            new_page->Init(new_page_id, page_id, log_manager_, txn);
-            page->SetNextPageId(new_page_id);
+    size_t inserted = 0;
+    while (inserted < rows.size()) {
+        uint32_t size = rows[inserted].GetSerializedSize(schema_) + TablePage::SIZE_TUPLE;
+        if (size > TablePage::SIZE_MAX_ROW + TablePage::SIZE_TUPLE ||
+            (layout_ == TableLayout::kPax && !PaxPage::CanHold(rows[inserted], schema_))) {
+            break;  // 一页都放不下
+        }
 
+        // 先填已有空闲空间的页，一次pin和latch尽量多放几行
+        page_id_t page_id = free_space_map_->FindPage(size);
+        if (page_id != INVALID_PAGE_ID) {
+            auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id, ring));
+            if (page == nullptr) break;
+            page->WLatch();
+            if (!free_space_map_->Contains(page_id)) {
+                page->WUnlatch();
+                buffer_pool_manager_->UnpinPage(page_id, false);
+                continue;
+            }
+            size_t count = FillPage(page, rows, inserted, txn);
+            free_space_map_->UpdatePage(page_id, page->GetFreeSpaceRemaining());
             page->WUnlatch();
-            buffer_pool_manager_->UnpinPage(page_id, true);
-
-            page_id = new_page_id;
-            new_page->WUnlatch();
-            buffer_pool_manager_->UnpinPage(page_id, true);
+            buffer_pool_manager_->UnpinPage(page_id, count > 0);
+            inserted += count;
             continue;
         }
 
-        page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(page_id, false);
-        page_id = next_page_id;
+        // 没有足够空间的页，剩下的行都追加到新页
+        bool tail_moved = false;
+        size_t count = AppendPagesAndInsert(rows, inserted, txn, ring, &tail_moved);
+        inserted += count;
+        if (count == 0 && !tail_moved) {
+            break;
+        }
+    }
+    return inserted;
+}
+
+size_t TableHeap::FillPage(TablePage *page, std::vector<Row> &rows, size_t begin, Txn *txn) {
+    size_t i = begin;
+    while (i < rows.size() && page->InsertTuple(rows[i], schema_, txn, lock_manager_, log_manager_)) {
+        i++;
+    }
+    return i - begin;
+}
+
+size_t TableHeap::AppendPagesAndInsert(std::vector<Row> &rows, size_t begin, Txn *txn, BufferRing *ring,
+                                       bool *tail_moved) {
+    page_id_t tail_page_id = free_space_map_->GetLastHeapPageId();
+    auto tail_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(tail_page_id, ring));
+    if (tail_page == nullptr) return 0;
+
+    tail_page->WLatch();
+    // 其他线程已经追加了新页或VACUUM摘除了末页，由调用者重新查找
+    if (tail_page->GetNextPageId() != INVALID_PAGE_ID || !free_space_map_->Contains(tail_page_id)) {
+        *tail_moved = true;
+        tail_page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(tail_page_id, false);
+        return 0;
+    }
+    size_t i = begin;
+    bool tail_dirty = false;
+    while (i < rows.size()) {
+        page_id_t new_page_id;
+        auto new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id, ring));
+        if (new_page == nullptr) break;
+        new_page->WLatch();
+        InitPage(new_page, new_page_id, tail_page_id, txn);
+        size_t count = FillPage(new_page, rows, i, txn);
+        i += count;
+        tail_page->SetNextPageId(new_page_id);
+        free_space_map_->AddPage(new_page_id, new_page->GetFreeSpaceRemaining());
+        // 新页链上之后才放开旧的末页，等待末页的线程一定能看到新页
+        tail_page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(tail_page_id, true);
+        tail_page_id = new_page_id;
+        tail_page = new_page;
+        tail_dirty = true;
+        if (count == 0) {
+            break;  // 空页也放不下这一行
+        }
     }
+    tail_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(tail_page_id, tail_dirty);
+    return i - begin;
 }
 
 bool TableHeap::MarkDelete(const RowId &rid, Txn *txn) {
@@ -58,8 +271,15 @@ bool TableHeap::MarkDelete(const RowId &rid, Txn *txn) {
 }
 
 bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Txn *txn) {
+    if (layout_ == TableLayout::kPax && !PaxPage::CanHold(row, schema_)) {
+        return false;
+    }
+    Row stored;
+    bool toasted = overflow_store_.Toast(row, schema_, &stored);
+    Row &new_row = toasted ? stored : row;
     TablePage *page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
     if (page == nullptr) {
+        overflow_store_.FreeFields(stored);
         return false;
     }
 
@@ -68,12 +288,18 @@ bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Txn *txn) {
     if (!page->GetTuple(&old_row, schema_, txn, lock_manager_)) {
         page->WUnlatch();
         buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+        overflow_store_.FreeFields(stored);
         return false;
     }
 
-    bool updated = page->UpdateTuple(row, &old_row, schema_, txn, lock_manager_, log_manager_);
+    bool updated = page->UpdateTuple(new_row, &old_row, schema_, txn, lock_manager_, log_manager_);
+    if (updated) {
+        free_space_map_->UpdatePage(rid.GetPageId(), page->GetFreeSpaceRemaining());
+    }
     page->WUnlatch();
     buffer_pool_manager_->UnpinPage(rid.GetPageId(), updated);
+    // 旧记录的溢出页不再被引用，更新失败时释放新写的溢出页
+    overflow_store_.FreeFields(updated ? old_row : stored);
     return updated;
 }
 
@@ -82,7 +308,13 @@ void TableHeap::ApplyDelete(const RowId &rid, Txn *txn) {
     if (page == nullptr) return;
 
     page->WLatch();
+    // 元组真正删除之前释放它的溢出页
+    RowView view;
+    if (page->GetTupleView(rid, schema_, &view, nullptr, true)) {
+        FreeOverflowPages(view);
+    }
     page->ApplyDelete(rid, txn, log_manager_);
+    free_space_map_->UpdatePage(rid.GetPageId(), page->GetFreeSpaceRemaining());
     page->WUnlatch();
     buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
 }
@@ -104,38 +336,125 @@ bool TableHeap::GetTuple(Row *row, Txn *txn) {
     bool found = page->GetTuple(row, schema_, txn, lock_manager_);
     page->RUnlatch();
     buffer_pool_manager_->UnpinPage(row->GetRowId().GetPageId(), false);
-    return found;
+    // 溢出页中的字段读回记录
+    return found && overflow_store_.Detoast(row);
+}
+
+size_t TableHeap::Vacuum(double min_dead_ratio, size_t *pages_freed) {
+    // 上一次摘除时还被固定的页，现在再试着释放
+    std::vector<page_id_t> still_pinned;
+    for (auto unlinked_page_id : unlinked_pages_) {
+        if (!buffer_pool_manager_->DeletePage(unlinked_page_id)) {
+            still_pinned.push_back(unlinked_page_id);
+        }
+    }
+    unlinked_pages_.swap(still_pinned);
+
+    size_t removed = 0;
+    size_t freed = 0;
+    // 前一页一直保持固定和加锁，摘除当前页时修改它的后继
+    TablePage *prev_page = nullptr;
+    bool prev_dirty = false;
+    page_id_t page_id = first_page_id_;
+    while (page_id != INVALID_PAGE_ID) {
+        auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+        ASSERT(page != nullptr, "Failed to fetch a table page.");
+        page->WLatch();
+        bool dirty = false;
+        if (prev_page != nullptr && page->GetPrevPageId() != prev_page->GetTablePageId()) {
+            page->SetPrevPageId(prev_page->GetTablePageId());  // 前驱已被摘除
+            dirty = true;
+        }
+        uint32_t deleted_space = page->GetDeletedTupleSpace();
+        if (deleted_space > 0 && deleted_space >= min_dead_ratio * page->GetTupleSpace()) {
+            FreeOverflowPages(page, true);
+            removed += page->Compact();
+            dirty = true;
+        }
+        page_id_t next_page_id = page->GetNextPageId();
+
+        if (page->IsEmpty() && prev_page != nullptr) {
+            // 摘除之前先从空闲空间表中去掉，插入的线程在页锁下检查，不会再往这一页插入
+            free_space_map_->RemovePage(page_id);
+            prev_page->SetNextPageId(next_page_id);
+            prev_dirty = true;
+            page->WUnlatch();
+            buffer_pool_manager_->UnpinPage(page_id, dirty);
+            // 其他线程（如迭代器）还固定着这一页时不能释放，留到下一次VACUUM
+            if (!buffer_pool_manager_->DeletePage(page_id)) {
+                unlinked_pages_.push_back(page_id);
+            }
+            freed++;
+        } else {
+            free_space_map_->UpdatePage(page_id, page->GetFreeSpaceRemaining());
+            if (prev_page != nullptr) {
+                prev_page->WUnlatch();
+                buffer_pool_manager_->UnpinPage(prev_page->GetTablePageId(), prev_dirty);
+            }
+            prev_page = page;
+            prev_dirty = dirty;
+        }
+        page_id = next_page_id;
+    }
+    if (prev_page != nullptr) {
+        prev_page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(prev_page->GetTablePageId(), prev_dirty);
+    }
+
+    // 有页被摘除时去掉空闲空间表中它们的条目
+    if (freed > 0) {
+        free_space_map_->Compact();
+    }
+    if (pages_freed != nullptr) {
+        *pages_freed = freed;
+    }
+    return removed;
 }
 
 void TableHeap::DeleteTable(page_id_t page_id) {
     if (page_id != INVALID_PAGE_ID) {
         auto temp_table_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+        FreeOverflowPages(temp_table_page, false);
         if (temp_table_page->GetNextPageId() != INVALID_PAGE_ID) {
             DeleteTable(temp_table_page->GetNextPageId());
         }
         buffer_pool_manager_->UnpinPage(page_id, false);
         buffer_pool_manager_->DeletePage(page_id);
     } else {
+        free_space_map_->Destroy();
+        for (auto unlinked_page_id : unlinked_pages_) {
+            buffer_pool_manager_->DeletePage(unlinked_page_id);
+        }
+        unlinked_pages_.clear();
         DeleteTable(first_page_id_);
     }
 }
 
-TableIterator TableHeap::Begin(Txn *txn) { 
-    RowId first_rid;
-    TablePage *first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-    
-    if (first_page != nullptr) {
-        first_page->RLatch();
-        bool found = first_page->GetFirstTupleRid(&first_rid);
-        first_page->RUnlatch();
-        buffer_pool_manager_->UnpinPage(first_page_id_, false);
-        
-        if (!found) {
-            first_rid = RowId(INVALID_PAGE_ID, -1);
+void TableHeap::FreeOverflowPages(TablePage *page, bool deleted_only) {
+    std::vector<RowView> views;
+    uint32_t count = page->GetDeletedTupleViews(schema_, &views);
+    for (uint32_t i = 0; i < count; i++) {
+        FreeOverflowPages(views[i]);
+    }
+    if (!deleted_only) {
+        count = page->GetTupleViews(schema_, 0, &views);
+        for (uint32_t i = 0; i < count; i++) {
+            FreeOverflowPages(views[i]);
         }
     }
-    
-    return TableIterator(this, first_rid, txn);
+}
+
+void TableHeap::FreeOverflowPages(const RowView &view) {
+    for (uint32_t i = 0; i < view.GetFieldCount(); i++) {
+        if (view.IsExternal(i)) {
+            overflow_store_.Free(view.GetOverflowPageId(i));
+        }
+    }
+}
+
+TableIterator TableHeap::Begin(Txn *txn, std::shared_ptr<BufferRing> ring) {
+    // 迭代器会跳过没有记录的页
+    return TableIterator(this, RowId(first_page_id_, 0), txn, std::move(ring));
 }
 
 TableIterator TableHeap::End() {  
@@ -3,35 +3,96 @@
 #include "common/macros.h"
 #include "storage/table_heap.h"
 
+static page_id_t NextTablePageId(Page *page) { return reinterpret_cast<TablePage *>(page)->GetNextPageId(); }
+
 /**
  * TODO: Student Implement
  */
-// 构造函数：初始化迭代器时检查是否需要加载数据
-TableIterator::TableIterator(TableHeap *table_heap, RowId rid, Txn *txn) 
-  : table_heap_(table_heap), rid_(rid), txn_(txn) {
-  if (rid_.GetPageId() != INVALID_PAGE_ID) {
-    row_ = new Row(rid_);
-    if (!table_heap_->GetTuple(row_, txn_)) {
-      delete row_;
-      row_ = nullptr;
-      rid_ = RowId(INVALID_PAGE_ID, -1);  // 设置无效RowId
-    }
-  } else {
-    row_ = nullptr;
+// 构造函数：从rid开始找到第一条有效记录，固定其所在的页
+TableIterator::TableIterator(TableHeap *table_heap, RowId rid, Txn *txn, std::shared_ptr<BufferRing> ring)
+    : table_heap_(table_heap),
+      rid_(INVALID_PAGE_ID, -1),
+      txn_(txn),
+      page_(nullptr),
+      num_views_(0),
+      cursor_(0),
+      mod_count_(0),
+      ring_(ring),
+      read_ahead_(table_heap != nullptr ? table_heap->buffer_pool_manager_ : nullptr, NextTablePageId,
+                  std::move(ring)) {
+  if (rid.GetPageId() != INVALID_PAGE_ID) {
+    SeekFrom(rid.GetPageId(), rid.GetSlotNum());
   }
 }
 
 // 复制构造函数
-TableIterator::TableIterator(const TableIterator &other) {
-  if (other.row_ != nullptr) {
-    row_ = new Row(*other.row_);
-  } else {
-    row_ = nullptr;
-  }
+TableIterator::TableIterator(const TableIterator &other)
+    : table_heap_(other.table_heap_),
+      rid_(other.rid_),
+      txn_(other.txn_),
+      page_(other.page_),
+      views_(other.views_),
+      num_views_(other.num_views_),
+      cursor_(other.cursor_),
+      mod_count_(other.mod_count_),
+      row_(other.row_),
+      row_loaded_(other.row_loaded_),
+      ring_(other.ring_),
+      read_ahead_(other.read_ahead_) {
+  PinPage();
 }
 
 TableIterator::~TableIterator() {
-  delete row_;
+  ReleasePage();
+}
+
+void TableIterator::SeekFrom(page_id_t page_id, uint32_t begin_slot) {
+  BufferPoolManager *bpm = table_heap_->buffer_pool_manager_;
+  while (page_id != INVALID_PAGE_ID) {
+    if (page_ == nullptr || page_->GetPageId() != page_id) {
+      ReleasePage();
+      page_ = reinterpret_cast<TablePage *>(bpm->FetchPage(page_id, ring_.get()));
+      if (page_ == nullptr) {
+        break;
+      }
+      read_ahead_.Advance(page_id);
+    }
+    // 一次加锁取得整页的有效记录
+    page_->RLatch();
+    LoadViews(begin_slot);
+    page_id = page_->GetNextPageId();
+    page_->RUnlatch();
+    if (num_views_ > 0) {
+      rid_ = views_[0].GetRowId();
+      return;
+    }
+    begin_slot = 0;
+  }
+  // 已经到达链表末尾
+  ReleasePage();
+  num_views_ = 0;
+  cursor_ = 0;
+  rid_ = RowId(INVALID_PAGE_ID, -1);
+}
+
+void TableIterator::LoadViews(uint32_t begin_slot) {
+  num_views_ = page_->GetTupleViews(table_heap_->schema_, begin_slot, &views_, &table_heap_->overflow_store_);
+  cursor_ = 0;
+  mod_count_ = page_->GetModCount();
+}
+
+void TableIterator::PinPage() {
+  if (page_ != nullptr) {
+    // 页已被另一个迭代器固定，这里只是增加引用计数
+    table_heap_->buffer_pool_manager_->FetchPage(page_->GetPageId());
+  }
+}
+
+void TableIterator::ReleasePage() {
+  if (page_ != nullptr) {
+    table_heap_->buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+    page_ = nullptr;
+  }
 }
 
 bool TableIterator::operator==(const TableIterator &itr) const {
@@ -44,67 +105,109 @@ bool TableIterator::operator!=(const TableIterator &itr) const {
 }
 
 const Row &TableIterator::operator*() {
-  ASSERT(row_ != nullptr, "Dereferencing invalid iterator");
-  return *row_;  // 返回指向当前记录的引用
+  return *operator->();
 }
 
 Row *TableIterator::operator->() {
-  ASSERT(row_ != nullptr, "Dereferencing invalid iterator");
-  return row_;  // 返回当前记录的指针
+  ASSERT(page_ != nullptr, "Dereferencing invalid iterator");
+  if (!row_loaded_) {
+    // 第一次访问时才反序列化，按rid重新读取以防页内元组被移动过；复用上一条记录的缓冲区
+    row_.SetRowId(rid_);
+    page_->RLatch();
+    page_->GetTuple(&row_, table_heap_->schema_, txn_, table_heap_->lock_manager_);
+    page_->RUnlatch();
+    table_heap_->overflow_store_.Detoast(&row_);
+    row_loaded_ = true;
+  }
+  return &row_;  // 返回当前记录的指针
+}
+
+const RowView *TableIterator::GetPageRowViews(size_t *count) {
+  ASSERT(page_ != nullptr, "Dereferencing invalid iterator");
+  page_->RLatch();
+  if (page_->GetModCount() != mod_count_) {
+    LoadViews(rid_.GetSlotNum());
+    if (num_views_ > 0) {
+      rid_ = views_[0].GetRowId();  // 当前记录已被删除时从下一条开始
+    }
+  }
+  page_->RUnlatch();
+  *count = num_views_ - cursor_;
+  return views_.data() + cursor_;
+}
+
+bool TableIterator::RLatchPage() {
+  ASSERT(page_ != nullptr, "Dereferencing invalid iterator");
+  page_->RLatch();
+  if (page_->GetModCount() != mod_count_) {
+    // 取得视图之后页被修改过，从当前记录起重新取得
+    row_loaded_ = false;
+    LoadViews(rid_.GetSlotNum());
+    if (num_views_ > 0) {
+      rid_ = views_[0].GetRowId();  // 当前记录已被删除时从下一条开始
+    }
+  }
+  return cursor_ < num_views_;
+}
+
+void TableIterator::RUnlatchPage() {
+  page_->RUnlatch();
+}
+
+TableIterator &TableIterator::NextPage() {
+  if (page_ == nullptr) {
+    return *this;
+  }
+  row_loaded_ = false;
+  page_->RLatch();
+  page_id_t next_page_id = page_->GetNextPageId();
+  page_->RUnlatch();
+  SeekFrom(next_page_id, 0);
+  return *this;
 }
 
 TableIterator &TableIterator::operator=(const TableIterator &itr) noexcept {
   if (this != &itr) {
-    delete row_;  // 删除当前的row对象
+    ReleasePage();
     table_heap_ = itr.table_heap_;
     rid_ = itr.rid_;
     txn_ = itr.txn_;
-    if (itr.row_ != nullptr) {
-      row_ = new Row(*itr.row_);
-    } else {
-      row_ = nullptr;
-    }
+    page_ = itr.page_;
+    views_ = itr.views_;
+    num_views_ = itr.num_views_;
+    cursor_ = itr.cursor_;
+    mod_count_ = itr.mod_count_;
+    ring_ = itr.ring_;
+    read_ahead_ = itr.read_ahead_;
+    PinPage();
+    row_ = itr.row_;
+    row_loaded_ = itr.row_loaded_;
   }
   return *this;
 }
 
 // ++iter
 TableIterator &TableIterator::operator++() {
-  if (rid_.GetPageId() == INVALID_PAGE_ID) {
+  if (page_ == nullptr) {
     return *this;  // 如果当前是无效的RowId，则不移动
   }
+  row_loaded_ = false;
 
-  TablePage *page = reinterpret_cast<TablePage *>(
-      table_heap_->buffer_pool_manager_->FetchPage(rid_.GetPageId()));  // 获取当前页
-  if (page == nullptr) {
-    rid_ = RowId(INVALID_PAGE_ID, -1);  // 无效RowId
-    delete row_;
-    row_ = nullptr;
-    return *this;
-  }
-
-  page->RLatch();  // 加锁
-  RowId next_rid;  // 下一个记录的RowId
-  if (!page->GetNextTupleRid(rid_, &next_rid)) {
-    page->RUnlatch();
-    table_heap_->buffer_pool_manager_->UnpinPage(rid_.GetPageId(), false);  // 解锁
-    rid_ = RowId(INVALID_PAGE_ID, -1);  // 当前页没有下一条记录，标记为无效
+  page_->RLatch();
+  if (page_->GetModCount() != mod_count_) {
+    // 页被修改过，后面的元组可能已被移动，重新取得它们的视图
+    LoadViews(rid_.GetSlotNum() + 1);
   } else {
-    rid_ = next_rid;  // 移动到下一条记录
-    delete row_;
-    row_ = nullptr;
+    cursor_++;
   }
-
-  // 加载下一条记录
-  if (rid_.GetPageId() != INVALID_PAGE_ID) {
-    row_ = new Row(rid_);
-    if (!table_heap_->GetTuple(row_, txn_)) {
-      delete row_;
-      row_ = nullptr;
-      rid_ = RowId(INVALID_PAGE_ID, -1);  // 如果没有找到记录，标记为无效
-    }
+  page_id_t next_page_id = page_->GetNextPageId();
+  page_->RUnlatch();
+  if (cursor_ < num_views_) {
+    rid_ = views_[cursor_].GetRowId();
+  } else {
+    // 当前页已经遍历完，沿着链表找到下一个有记录的页
+    SeekFrom(next_page_id, 0);
   }
-
   return *this;
 }
 
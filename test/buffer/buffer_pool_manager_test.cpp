@@ -1,9 +1,15 @@
 #include "buffer/buffer_pool_manager.h"
 
+#include <chrono>
+#include <climits>
 #include <cstdio>
+#include <map>
 #include <random>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include "glog/logging.h"
 #include "gtest/gtest.h"
 
 TEST(BufferPoolManagerTest, BinaryDataTest) {
@@ -66,9 +72,541 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
   EXPECT_EQ(true, bpm->UnpinPage(0, true));
 
   // Shutdown the disk manager and remove the temporary file we created.
+  delete bpm;
   disk_manager->Close();
   remove(db_name.c_str());
 
+  delete disk_manager;
+}
+
+TEST(BufferPoolManagerTest, ShardedInstanceTest) {
+  const std::string db_name = "bpm_sharded_test.db";
+  const size_t buffer_pool_size = 16;
+  const size_t num_instances = 4;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, num_instances);
+  ASSERT_EQ(num_instances, bpm->GetNumInstances());
+
+  // Scenario: sequential page ids are spread over the instances, so the whole pool can be filled.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page_id_temp);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(page_id_temp));
+
+  // Scenario: a failed NewPage gives the page id back, so the next allocation reuses it.
+  EXPECT_TRUE(bpm->IsPageFree(buffer_pool_size));
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(i, true));
+  }
+  ASSERT_NE(nullptr, bpm->NewPage(page_id_temp));
+  EXPECT_EQ(buffer_pool_size, page_id_temp);
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+
+  // Scenario: evicted pages come back with the content written before.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(i), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+
+  // Scenario: a deleted page frees its frame in its own instance.
+  EXPECT_FALSE(bpm->IsPageFree(3));
+  EXPECT_TRUE(bpm->DeletePage(3));
+  EXPECT_TRUE(bpm->IsPageFree(3));
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
   delete bpm;
+  disk_manager->Close();
+  remove(db_name.c_str());
+
+  delete disk_manager;
+}
+
+/**
+ * Measure FetchPage/UnpinPage throughput of a single partition versus a sharded pool, with all pages resident.
+ */
+TEST(BufferPoolManagerTest, ConcurrentFetchScalingTest) {
+  const std::string db_name = "bpm_scaling_test.db";
+  const size_t buffer_pool_size = 1024;
+  const size_t fetches_per_thread = 100000;
+  const size_t max_threads = std::max(4u, std::thread::hardware_concurrency());
+
+  for (size_t num_instances : {static_cast<size_t>(1), static_cast<size_t>(DEFAULT_BUFFER_POOL_INSTANCES)}) {
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, num_instances);
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      auto *page = bpm->NewPage(page_id_temp);
+      ASSERT_NE(nullptr, page);
+      memcpy(page->GetData(), &page_id_temp, sizeof(page_id_t));
+      bpm->UnpinPage(page_id_temp, true);
+    }
+
+    for (size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+      std::vector<std::thread> threads;
+      std::atomic<size_t> errors{0};
+      auto start = std::chrono::steady_clock::now();
+      for (size_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+          std::default_random_engine rng(t);
+          std::uniform_int_distribution<page_id_t> dist(0, buffer_pool_size - 1);
+          for (size_t i = 0; i < fetches_per_thread; ++i) {
+            page_id_t page_id = dist(rng);
+            auto *page = bpm->FetchPage(page_id);
+            if (page == nullptr || *reinterpret_cast<page_id_t *>(page->GetData()) != page_id) {
+              errors++;
+              continue;
+            }
+            bpm->UnpinPage(page_id, false);
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      ASSERT_EQ(0, errors.load());
+      LOG(INFO) << "instances: " << num_instances << ", threads: " << num_threads
+                << ", fetches/sec: " << static_cast<size_t>(num_threads * fetches_per_thread / elapsed);
+    }
+    EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+    delete bpm;
+    disk_manager->Close();
+    remove(db_name.c_str());
+    delete disk_manager;
+  }
+}
+
+TEST(BufferPoolManagerTest, BackgroundWriterTest) {
+  const std::string db_name = "bpm_bg_writer_test.db";
+  const size_t buffer_pool_size = 32;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: cleaning half of the pool writes back the oldest dirty pages, which are also the next victims.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  EXPECT_EQ(buffer_pool_size / 2, bpm->CleanPages(0.5));
+  EXPECT_EQ(0, bpm->CleanPages(0.5));
+  EXPECT_EQ(buffer_pool_size / 2, bpm->GetBackgroundWrites());
+
+  // Scenario: eviction takes the clean frames first and never writes on the caller's thread.
+  for (size_t i = 0; i < buffer_pool_size / 2; ++i) {
+    auto *page = bpm->NewPage(page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  EXPECT_EQ(0, bpm->GetForegroundWrites());
+
+  // Scenario: the background writer keeps up with dirty pages, and every page survives eviction.
+  bpm->StartBackgroundWriter(1.0, 1);
+  for (int retry = 0; retry < 1000 && bpm->CleanPages(1.0) != 0; ++retry) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  size_t foreground_writes = bpm->GetForegroundWrites();
+  for (size_t i = 0; i < buffer_pool_size * 3 / 2; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(i), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(foreground_writes, bpm->GetForegroundWrites());
+  bpm->StopBackgroundWriter();
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  disk_manager->Close();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+/**
+ * Threads keep updating pages of a working set larger than the pool while the background writer runs, so pages are
+ * cleaned, re-dirtied and evicted concurrently. No update may be lost.
+ */
+TEST(BufferPoolManagerTest, BackgroundWriterConcurrentTest) {
+  const std::string db_name = "bpm_bg_writer_concurrent_test.db";
+  const size_t buffer_pool_size = 64;
+  const size_t num_pages = 256;
+  const size_t num_threads = 4;
+  const size_t updates_per_thread = 20000;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 4);
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < num_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id_temp));
+    bpm->UnpinPage(page_id_temp, true);
+  }
+
+  bpm->StartBackgroundWriter(0.5, 1);
+  std::vector<std::thread> threads;
+  std::vector<std::vector<uint32_t>> expected(num_threads, std::vector<uint32_t>(num_pages / num_threads, 0));
+  auto start = std::chrono::steady_clock::now();
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      // 每个线程只修改自己的页，page_id % num_threads == t
+      std::default_random_engine rng(t);
+      std::uniform_int_distribution<size_t> dist(0, num_pages / num_threads - 1);
+      for (size_t i = 0; i < updates_per_thread; ++i) {
+        size_t slot = dist(rng);
+        auto page_id = static_cast<page_id_t>(slot * num_threads + t);
+        auto *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        (*reinterpret_cast<uint32_t *>(page->GetData()))++;
+        expected[t][slot]++;
+        bpm->UnpinPage(page_id, true);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  bpm->StopBackgroundWriter();
+  LOG(INFO) << "updates/sec: " << static_cast<size_t>(num_threads * updates_per_thread / elapsed)
+            << ", foreground writes: " << bpm->GetForegroundWrites()
+            << ", background writes: " << bpm->GetBackgroundWrites();
+
+  for (size_t i = 0; i < num_pages; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(expected[i % num_threads][i / num_threads], *reinterpret_cast<uint32_t *>(page->GetData()));
+    bpm->UnpinPage(i, false);
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  disk_manager->Close();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+TEST(BufferPoolManagerTest, PrefetchPagesTest) {
+  const std::string db_name = "bpm_prefetch_test.db";
+  const size_t buffer_pool_size = 16;
+  const size_t num_pages = 64;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 2);
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id_temp);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+
+  // Scenario: TryFetchPage only returns resident pages.
+  EXPECT_EQ(nullptr, bpm->TryFetchPage(0));
+  auto *page = bpm->TryFetchPage(num_pages - 1);
+  ASSERT_NE(nullptr, page);
+  EXPECT_TRUE(bpm->UnpinPage(num_pages - 1, false));
+
+  // Scenario: prefetched pages become resident without being pinned, and keep their content.
+  std::vector<page_id_t> page_ids{0, 1, 2, 3};
+  bpm->PrefetchPages(page_ids);
+  for (int retry = 0; retry < 1000 && bpm->GetPrefetchedPages() < page_ids.size(); ++retry) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(page_ids.size(), bpm->GetPrefetchedPages());
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  for (auto page_id : page_ids) {
+    page = bpm->TryFetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: a page id which was freed and prefetched again can be handed out by NewPage.
+  EXPECT_TRUE(bpm->DeletePage(3));
+  bpm->PrefetchPages({3});
+  for (int retry = 0; retry < 1000 && bpm->GetPrefetchedPages() < page_ids.size() + 1; ++retry) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  page = bpm->NewPage(page_id_temp);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(3, page_id_temp);
+  EXPECT_EQ(0, page->GetData()[0]);
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+
+  delete bpm;
+  disk_manager->Close();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+static page_id_t NextChainPageId(Page *page) { return *reinterpret_cast<page_id_t *>(page->GetData()); }
+
+/**
+ * The prefetcher follows a chain of pages none of which is resident, reading the id of each page from the one before.
+ */
+TEST(BufferPoolManagerTest, PrefetchChainTest) {
+  const std::string db_name = "bpm_prefetch_chain_test.db";
+  const size_t buffer_pool_size = 16;
+  const page_id_t num_pages = 64;
+  const size_t chain_length = 8;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 2);
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(page_id_temp);
+    ASSERT_NE(nullptr, page);
+    *reinterpret_cast<page_id_t *>(page->GetData()) = i + 1 < num_pages ? i + 1 : INVALID_PAGE_ID;
+    bpm->UnpinPage(page_id_temp, true);
+  }
+  EXPECT_EQ(nullptr, bpm->TryFetchPage(0));
+
+  bpm->PrefetchChain(0, chain_length, NextChainPageId);
+  for (int retry = 0; retry < 1000 && bpm->GetPrefetchedPages() < chain_length; ++retry) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(chain_length, bpm->GetPrefetchedPages());
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(chain_length); ++page_id) {
+    auto *page = bpm->TryFetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id + 1, NextChainPageId(page));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(nullptr, bpm->TryFetchPage(chain_length));
+
+  delete bpm;
+  disk_manager->Close();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+/**
+ * Point lookups on a small hot set of pages mixed with full scans of a table four times the pool size, where the scan
+ * fetches every page once per tuple. Reports the hit rate of the lookups and of all fetches for every policy.
+ */
+TEST(BufferPoolManagerTest, ReplacerHitRateTest) {
+  const std::string db_name = "bpm_replacer_test.db";
+  const size_t buffer_pool_size = 512;
+  const size_t hot_pages = 300;
+  const size_t table_pages = buffer_pool_size * 4;
+  const size_t tuples_per_page = 20;
+  const size_t lookups_per_page = 1;
+  const size_t num_scans = 3;
+
+  std::vector<std::pair<std::string, ReplacerType>> policies{{"LRU", ReplacerType::kLRU},
+                                                             {"LRU-K", ReplacerType::kLRUK},
+                                                             {"2Q", ReplacerType::kTwoQueue},
+                                                             {"CLOCK", ReplacerType::kClock}};
+  std::map<ReplacerType, double> lookup_hit_rates;
+  for (auto &policy : policies) {
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 4, policy.second);
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < hot_pages + table_pages; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(page_id_temp));
+      bpm->UnpinPage(page_id_temp, true);
+    }
+
+    std::default_random_engine rng(0);
+    std::uniform_int_distribution<page_id_t> hot_dist(0, hot_pages - 1);
+    size_t lookups = 0;
+    size_t lookup_hits = 0;
+    auto lookup = [&]() {
+      page_id_t page_id = hot_dist(rng);
+      if (bpm->TryFetchPage(page_id) != nullptr) {
+        lookup_hits++;
+        bpm->UnpinPage(page_id, false);
+      }
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      bpm->UnpinPage(page_id, false);
+      lookups++;
+    };
+    // Warm up the hot set, then scan while lookups keep going
+    for (size_t i = 0; i < hot_pages * 4; ++i) {
+      lookup();
+    }
+    for (size_t scan = 0; scan < num_scans; ++scan) {
+      for (size_t i = 0; i < table_pages; ++i) {
+        auto page_id = static_cast<page_id_t>(hot_pages + i);
+        for (size_t j = 0; j < tuples_per_page; ++j) {
+          ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+          bpm->UnpinPage(page_id, false);
+        }
+        for (size_t j = 0; j < lookups_per_page; ++j) {
+          lookup();
+        }
+      }
+    }
+    lookup_hit_rates[policy.second] = static_cast<double>(lookup_hits) / lookups;
+    LOG(INFO) << "policy: " << policy.first << ", lookup hit rate: " << lookup_hit_rates[policy.second]
+              << ", overall hit rate: " << bpm->GetHitRate();
+    EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+    delete bpm;
+    disk_manager->Close();
+    remove(db_name.c_str());
+    delete disk_manager;
+  }
+  // The scan resistant policies keep the hot set
+  EXPECT_LT(lookup_hit_rates[ReplacerType::kLRU], lookup_hit_rates[ReplacerType::kLRUK]);
+  EXPECT_LT(lookup_hit_rates[ReplacerType::kLRU], lookup_hit_rates[ReplacerType::kTwoQueue]);
+}
+
+TEST(BufferPoolManagerTest, BufferRingTest) {
+  const std::string db_name = "bpm_buffer_ring_test.db";
+  const size_t buffer_pool_size = 64;
+  const size_t num_hot_pages = 16;
+  const size_t num_bulk_pages = 512;
+  const size_t ring_size = 8;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 2);
+  page_id_t page_id_temp;
+  std::vector<page_id_t> hot_pages;
+  for (size_t i = 0; i < num_hot_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id_temp));
+    hot_pages.push_back(page_id_temp);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+  auto all_resident = [&](const std::vector<page_id_t> &page_ids) {
+    for (auto page_id : page_ids) {
+      if (bpm->TryFetchPage(page_id) == nullptr) {
+        return false;
+      }
+      bpm->UnpinPage(page_id, false);
+    }
+    return true;
+  };
+
+  // Scenario: a bulk load through a ring keeps the hot pages in the pool and only uses the frames of its ring.
+  auto load_ring = bpm->CreateBufferRing(ring_size);
+  std::vector<page_id_t> bulk_pages;
+  for (size_t i = 0; i < num_bulk_pages; ++i) {
+    auto *page = bpm->NewPage(page_id_temp, load_ring.get());
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id_temp);
+    bulk_pages.push_back(page_id_temp);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+  EXPECT_TRUE(all_resident(hot_pages));
+  EXPECT_LE(load_ring->GetFramesUsed(), ring_size);
+  EXPECT_GT(load_ring->GetReuses(), 0);
+
+  // Scenario: a sequential scan through a ring reads every page correctly and leaves the hot pages alone.
+  auto scan_ring = bpm->CreateBufferRing(ring_size);
+  for (auto page_id : bulk_pages) {
+    auto *page = bpm->FetchPage(page_id, scan_ring.get());
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+    bpm->UnpinPage(page_id, false);
+  }
+  EXPECT_TRUE(all_resident(hot_pages));
+  EXPECT_LE(scan_ring->GetFramesUsed(), ring_size);
+  EXPECT_GE(scan_ring->GetReuses(), num_bulk_pages - buffer_pool_size);
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  LOG(INFO) << "ring of " << ring_size << " frames: load used " << load_ring->GetFramesUsed() << " frames with "
+            << load_ring->GetReuses() << " reuses, scan used " << scan_ring->GetFramesUsed() << " frames with "
+            << scan_ring->GetReuses() << " reuses";
+
+  // Scenario: the same scan without a ring flushes the hot pages out of the pool.
+  for (auto page_id : bulk_pages) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    bpm->UnpinPage(page_id, false);
+  }
+  EXPECT_FALSE(all_resident(hot_pages));
+
+  delete bpm;
+  disk_manager->Close();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+TEST(BufferPoolManagerTest, BatchFlushTest) {
+  const std::string db_name = "bpm_batch_flush_test.db";
+  const size_t buffer_pool_size = 4096;
+  const size_t num_pages = 4000;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 8);
+  auto bulk_load = [&](int round) {
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < num_pages; ++i) {
+      auto *page = round == 0 ? bpm->NewPage(page_id_temp) : bpm->FetchPage(i);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page-%zu-%d", i, round);
+      bpm->UnpinPage(page->GetPageId(), true);
+    }
+  };
+
+  // Scenario: flushing page by page costs one write per page.
+  bulk_load(0);
+  size_t write_calls = disk_manager->GetNumWriteCalls();
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_pages; ++i) {
+    EXPECT_TRUE(bpm->FlushPage(i));
+  }
+  std::chrono::duration<double> single_elapsed = std::chrono::steady_clock::now() - start;
+  size_t single_calls = disk_manager->GetNumWriteCalls() - write_calls;
+  EXPECT_EQ(num_pages, single_calls);
+
+  // Scenario: a batch flush coalesces the pages of all instances which are consecutive on disk.
+  bulk_load(1);
+  write_calls = disk_manager->GetNumWriteCalls();
+  start = std::chrono::steady_clock::now();
+  bpm->FlushAllPages();
+  std::chrono::duration<double> batch_elapsed = std::chrono::steady_clock::now() - start;
+  size_t batch_calls = disk_manager->GetNumWriteCalls() - write_calls;
+  EXPECT_LE(batch_calls, num_pages / IOV_MAX + 1);
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  LOG(INFO) << "flushing " << num_pages << " pages: one by one " << single_calls << " writes in "
+            << single_elapsed.count() * 1000 << " ms, batched " << batch_calls << " writes in "
+            << batch_elapsed.count() * 1000 << " ms";
+
+  // Scenario: flushing a subset only writes the dirty pages in it, nothing is left dirty to write afterwards.
+  bulk_load(2);
+  write_calls = disk_manager->GetNumWriteCalls();
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 100; i < 200; ++i) {
+    page_ids.push_back(i);
+  }
+  page_ids.push_back(num_pages + 10);
+  bpm->FlushPages(page_ids);
+  EXPECT_EQ(1, disk_manager->GetNumWriteCalls() - write_calls);
+  bpm->FlushPages(page_ids);
+  EXPECT_EQ(1, disk_manager->GetNumWriteCalls() - write_calls);
+  delete bpm;
+
+  // the pages written by the batch can be read back
+  bpm = new BufferPoolManager(64, disk_manager);
+  for (size_t i = 0; i < num_pages; i += 97) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(i) + "-2", std::string(page->GetData()));
+    bpm->UnpinPage(i, false);
+  }
+  delete bpm;
+  disk_manager->Close();
+  remove(db_name.c_str());
   delete disk_manager;
-}
\ No newline at end of file
+}
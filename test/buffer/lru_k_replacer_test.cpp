@@ -0,0 +1,71 @@
+#include "buffer/lru_k_replacer.h"
+
+#include "gtest/gtest.h"
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: frames 1-5 are accessed once, frame 1 and 2 a second time later on.
+  for (frame_id_t frame_id = 1; frame_id <= 5; frame_id++) {
+    lru_k_replacer.Pin(frame_id);
+    lru_k_replacer.RecordAccess(frame_id);
+  }
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.RecordAccess(2);
+  for (frame_id_t frame_id = 1; frame_id <= 5; frame_id++) {
+    lru_k_replacer.Unpin(frame_id);
+  }
+  EXPECT_EQ(5, lru_k_replacer.Size());
+
+  // Scenario: frames accessed only once go first, oldest first, then by second to last access.
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+
+  // Scenario: a pinned frame is not a victim, and a victim forgets its history.
+  lru_k_replacer.Pin(2);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Pin(3);
+  lru_k_replacer.RecordAccess(3);
+  lru_k_replacer.Unpin(3);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+}
+
+TEST(LRUKReplacerTest, CorrelatedAccessTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: frame 1 is hot, frame 2 is fetched once per tuple by a scan. Back-to-back accesses of the scan count
+  // as one, so frame 2 still goes before frame 1.
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.RecordAccess(2);
+  lru_k_replacer.RecordAccess(2);
+  lru_k_replacer.RecordAccess(2);
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Unpin(2);
+
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+
+  // Scenario: the preferred frame is taken when it is among the first candidates.
+  lru_k_replacer.Unpin(3);
+  lru_k_replacer.Unpin(4);
+  lru_k_replacer.Unpin(5);
+  lru_k_replacer.Unpin(6);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value, [](frame_id_t frame_id) { return frame_id == 3; }));
+  EXPECT_EQ(3, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value, [](frame_id_t frame_id) { return frame_id == 1; }));
+  EXPECT_EQ(4, value);
+}
@@ -0,0 +1,56 @@
+#include "buffer/two_queue_replacer.h"
+
+#include "gtest/gtest.h"
+
+TEST(TwoQueueReplacerTest, SampleTest) {
+  TwoQueueReplacer two_queue_replacer(8, 0.25);
+
+  // Scenario: frames 1 and 2 are hot and move to Am, frames 3-6 are accessed once and stay in A1.
+  for (frame_id_t frame_id = 1; frame_id <= 6; frame_id++) {
+    two_queue_replacer.RecordAccess(frame_id);
+  }
+  two_queue_replacer.RecordAccess(1);
+  two_queue_replacer.RecordAccess(2);
+  for (frame_id_t frame_id = 1; frame_id <= 6; frame_id++) {
+    two_queue_replacer.Unpin(frame_id);
+  }
+  EXPECT_EQ(6, two_queue_replacer.Size());
+
+  // Scenario: A1 is over its share of two frames, so victims come from it in FIFO order.
+  int value;
+  ASSERT_TRUE(two_queue_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  ASSERT_TRUE(two_queue_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+
+  // Scenario: A1 is within its share, so the least recently used frame of Am goes next.
+  ASSERT_TRUE(two_queue_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+
+  // Scenario: pinned frames are skipped and an empty Am falls back to A1.
+  two_queue_replacer.Pin(2);
+  ASSERT_TRUE(two_queue_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+  ASSERT_TRUE(two_queue_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+  EXPECT_FALSE(two_queue_replacer.Victim(&value));
+
+  // Scenario: back-to-back accesses do not promote a frame to Am, so 7 is the only frame there and goes first.
+  two_queue_replacer.Remove(2);
+  two_queue_replacer.RecordAccess(2);
+  two_queue_replacer.RecordAccess(2);
+  two_queue_replacer.RecordAccess(7);
+  two_queue_replacer.RecordAccess(7);
+  two_queue_replacer.RecordAccess(1);
+  two_queue_replacer.RecordAccess(1);
+  two_queue_replacer.RecordAccess(7);
+  two_queue_replacer.Unpin(1);
+  two_queue_replacer.Unpin(2);
+  two_queue_replacer.Unpin(7);
+  ASSERT_TRUE(two_queue_replacer.Victim(&value));
+  EXPECT_EQ(7, value);
+  ASSERT_TRUE(two_queue_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(two_queue_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+}
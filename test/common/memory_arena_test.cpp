@@ -0,0 +1,82 @@
+#include "common/memory_arena.h"
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "record/row.h"
+
+TEST(MemoryArenaTest, AllocateAndResetTest) {
+  MemoryArena arena(1024);
+  // small allocations share a block and are aligned as asked
+  for (int i = 0; i < 10; i++) {
+    void *p = arena.Allocate(13, 8);
+    ASSERT_EQ(0, reinterpret_cast<uintptr_t>(p) % 8);
+  }
+  ASSERT_EQ(10, arena.GetAllocations());
+  ASSERT_EQ(130, arena.GetBytesAllocated());
+  ASSERT_EQ(1, arena.GetBlockAllocations());
+  // a large allocation gets a block of its own
+  char *large = static_cast<char *>(arena.Allocate(4096));
+  memset(large, 1, 4096);
+  ASSERT_EQ(2, arena.GetBlockAllocations());
+  // after a reset the first block is used again
+  arena.Reset();
+  for (int i = 0; i < 10; i++) {
+    arena.Allocate(64);
+  }
+  ASSERT_EQ(2, arena.GetBlockAllocations());
+  auto field = ALLOC_P((&arena), Field)(TypeId::kTypeInt, 7);
+  ASSERT_EQ("7", field->toString());
+}
+
+TEST(MemoryArenaTest, ConcurrentAllocateTest) {
+  MemoryArena arena;
+  const int num_threads = 4;
+  const int num_allocations = 10000;
+  std::vector<std::vector<int64_t *>> values(num_threads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < num_allocations; i++) {
+        auto value = static_cast<int64_t *>(arena.Allocate(sizeof(int64_t), alignof(int64_t)));
+        *value = t * num_allocations + i;
+        values[t].push_back(value);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  // no two threads got the same memory
+  for (int t = 0; t < num_threads; t++) {
+    for (int i = 0; i < num_allocations; i++) {
+      ASSERT_EQ(t * num_allocations + i, *values[t][i]);
+    }
+  }
+  ASSERT_EQ(num_threads * num_allocations, arena.GetAllocations());
+}
+
+TEST(MemoryArenaTest, ArenaRowTest) {
+  MemoryArena arena;
+  char chars[] = "minisql";
+  std::vector<Field> fields{Field(TypeId::kTypeInt, 1), Field(TypeId::kTypeChar, chars, 7, false)};
+  Row heap_row(fields);
+  {
+    // a row in the arena grows inside the arena, a copy of it lives on the heap again
+    Row row(&arena);
+    row = heap_row;
+    row.AppendField(Field(TypeId::kTypeFloat, 1.5f));
+    ASSERT_LE(1, arena.GetAllocations());
+    ASSERT_EQ(3, row.GetFieldCount());
+    ASSERT_EQ("minisql", row.GetField(1)->toString());
+    Row copy(row);
+    size_t allocations = arena.GetAllocations();
+    copy.AppendField(Field(TypeId::kTypeInt, 2));
+    ASSERT_EQ(allocations, arena.GetAllocations());
+    ASSERT_EQ("minisql", copy.GetField(1)->toString());
+  }
+  arena.Reset();
+}
@@ -27,6 +27,65 @@ TEST(BPlusTreeTests, BPlusTreeIndexGenericKeyTest) {
   ASSERT_EQ(0, KP.CompareKeys(k1, k2));
 }
 
+// keys compare with memcmp in the same order as their fields, and decode back to the same fields
+TEST(BPlusTreeTests, GenericKeyOrderTest) {
+  std::vector<Column *> columns = {new Column("name", TypeId::kTypeChar, 8, 0, true, false),
+                                   new Column("id", TypeId::kTypeInt, 1, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, true, false)};
+  Schema key_schema(columns);
+  KeyManager KP(&key_schema, 64);
+  char names[][4] = {"", "a", "a\0", "ab", "b"};
+  std::vector<uint32_t> name_lens = {0, 1, 2, 2, 1};
+  std::vector<int32_t> ids = {INT32_MIN, -1, 0, 1, INT32_MAX};
+  std::vector<float> accounts = {-1e30f, -2.5f, -0.0f, 0.0f, 1e-30f, 3.5f};
+  std::vector<Row> rows;
+  for (size_t n = 0; n < name_lens.size(); n++) {
+    for (auto id : ids) {
+      for (auto account : accounts) {
+        std::vector<Field> fields{Field(TypeId::kTypeChar, names[n], name_lens[n], true), Field(TypeId::kTypeInt, id),
+                                  Field(TypeId::kTypeFloat, account)};
+        rows.emplace_back(fields);
+      }
+    }
+  }
+  std::vector<Field> null_fields{Field(TypeId::kTypeChar), Field(TypeId::kTypeInt), Field(TypeId::kTypeFloat)};
+  rows.emplace_back(null_fields);
+  auto compare_fields = [](const Row &lhs, const Row &rhs) {
+    for (uint32_t i = 0; i < lhs.GetFieldCount(); i++) {
+      Field *l = lhs.GetField(i);
+      Field *r = rhs.GetField(i);
+      if (l->IsNull() || r->IsNull()) {
+        if (l->IsNull() != r->IsNull()) {
+          return l->IsNull() ? -1 : 1;  // nulls sort first
+        }
+      } else if (l->CompareLessThan(*r) == CmpBool::kTrue) {
+        return -1;
+      } else if (l->CompareGreaterThan(*r) == CmpBool::kTrue) {
+        return 1;
+      }
+    }
+    return 0;
+  };
+  std::vector<GenericKey *> keys;
+  for (auto &row : rows) {
+    keys.push_back(KP.InitKey());
+    KP.SerializeFromKey(keys.back(), row, &key_schema);
+    Row decoded;
+    KP.DeserializeToKey(keys.back(), decoded, &key_schema);
+    ASSERT_EQ(0, compare_fields(row, decoded));
+  }
+  for (size_t i = 0; i < rows.size(); i++) {
+    for (size_t j = 0; j < rows.size(); j++) {
+      int expected = compare_fields(rows[i], rows[j]);
+      int actual = KP.CompareKeys(keys[i], keys[j]);
+      ASSERT_EQ(expected, (actual > 0) - (actual < 0)) << i << " " << j;
+    }
+  }
+  for (auto key : keys) {
+    free(key);
+  }
+}
+
 TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
   auto disk_mgr_ = new DiskManager(db_name);
   auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
@@ -65,15 +124,17 @@ TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
     ASSERT_EQ(DB_SUCCESS, index->ScanKey(row, ret, nullptr));
     ASSERT_EQ(rid.Get(), ret[i].Get());
   }
-  // Iterator Scan
-  IndexIterator iter = index->GetBeginIterator();
-  uint32_t i = 0;
-  for (; iter != index->GetEndIterator(); ++iter) {
-    ASSERT_EQ(1000, (*iter).second.GetPageId());
-    ASSERT_EQ(i, (*iter).second.GetSlotNum());
-    i++;
+  // Iterator Scan, the iterator must release its page before the buffer pool goes away
+  {
+    IndexIterator iter = index->GetBeginIterator();
+    uint32_t i = 0;
+    for (; iter != index->GetEndIterator(); ++iter) {
+      ASSERT_EQ(1000, (*iter).second.GetPageId());
+      ASSERT_EQ(i, (*iter).second.GetSlotNum());
+      i++;
+    }
+    ASSERT_EQ(10, i);
   }
-  ASSERT_EQ(10, i);
   index->Destroy();
   delete index;
   delete bpm_;
@@ -1,6 +1,12 @@
 #include "index/b_plus_tree.h"
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
 #include "common/instance.h"
+#include "glog/logging.h"
 #include "gtest/gtest.h"
 #include "index/comparator.h"
 #include "utils/tree_file_mgr.h"
@@ -69,4 +75,344 @@ TEST(BPlusTreeTests, SampleTest) {
     ASSERT_TRUE(tree.GetValue(delete_seq[i], ans));
     ASSERT_EQ(kv_map[delete_seq[i]], ans[ans.size() - 1]);
   }
-}
\ No newline at end of file
+}
+
+// lookups of (int, char) keys, and comparisons of the binary keys against deserializing both keys into rows
+TEST(BPlusTreeTests, LookupBenchmarkTest) {
+  DBStorageEngine engine("bp_tree_lookup_test.db");
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 16, 1, false, false)};
+  Schema *key_schema = new Schema(columns);
+  KeyManager KP(key_schema, 32);
+  BPlusTree tree(0, engine.bpm_, KP);
+  const int n = 20000;
+  char name[16];
+  RandomUtils::RandomString(name, 16);
+  std::vector<GenericKey *> keys;
+  std::vector<Row> rows;
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i / 4), Field(TypeId::kTypeChar, name, i % 4 + 12, true)};
+    rows.emplace_back(fields);
+    keys.push_back(KP.InitKey());
+    KP.SerializeFromKey(keys.back(), rows.back(), key_schema);
+  }
+  std::vector<GenericKey *> shuffled(keys);
+  ShuffleArray(shuffled);
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.Insert(shuffled[i], RowId(i)));
+  }
+  ASSERT_TRUE(tree.Check());
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<RowId> ans;
+  for (auto key : shuffled) {
+    ASSERT_TRUE(tree.GetValue(key, ans));
+  }
+  auto lookup_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  ASSERT_EQ(n, ans.size());
+
+  // what every comparison cost when keys were serialized rows: two rows deserialized, then field by field
+  std::vector<char *> row_keys;
+  for (auto &row : rows) {
+    row_keys.push_back(new char[row.GetSerializedSize(key_schema)]);
+    row.SerializeTo(row_keys.back(), key_schema);
+  }
+  int row_order = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i = 1; i < n; i++) {
+    Row lhs;
+    Row rhs;
+    lhs.DeserializeFrom(row_keys[i - 1], key_schema);
+    rhs.DeserializeFrom(row_keys[i], key_schema);
+    for (uint32_t j = 0; j < lhs.GetFieldCount(); j++) {
+      if (lhs.GetField(j)->CompareLessThan(*rhs.GetField(j)) == CmpBool::kTrue) {
+        row_order--;
+        break;
+      }
+      if (lhs.GetField(j)->CompareGreaterThan(*rhs.GetField(j)) == CmpBool::kTrue) {
+        row_order++;
+        break;
+      }
+    }
+  }
+  auto row_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  int key_order = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i = 1; i < n; i++) {
+    int cmp = KP.CompareKeys(keys[i - 1], keys[i]);
+    key_order += (cmp > 0) - (cmp < 0);
+  }
+  auto key_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  ASSERT_EQ(-(n - 1), row_order);
+  ASSERT_EQ(row_order, key_order);
+  LOG(INFO) << static_cast<size_t>(n / lookup_secs) << " lookups/sec, "
+            << static_cast<size_t>((n - 1) / row_secs) << " row comparisons/sec (2 row buffers allocated each), "
+            << static_cast<size_t>((n - 1) / key_secs) << " key comparisons/sec (no allocation)";
+  for (auto key : keys) {
+    free(key);
+  }
+  for (auto row_key : row_keys) {
+    delete[] row_key;
+  }
+  delete key_schema;
+}
+
+// the same int keys in the generic tree and in the one specialized for a single fixed width column
+TEST(BPlusTreeTests, FixedKeyTreeTest) {
+  DBStorageEngine engine("bp_tree_fixed_key_test.db");
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  Schema *key_schema = new Schema(columns);
+  ASSERT_TRUE(FixedKeyManager::IsFixedWidth(key_schema));
+  KeyManager KP(key_schema, 16);
+  FixedKeyManager fixed_KP(key_schema, 16);
+  BPlusTree tree(0, engine.bpm_, KP);
+  FixedKeyBPlusTree fixed_tree(1, engine.bpm_, fixed_KP);
+  const int n = 50000;
+  std::vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(KP.InitKey());
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i - n / 2)};
+    KP.SerializeFromKey(keys.back(), Row(fields), key_schema);
+  }
+  ShuffleArray(keys);
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.Insert(keys[i], RowId(i)));
+    ASSERT_TRUE(fixed_tree.Insert(keys[i], RowId(i)));
+  }
+
+  std::vector<RowId> ans;
+  std::vector<RowId> fixed_ans;
+  auto start = std::chrono::steady_clock::now();
+  for (auto key : keys) {
+    ASSERT_TRUE(tree.GetValue(key, ans));
+  }
+  auto generic_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  start = std::chrono::steady_clock::now();
+  for (auto key : keys) {
+    ASSERT_TRUE(fixed_tree.GetValue(key, fixed_ans));
+  }
+  auto fixed_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  ASSERT_EQ(ans, fixed_ans);
+  LOG(INFO) << static_cast<size_t>(n / generic_secs) << " lookups/sec in the generic tree, "
+            << static_cast<size_t>(n / fixed_secs) << " lookups/sec in the fixed key tree";
+
+  // both trees keep their keys in the same order
+  {
+    auto iter = tree.Begin();
+    auto fixed_iter = fixed_tree.Begin();
+    auto end = tree.End();
+    auto fixed_end = fixed_tree.End();
+    for (; iter != end; ++iter, ++fixed_iter) {
+      ASSERT_TRUE(fixed_iter != fixed_end);
+      ASSERT_EQ(0, KP.CompareKeys((*iter).first, (*fixed_iter).first));
+    }
+    ASSERT_TRUE(fixed_iter == fixed_end);
+  }
+  for (int i = 0; i < n / 2; i++) {
+    fixed_tree.Remove(keys[i]);
+  }
+  for (int i = 0; i < n; i++) {
+    fixed_ans.clear();
+    ASSERT_EQ(i >= n / 2, fixed_tree.GetValue(keys[i], fixed_ans));
+  }
+  ASSERT_TRUE(tree.Check());
+  ASSERT_TRUE(fixed_tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+  delete key_schema;
+}
+
+// sessions inserting, looking up and removing interleaved keys at once, with a fanout small enough to split and merge
+TEST(BPlusTreeTests, ConcurrentInsertRemoveTest) {
+  DBStorageEngine engine("bp_tree_concurrent_test.db");
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  Schema *key_schema = new Schema(columns);
+  KeyManager KP(key_schema, 16);
+  BPlusTree tree(0, engine.bpm_, KP, 6, 6);
+  const int num_threads = 4;
+  const int n = 20000;
+  std::vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(KP.InitKey());
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(keys.back(), Row(fields), key_schema);
+  }
+  // thread t works on keys t, t + num_threads, ..., so all of them touch the same leaves
+  auto run = [&](const std::function<void(int)> &work) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+      threads.emplace_back([&, t]() {
+        for (int i = t; i < n; i += num_threads) {
+          work(i);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  };
+  std::atomic<int> errors{0};
+
+  run([&](int i) {
+    if (!tree.Insert(keys[i], RowId(i)) || tree.Insert(keys[i], RowId(i))) errors++;
+  });
+  ASSERT_EQ(0, errors.load());
+  ASSERT_TRUE(tree.Check());
+
+  // remove the even keys while looking up the odd ones
+  run([&](int i) {
+    std::vector<RowId> ans;
+    if (i % 2 == 0) {
+      tree.Remove(keys[i]);
+    } else if (!tree.GetValue(keys[i], ans) || ans[0].Get() != RowId(i).Get()) {
+      errors++;
+    }
+  });
+  ASSERT_EQ(0, errors.load());
+  ASSERT_TRUE(tree.Check());
+  int expected = 1;
+  for (auto iter = tree.Begin(), end = tree.End(); iter != end; ++iter, expected += 2) {
+    ASSERT_EQ(0, KP.CompareKeys((*iter).first, keys[expected]));
+  }
+  ASSERT_EQ(n + 1, expected);
+
+  run([&](int i) {
+    std::vector<RowId> ans;
+    if (tree.GetValue(keys[i], ans) != (i % 2 == 1)) errors++;
+    tree.Remove(keys[i]);
+  });
+  ASSERT_EQ(0, errors.load());
+  ASSERT_TRUE(tree.IsEmpty());
+  ASSERT_TRUE(tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+  delete key_schema;
+}
+
+// insert and lookup throughput as sessions are added, each thread working on its own keys
+TEST(BPlusTreeTests, ConcurrentScalingTest) {
+  DBStorageEngine engine("bp_tree_scaling_test.db");
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  Schema *key_schema = new Schema(columns);
+  KeyManager KP(key_schema, 16);
+  const int keys_per_thread = 10000;
+  const int max_threads = std::max(4u, std::thread::hardware_concurrency());
+  std::vector<GenericKey *> keys;
+  for (int i = 0; i < keys_per_thread * max_threads; i++) {
+    keys.push_back(KP.InitKey());
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(keys.back(), Row(fields), key_schema);
+  }
+  ShuffleArray(keys);
+
+  index_id_t index_id = 0;
+  for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    BPlusTree tree(index_id++, engine.bpm_, KP);
+    std::atomic<int> errors{0};
+    auto run = [&](bool insert) {
+      std::vector<std::thread> threads;
+      auto start = std::chrono::steady_clock::now();
+      for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+          std::vector<RowId> ans;
+          for (int i = t * keys_per_thread; i < (t + 1) * keys_per_thread; i++) {
+            if (!(insert ? tree.Insert(keys[i], RowId(i)) : tree.GetValue(keys[i], ans))) errors++;
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    auto insert_secs = run(true);
+    auto lookup_secs = run(false);
+    ASSERT_EQ(0, errors.load());
+    ASSERT_TRUE(tree.Check());
+    LOG(INFO) << "threads: " << num_threads
+              << ", inserts/sec: " << static_cast<size_t>(num_threads * keys_per_thread / insert_secs)
+              << ", lookups/sec: " << static_cast<size_t>(num_threads * keys_per_thread / lookup_secs);
+  }
+  for (auto key : keys) {
+    free(key);
+  }
+  delete key_schema;
+}
+
+// lookups racing with inserts that split the pages under them, which they recover from by moving right
+TEST(BPlusTreeTests, RightLinkLookupTest) {
+  DBStorageEngine engine("bp_tree_right_link_test.db");
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  Schema *key_schema = new Schema(columns);
+  KeyManager KP(key_schema, 16);
+  BPlusTree tree(0, engine.bpm_, KP, 4, 4);
+  const int num_readers = 3;
+  const int num_writers = 2;
+  const int n = 20000;
+  std::vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(KP.InitKey());
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(keys.back(), Row(fields), key_schema);
+  }
+  for (int i = 0; i < n; i += 2) {
+    ASSERT_TRUE(tree.Insert(keys[i], RowId(i)));
+  }
+
+  // the writers fill in the odd keys while the readers keep looking up the even ones
+  std::atomic<int> errors{0};
+  std::atomic<int> writers_left{num_writers};
+  std::atomic<size_t> lookups{0};
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < num_writers; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 2 * t + 1; i < n; i += 2 * num_writers) {
+        if (!tree.Insert(keys[i], RowId(i))) errors++;
+      }
+      writers_left--;
+    });
+  }
+  for (int t = 0; t < num_readers; t++) {
+    threads.emplace_back([&, t]() {
+      std::vector<RowId> ans;
+      for (int i = 2 * t; writers_left > 0; i = (i + 2 * num_readers) % n, lookups++) {
+        ans.clear();
+        if (!tree.GetValue(keys[i], ans) || ans[0].Get() != RowId(i).Get()) errors++;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  ASSERT_EQ(0, errors.load());
+  LOG(INFO) << static_cast<size_t>(lookups / elapsed) << " lookups/sec while " << num_writers << " threads split pages";
+
+  // every leaf is bounded by its high key, which does not exceed the keys of its right sibling
+  Page *page = tree.FindLeafPage(nullptr, true);
+  int count = 0;
+  while (true) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    count += leaf->GetSize();
+    page_id_t next_page_id = leaf->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      engine.bpm_->UnpinPage(page->GetPageId(), false);
+      break;
+    }
+    Page *next_page = engine.bpm_->FetchPage(next_page_id);
+    auto *next = reinterpret_cast<LeafPage *>(next_page->GetData());
+    ASSERT_LT(KP.CompareKeys(leaf->KeyAt(leaf->GetSize() - 1), leaf->GetHighKey()), 0);
+    ASSERT_LE(KP.CompareKeys(leaf->GetHighKey(), next->KeyAt(0)), 0);
+    engine.bpm_->UnpinPage(page->GetPageId(), false);
+    page = next_page;
+  }
+  ASSERT_EQ(n, count);
+  ASSERT_TRUE(tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+  delete key_schema;
+}
@@ -1,3 +1,6 @@
+#include <atomic>
+#include <thread>
+
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "index/b_plus_tree.h"
@@ -54,3 +57,92 @@ TEST(BPlusTreeTests, IndexIteratorTest) {
   }
   ASSERT_EQ(25, i);
 }
+
+TEST(BPlusTreeTests, IndexIteratorReadAheadTest) {
+  // A pool smaller than the leaf chain, so the scan reads leaves back from disk while the following ones are
+  // prefetched. Every key is still visited once and in order.
+  DBStorageEngine engine(db_name, true, 256);
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  BPlusTree tree(0, engine.bpm_, KP, 8, 8);
+  const int key_nums = 2000;
+  for (int i = 0; i < key_nums; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    tree.Insert(key, RowId(i), nullptr);
+    free(key);
+  }
+  int i = 0;
+  auto end = tree.End();
+  for (auto iter = tree.Begin(); iter != end; ++iter) {
+    ASSERT_EQ(RowId(i), (*iter).second);
+    i++;
+  }
+  ASSERT_EQ(key_nums, i);
+}
+
+TEST(BPlusTreeTests, IndexIteratorConcurrentRemoveTest) {
+  // Scans racing with removes which merge the leaves under them and free the leaves they are on. Every key which is
+  // never removed is still visited once and in order.
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  BPlusTree tree(0, engine.bpm_, KP, 4, 4);
+  const int key_nums = 8000;
+  const int num_scanners = 2;
+  std::vector<GenericKey *> keys;
+  for (int i = 0; i < key_nums; i++) {
+    keys.push_back(KP.InitKey());
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(keys.back(), Row(fields), table_schema);
+    ASSERT_TRUE(tree.Insert(keys.back(), RowId(i)));
+  }
+
+  std::atomic<int> errors{0};
+  std::atomic<bool> removing{true};
+  std::atomic<int> scans{0};
+  std::vector<std::thread> threads;
+  threads.emplace_back([&]() {
+    for (int i = 1; i < key_nums; i += 2) {
+      tree.Remove(keys[i]);
+    }
+    removing = false;
+  });
+  for (int t = 0; t < num_scanners; t++) {
+    threads.emplace_back([&]() {
+      do {
+        int64_t last = -1;
+        int evens = 0;
+        for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+          int64_t value = (*iter).second.Get();
+          if (value <= last) errors++;
+          evens += value % 2 == 0;
+          last = value;
+        }
+        if (evens != key_nums / 2) errors++;
+        scans++;
+      } while (removing);
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, errors.load());
+  ASSERT_LE(num_scanners, scans.load());
+  int i = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter, i += 2) {
+    ASSERT_EQ(RowId(i), (*iter).second);
+  }
+  ASSERT_EQ(key_nums, i);
+  ASSERT_TRUE(tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+}
@@ -0,0 +1,93 @@
+#include "index/key_search.h"
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "index/generic_key.h"
+#include "page/b_plus_tree_leaf_page.h"
+#include "utils/utils.h"
+
+TEST(KeySearchTest, CountLessTest) {
+  const int stride = 24;
+  const int max_count = 70;
+  std::vector<char> keys(max_count * stride);
+  std::vector<uint64_t> words;
+  for (int i = 0; i < max_count; i++) {
+    // sorted words which span the whole unsigned range, with repeats
+    uint64_t word = i < 3 ? 0 : (i > max_count - 3 ? UINT64_MAX : (static_cast<uint64_t>(i / 2) << 57) + i % 5);
+    words.push_back(word);
+    uint64_t big_endian = __builtin_bswap64(word);
+    memcpy(keys.data() + i * stride, &big_endian, sizeof(big_endian));
+    ASSERT_EQ(word, KeySearch::ReadWord(keys.data() + i * stride));
+  }
+  for (int count = 0; count <= max_count; count++) {
+    for (int i = 0; i < max_count; i++) {
+      for (uint64_t word : {words[i], words[i] - 1, words[i] + 1}) {
+        for (bool or_equal : {false, true}) {
+          int expected = 0;
+          for (int j = 0; j < count; j++) {
+            expected += or_equal ? words[j] <= word : words[j] < word;
+          }
+          ASSERT_EQ(expected, KeySearch::CountLess(keys.data(), stride, count, word, or_equal));
+          ASSERT_EQ(expected, KeySearch::CountLessScalar(keys.data(), stride, count, word, or_equal));
+        }
+      }
+    }
+  }
+}
+
+// KeyIndex on leaf pages of several fanouts, by binary search with the generic key manager and by the fixed width one
+TEST(KeySearchTest, LeafPageSearchBenchmarkTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  Schema key_schema(columns);
+  const int key_size = 16;
+  KeyManager KP(&key_schema, key_size);
+  FixedKeyManager fixed_KP(&key_schema, key_size);
+  const int max_size = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / (key_size + sizeof(RowId));
+  const int searches = 200000;
+  auto *page_data = new char[PAGE_SIZE];
+  auto *leaf = reinterpret_cast<LeafPage *>(page_data);
+  GenericKey *key = KP.InitKey();
+  for (int fanout : {8, 32, 64, 128, max_size}) {
+    leaf->Init(0, INVALID_PAGE_ID, key_size, max_size + 1);
+    for (int i = 0; i < fanout; i++) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, 2 * i - fanout)};
+      KP.SerializeFromKey(key, Row(fields), &key_schema);
+      leaf->Insert(key, RowId(i), fixed_KP);
+    }
+    ASSERT_EQ(fanout, leaf->GetSize());
+    // probe every key and every gap between two keys
+    std::vector<GenericKey *> probes;
+    for (int i = -1; i <= 2 * fanout; i++) {
+      probes.push_back(KP.InitKey());
+      std::vector<Field> fields{Field(TypeId::kTypeInt, i - fanout)};
+      KP.SerializeFromKey(probes.back(), Row(fields), &key_schema);
+      ASSERT_EQ(leaf->KeyIndex(probes.back(), KP), leaf->KeyIndex(probes.back(), fixed_KP));
+      ASSERT_EQ((i + 1) / 2, leaf->KeyIndex(probes.back(), fixed_KP));
+    }
+    ShuffleArray(probes);
+    size_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < searches; i++) {
+      checksum += leaf->KeyIndex(probes[i % probes.size()], KP);
+    }
+    auto generic_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    size_t fixed_checksum = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < searches; i++) {
+      fixed_checksum += leaf->KeyIndex(probes[i % probes.size()], fixed_KP);
+    }
+    auto fixed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    ASSERT_EQ(checksum, fixed_checksum);
+    LOG(INFO) << "fanout " << fanout << ": " << generic_ns / searches << " ns/search with memcmp, " << fixed_ns / searches
+              << " ns/search with fixed width keys";
+    for (auto probe : probes) {
+      free(probe);
+    }
+  }
+  free(key);
+  delete[] page_data;
+}
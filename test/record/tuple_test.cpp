@@ -2,9 +2,11 @@
 
 #include "common/instance.h"
 #include "gtest/gtest.h"
+#include "page/pax_page.h"
 #include "page/table_page.h"
 #include "record/field.h"
 #include "record/row.h"
+#include "record/row_view.h"
 #include "record/schema.h"
 
 char *chars[] = {const_cast<char *>(""), const_cast<char *>("hello"), const_cast<char *>("world!"),
@@ -93,11 +95,237 @@ TEST(TupleTest, RowTest) {
   ASSERT_EQ(row.GetRowId(), first_tuple_rid);
   Row row2(row.GetRowId());
   ASSERT_TRUE(table_page.GetTuple(&row2, schema.get(), nullptr, nullptr));
-  std::vector<Field *> &row2_fields = row2.GetFields();
-  ASSERT_EQ(3, row2_fields.size());
-  for (size_t i = 0; i < row2_fields.size(); i++) {
-    ASSERT_EQ(CmpBool::kTrue, row2_fields[i]->CompareEquals(fields[i]));
+  ASSERT_EQ(3, row2.GetFieldCount());
+  for (uint32_t i = 0; i < row2.GetFieldCount(); i++) {
+    ASSERT_EQ(CmpBool::kTrue, row2.GetField(i)->CompareEquals(fields[i]));
   }
   ASSERT_TRUE(table_page.MarkDelete(row.GetRowId(), nullptr, nullptr, nullptr));
   table_page.ApplyDelete(row.GetRowId(), nullptr, nullptr);
-}
\ No newline at end of file
+}
+TEST(TupleTest, RowStorageTest) {
+  std::vector<Field> fields = {Field(TypeId::kTypeInt, 188),
+                               Field(TypeId::kTypeChar, const_cast<char *>("minisql"), strlen("minisql"), false),
+                               Field(TypeId::kTypeFloat, 19.99f), Field(TypeId::kTypeChar)};
+  Row row(fields);
+  ASSERT_EQ(4, row.GetFieldCount());
+  // the characters are copied into the row
+  ASSERT_NE(fields[1].GetData(), row.GetField(1)->GetData());
+  ASSERT_TRUE(row.GetField(3)->IsNull());
+  for (uint32_t i = 0; i < 3; i++) {
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(i)->CompareEquals(fields[i]));
+  }
+
+  // a copy has its own characters, a move keeps them where they are
+  Row copy(row);
+  ASSERT_NE(row.GetField(1)->GetData(), copy.GetField(1)->GetData());
+  const char *chars = copy.GetField(1)->GetData();
+  Row moved(std::move(copy));
+  ASSERT_EQ(chars, moved.GetField(1)->GetData());
+  ASSERT_EQ("minisql", moved.GetField(1)->toString());
+  Row assigned;
+  assigned = std::move(moved);
+  ASSERT_EQ(chars, assigned.GetField(1)->GetData());
+  ASSERT_EQ(0, moved.GetFieldCount());
+
+  // appending past the reserved room moves the fields, a field of the row itself can be appended
+  for (int i = 0; i < 100; i++) {
+    assigned.AppendField(*assigned.GetField(1));
+  }
+  ASSERT_EQ(104, assigned.GetFieldCount());
+  for (uint32_t i = 4; i < assigned.GetFieldCount(); i++) {
+    ASSERT_EQ("minisql", assigned.GetField(i)->toString());
+  }
+  std::string long_chars(1000, 'x');
+  assigned.SetField(0, Field(TypeId::kTypeChar, const_cast<char *>(long_chars.data()), long_chars.size(), false));
+  ASSERT_EQ(long_chars, assigned.GetField(0)->toString());
+  ASSERT_EQ("minisql", assigned.GetField(103)->toString());
+
+  // a reused row keeps its buffer
+  Row reused(fields);
+  const char *before = reused.GetField(1)->GetData();
+  reused = row;
+  ASSERT_EQ(before, reused.GetField(1)->GetData());
+  reused.destroy();
+  ASSERT_EQ(0, reused.GetFieldCount());
+}
+
+TEST(TupleTest, RowViewTest) {
+  TablePage table_page;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, true, false)};
+  std::vector<Field> fields = {Field(TypeId::kTypeInt, 188),
+                               Field(TypeId::kTypeChar, const_cast<char *>("minisql"), strlen("minisql"), false),
+                               Field(TypeId::kTypeFloat, 19.99f)};
+  auto schema = std::make_shared<Schema>(columns);
+  Row row(fields);
+  table_page.Init(0, INVALID_PAGE_ID, nullptr, nullptr);
+  ASSERT_TRUE(table_page.InsertTuple(row, schema.get(), nullptr, nullptr, nullptr));
+  RowView view;
+  ASSERT_FALSE(view.IsValid());
+  ASSERT_TRUE(table_page.GetTupleView(row.GetRowId(), schema.get(), &view));
+  ASSERT_EQ(row.GetRowId(), view.GetRowId());
+  ASSERT_EQ(3, view.GetFieldCount());
+  ASSERT_EQ(188, view.GetInt(0));
+  ASSERT_EQ(19.99f, view.GetFloat(2));
+  uint32_t len;
+  const char *chars = view.GetChars(1, &len);
+  ASSERT_EQ(strlen("minisql"), len);
+  // the characters are read in place
+  ASSERT_GT(chars, table_page.GetData());
+  ASSERT_LT(chars, table_page.GetData() + PAGE_SIZE);
+  for (uint32_t i = 0; i < view.GetFieldCount(); i++) {
+    ASSERT_EQ(CmpBool::kTrue, view.GetField(i).CompareEquals(fields[i]));
+    ASSERT_EQ(CmpBool::kTrue, view.GetField(i, true).CompareEquals(fields[i]));
+  }
+  Row row2;
+  view.Materialize(&row2);
+  ASSERT_EQ(row.GetRowId(), row2.GetRowId());
+  ASSERT_EQ(3, row2.GetFieldCount());
+  for (uint32_t i = 0; i < row2.GetFieldCount(); i++) {
+    ASSERT_EQ(CmpBool::kTrue, row2.GetField(i)->CompareEquals(fields[i]));
+  }
+  ASSERT_TRUE(table_page.MarkDelete(row.GetRowId(), nullptr, nullptr, nullptr));
+  ASSERT_FALSE(table_page.GetTupleView(row.GetRowId(), schema.get(), &view));
+}
+
+TEST(TupleTest, TablePageCompactTest) {
+  TablePage table_page;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char characters[64];
+  memset(characters, 'a', sizeof(characters));
+  table_page.Init(0, INVALID_PAGE_ID, nullptr, nullptr);
+  std::vector<RowId> rids;
+  while (true) {
+    std::vector<Field> fields = {Field(TypeId::kTypeInt, static_cast<int32_t>(rids.size())),
+                                 Field(TypeId::kTypeChar, characters, 8, false)};
+    Row row(fields);
+    if (!table_page.InsertTuple(row, schema.get(), nullptr, nullptr, nullptr)) {
+      break;
+    }
+    rids.push_back(row.GetRowId());
+  }
+  ASSERT_GT(rids.size(), 10);
+  // the page is full, a larger row does not fit
+  std::vector<Field> large_fields = {Field(TypeId::kTypeInt, 0), Field(TypeId::kTypeChar, characters, 64, false)};
+  Row large_row(large_fields);
+  Row old_row(rids[1]);
+  ASSERT_FALSE(table_page.UpdateTuple(large_row, &old_row, schema.get(), nullptr, nullptr, nullptr));
+
+  // delete every odd row and the last three
+  uint32_t deleted = 0;
+  for (size_t i = 0; i < rids.size(); i++) {
+    if (i % 2 == 1 || i + 3 >= rids.size()) {
+      ASSERT_TRUE(table_page.MarkDelete(rids[i], nullptr, nullptr, nullptr));
+      deleted++;
+    }
+  }
+  uint32_t free_space = table_page.GetFreeSpaceRemaining();
+  uint32_t deleted_space = table_page.GetDeletedTupleSpace();
+  ASSERT_GT(deleted_space, 0);
+  ASSERT_EQ(deleted, table_page.Compact());
+  ASSERT_EQ(0, table_page.GetDeletedTupleSpace());
+  // the bytes of the deleted tuples and the slots at the end are given back
+  // the last three slots and the deleted odd slot right before them
+  uint32_t trailing = (rids.size() - 4) % 2 == 1 ? 4 : 3;
+  ASSERT_EQ(free_space + deleted_space + trailing * TablePage::SIZE_TUPLE, table_page.GetFreeSpaceRemaining());
+
+  // live rows keep their rids
+  for (size_t i = 0; i < rids.size(); i++) {
+    Row row(rids[i]);
+    bool live = i % 2 == 0 && i + 3 < rids.size();
+    ASSERT_EQ(live, table_page.GetTuple(&row, schema.get(), nullptr, nullptr));
+    if (live) {
+      ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, static_cast<int32_t>(i))));
+    }
+  }
+  // an insert reuses the first empty slot, an update which did not fit before now does
+  std::vector<Field> fields = {Field(TypeId::kTypeInt, -1), Field(TypeId::kTypeChar, characters, 8, false)};
+  Row row(fields);
+  ASSERT_TRUE(table_page.InsertTuple(row, schema.get(), nullptr, nullptr, nullptr));
+  ASSERT_EQ(rids[1], row.GetRowId());
+  Row old_row2(rids[2]);
+  ASSERT_TRUE(table_page.UpdateTuple(large_row, &old_row2, schema.get(), nullptr, nullptr, nullptr));
+  ASSERT_TRUE(table_page.InsertTuple(row, schema.get(), nullptr, nullptr, nullptr));
+  ASSERT_EQ(rids[3], row.GetRowId());
+}
+
+TEST(TupleTest, PaxPageTest) {
+  PaxPage pax_page;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 16, 1, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  uint32_t capacity = PaxPage::GetCapacity(schema.get());
+  ASSERT_GT(capacity, 100);
+  pax_page.Init(0, INVALID_PAGE_ID, schema.get(), nullptr, nullptr);
+  // the page is used through the TablePage interface, as the table heap does
+  TablePage *table_page = &pax_page;
+  ASSERT_TRUE(table_page->IsPax());
+  std::string name = "minisql";
+  std::vector<RowId> rids;
+  while (true) {
+    std::vector<Field> fields = {Field(TypeId::kTypeInt, static_cast<int32_t>(rids.size())),
+                                 Field(TypeId::kTypeChar, const_cast<char *>(name.data()), name.size(), false),
+                                 Field(TypeId::kTypeFloat, rids.size() * 0.5f)};
+    Row row(fields);
+    if (!table_page->InsertTuple(row, schema.get(), nullptr, nullptr, nullptr)) {
+      break;
+    }
+    rids.push_back(row.GetRowId());
+  }
+  ASSERT_EQ(capacity, rids.size());
+  ASSERT_EQ(0, table_page->GetFreeSpaceRemaining());
+
+  // a char value longer than its column does not fit
+  std::string long_name(17, 'a');
+  std::vector<Field> long_fields = {Field(TypeId::kTypeInt, 0),
+                                    Field(TypeId::kTypeChar, const_cast<char *>(long_name.data()), 17, false),
+                                    Field(TypeId::kTypeFloat, 0.0f)};
+  Row long_row(long_fields);
+  ASSERT_FALSE(PaxPage::CanHold(long_row, schema.get()));
+
+  // the values of a column are next to each other
+  std::vector<RowView> views;
+  ASSERT_EQ(capacity, table_page->GetTupleViews(schema.get(), 0, &views, nullptr));
+  for (uint32_t i = 0; i < capacity; i++) {
+    ASSERT_EQ(rids[i], views[i].GetRowId());
+    ASSERT_EQ(static_cast<int32_t>(i), views[i].GetInt(0));
+    ASSERT_EQ(i * 0.5f, views[i].GetFloat(2));
+    uint32_t len;
+    const char *chars = views[i].GetChars(1, &len);
+    ASSERT_EQ(name, std::string(chars, len));
+  }
+  uint32_t len;
+  ASSERT_EQ(views[0].GetChars(1, &len) + 4 + 16, views[1].GetChars(1, &len));
+  Row row2;
+  views[7].Materialize(&row2);
+  ASSERT_EQ(3, row2.GetFieldCount());
+  ASSERT_EQ(CmpBool::kTrue, row2.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, 7)));
+
+  // update in place, delete, compact and reuse the slot
+  std::string new_name = "pax";
+  std::vector<Field> new_fields = {Field(TypeId::kTypeInt, -1),
+                                   Field(TypeId::kTypeChar, const_cast<char *>(new_name.data()), 3, false),
+                                   Field(TypeId::kTypeFloat, 1.5f)};
+  Row new_row(new_fields);
+  Row old_row(rids[3]);
+  ASSERT_TRUE(table_page->UpdateTuple(new_row, &old_row, schema.get(), nullptr, nullptr, nullptr));
+  ASSERT_EQ(CmpBool::kTrue, old_row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, 3)));
+  Row row3(rids[3]);
+  ASSERT_TRUE(table_page->GetTuple(&row3, schema.get(), nullptr, nullptr));
+  ASSERT_EQ(new_name, row3.GetField(1)->toString());
+  ASSERT_TRUE(table_page->MarkDelete(rids[5], nullptr, nullptr, nullptr));
+  ASSERT_TRUE(table_page->MarkDelete(rids[6], nullptr, nullptr, nullptr));
+  Row row5(rids[5]);
+  ASSERT_FALSE(table_page->GetTuple(&row5, schema.get(), nullptr, nullptr));
+  ASSERT_EQ(capacity - 2, table_page->GetTupleViews(schema.get(), 0, &views, nullptr));
+  ASSERT_GT(table_page->GetDeletedTupleSpace(), 0);
+  ASSERT_EQ(2, table_page->Compact());
+  ASSERT_EQ(0, table_page->GetDeletedTupleSpace());
+  ASSERT_GT(table_page->GetFreeSpaceRemaining(), 0);
+  ASSERT_TRUE(table_page->InsertTuple(new_row, schema.get(), nullptr, nullptr, nullptr));
+  ASSERT_EQ(rids[5], new_row.GetRowId());
+}
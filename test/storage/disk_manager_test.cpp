@@ -1,7 +1,20 @@
 #include "storage/disk_manager.h"
 
+#include <sys/stat.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <random>
+#include <thread>
 #include <unordered_set>
+#include <vector>
 
+#include "buffer/buffer_pool_manager.h"
+#include "glog/logging.h"
 #include "gtest/gtest.h"
 
 TEST(DiskManagerTest, BitMapPageTest) {
@@ -56,4 +69,211 @@ TEST(DiskManagerTest, FreePageAllocationTest) {
   EXPECT_EQ(extent_nums * DiskManager::BITMAP_SIZE - 5, meta_page->GetAllocatedPages());
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 2, meta_page->GetExtentUsedPage(0));
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 3, meta_page->GetExtentUsedPage(1));
-}
\ No newline at end of file
+}
+
+/**
+ * The I/O path DiskManager used before pread/pwrite: one fstream behind a recursive mutex, a stat() on every read and
+ * a flush after every write. Kept here as the baseline of the benchmark below.
+ */
+class FstreamPageFile {
+ public:
+  explicit FstreamPageFile(const std::string &file_name) : file_name_(file_name) {
+    io_.open(file_name, std::ios::binary | std::ios::in | std::ios::out);
+  }
+
+  void ReadPage(page_id_t page_id, char *page_data) {
+    std::scoped_lock<std::recursive_mutex> lock(latch_);
+    size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
+    struct stat stat_buf;
+    if (stat(file_name_.c_str(), &stat_buf) != 0 || offset >= static_cast<size_t>(stat_buf.st_size)) {
+      memset(page_data, 0, PAGE_SIZE);
+      return;
+    }
+    io_.seekp(offset);
+    io_.read(page_data, PAGE_SIZE);
+  }
+
+  void WritePage(page_id_t page_id, const char *page_data) {
+    std::scoped_lock<std::recursive_mutex> lock(latch_);
+    io_.seekp(static_cast<size_t>(page_id) * PAGE_SIZE);
+    io_.write(page_data, PAGE_SIZE);
+    io_.flush();
+  }
+
+ private:
+  std::string file_name_;
+  std::fstream io_;
+  std::recursive_mutex latch_;
+};
+
+TEST(DiskManagerTest, RandomIOPSBenchmark) {
+  const std::string db_name = "disk_iops_test.db";
+  const int num_pages = 1024;
+  const int num_ops = 20000;
+  const int num_threads = 4;
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name);
+  char data[PAGE_SIZE];
+  for (int i = 0; i < num_pages; i++) {
+    ASSERT_EQ(i, disk_mgr->AllocatePage());
+    memset(data, 0, PAGE_SIZE);
+    snprintf(data, PAGE_SIZE, "page-%d", i);
+    disk_mgr->WritePage(i, data);
+  }
+  disk_mgr->Close();
+  delete disk_mgr;
+
+  // 每个线程访问随机的数据页，返回每秒操作数
+  auto run = [&](const std::function<void(page_id_t, char *)> &op) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+      threads.emplace_back([&, t] {
+        std::mt19937 rng(t);
+        std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+        char buf[PAGE_SIZE];
+        for (int i = 0; i < num_ops / num_threads; i++) {
+          op(dist(rng), buf);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return num_ops / elapsed.count();
+  };
+  // 逻辑页号到物理页号的映射与DiskManager一致
+  auto physical = [](page_id_t page_id) { return 2 + page_id; };
+
+  auto *fstream_file = new FstreamPageFile(db_name);
+  double fstream_read_iops = run([&](page_id_t page_id, char *buf) { fstream_file->ReadPage(physical(page_id), buf); });
+  double fstream_write_iops = run([&](page_id_t page_id, char *buf) {
+    snprintf(buf, PAGE_SIZE, "page-%d", page_id);
+    fstream_file->WritePage(physical(page_id), buf);
+  });
+  delete fstream_file;
+
+  disk_mgr = new DiskManager(db_name);
+  double pread_iops = run([&](page_id_t page_id, char *buf) {
+    disk_mgr->ReadPage(page_id, buf);
+    ASSERT_EQ("page-" + std::to_string(page_id), std::string(buf));
+  });
+  double pwrite_iops = run([&](page_id_t page_id, char *buf) {
+    snprintf(buf, PAGE_SIZE, "page-%d", page_id);
+    disk_mgr->WritePage(page_id, buf);
+  });
+  for (int i = 0; i < num_pages; i++) {
+    disk_mgr->ReadPage(i, data);
+    ASSERT_EQ("page-" + std::to_string(i), std::string(data));
+  }
+  // reads beyond the end of the file return zeroed pages
+  disk_mgr->ReadPage(DiskManager::BITMAP_SIZE - 1, data);
+  ASSERT_EQ(0, data[0]);
+  LOG(INFO) << "random read IOPS: fstream " << fstream_read_iops << ", pread " << pread_iops;
+  LOG(INFO) << "random write IOPS: fstream " << fstream_write_iops << ", pwrite " << pwrite_iops;
+  disk_mgr->Close();
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, AsyncIOTest) {
+  const std::string db_name = "disk_async_test.db";
+  const int num_pages = 512;
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name);
+  std::vector<std::vector<char>> buffers(num_pages, std::vector<char>(PAGE_SIZE, 0));
+  for (int i = 0; i < num_pages; i++) {
+    ASSERT_EQ(i, disk_mgr->AllocatePage());
+    snprintf(buffers[i].data(), PAGE_SIZE, "page-%d", i);
+  }
+
+  // 所有写同时在途，完成回调在worker线程上执行
+  std::atomic<int> completed{0};
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < num_pages; i++) {
+    futures.push_back(disk_mgr->WritePageAsync(i, buffers[i].data(), [&completed] { completed++; }));
+  }
+  for (auto &future : futures) {
+    future.wait();
+  }
+  std::chrono::duration<double> write_elapsed = std::chrono::steady_clock::now() - start;
+  ASSERT_EQ(num_pages, completed);
+
+  futures.clear();
+  for (auto &buffer : buffers) {
+    std::fill(buffer.begin(), buffer.end(), 0);
+  }
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_pages; i++) {
+    futures.push_back(disk_mgr->ReadPageAsync(i, buffers[i].data()));
+  }
+  for (auto &future : futures) {
+    future.wait();
+  }
+  std::chrono::duration<double> read_elapsed = std::chrono::steady_clock::now() - start;
+  for (int i = 0; i < num_pages; i++) {
+    ASSERT_EQ("page-" + std::to_string(i), std::string(buffers[i].data()));
+  }
+  LOG(INFO) << "async IOPS with " << DEFAULT_IO_WORKERS << " workers: write " << num_pages / write_elapsed.count()
+            << ", read " << num_pages / read_elapsed.count();
+
+  // Close waits for the requests still in flight before closing the file
+  for (int i = 0; i < num_pages; i++) {
+    snprintf(buffers[i].data(), PAGE_SIZE, "page-%d-v2", i);
+    disk_mgr->WritePageAsync(i, buffers[i].data());
+  }
+  disk_mgr->Close();
+  delete disk_mgr;
+  disk_mgr = new DiskManager(db_name);
+  char data[PAGE_SIZE];
+  for (int i = 0; i < num_pages; i++) {
+    disk_mgr->ReadPage(i, data);
+    ASSERT_EQ("page-" + std::to_string(i) + "-v2", std::string(data));
+  }
+  disk_mgr->Close();
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, NewPageRateBenchmark) {
+  const std::string db_name = "disk_new_page_test.db";
+  // 三个分区，逻辑上是几百MB的文件，未写的数据页不占磁盘
+  const size_t num_pages = 3 * DiskManager::BITMAP_SIZE;
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(1024, disk_mgr);
+  page_id_t page_id;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_pages; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    ASSERT_EQ(static_cast<page_id_t>(i), page_id);
+    bpm->UnpinPage(page_id, false);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  LOG(INFO) << "NewPage rate over " << num_pages << " pages: " << num_pages / elapsed.count() << " pages/s";
+
+  // a freed page in the first extent is handed out again before the last extent is used up
+  ASSERT_TRUE(bpm->DeletePage(7));
+  ASSERT_TRUE(disk_mgr->IsPageFree(7));
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  ASSERT_EQ(7, page_id);
+  bpm->UnpinPage(page_id, false);
+  ASSERT_TRUE(bpm->DeletePage(DiskManager::BITMAP_SIZE + 3));
+  delete bpm;
+  disk_mgr->Close();
+  delete disk_mgr;
+
+  // the cached bitmap pages are written back on Close
+  disk_mgr = new DiskManager(db_name);
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
+  ASSERT_EQ(num_pages - 1, meta_page->GetAllocatedPages());
+  ASSERT_FALSE(disk_mgr->IsPageFree(7));
+  ASSERT_TRUE(disk_mgr->IsPageFree(DiskManager::BITMAP_SIZE + 3));
+  ASSERT_EQ(DiskManager::BITMAP_SIZE + 3, disk_mgr->AllocatePage());
+  ASSERT_EQ(num_pages, disk_mgr->AllocatePage());
+  disk_mgr->Close();
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
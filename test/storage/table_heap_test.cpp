@@ -1,10 +1,21 @@
 #include "storage/table_heap.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "common/instance.h"
+#include "glog/logging.h"
 #include "gtest/gtest.h"
+#include "planner/expressions/column_value_expression.h"
+#include "planner/expressions/comparison_expression.h"
+#include "planner/expressions/constant_value_expression.h"
 #include "record/field.h"
 #include "record/schema.h"
 #include "utils/utils.h"
@@ -12,6 +23,21 @@
 static string db_file_name = "table_heap_test.db";
 using Fields = std::vector<Field>;
 
+// every heap allocation of this test binary is counted, so that a benchmark can report allocations per row
+static std::atomic<size_t> num_allocations{0};
+
+void *operator new(size_t size) {
+  num_allocations++;
+  if (void *p = malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { free(p); }
+
+void operator delete(void *p, size_t) noexcept { free(p); }
+
 TEST(TableHeapTest, TableHeapSampleTest) {
   // init testing instance
   remove(db_file_name.c_str());
@@ -52,7 +78,7 @@ TEST(TableHeapTest, TableHeapSampleTest) {
     size--;
     Row row(RowId(row_kv.first));
     table_heap->GetTuple(&row, nullptr);
-    ASSERT_EQ(schema.get()->GetColumnCount(), row.GetFields().size());
+    ASSERT_EQ(schema.get()->GetColumnCount(), row.GetFieldCount());
     for (size_t j = 0; j < schema.get()->GetColumnCount(); j++) {
       ASSERT_EQ(CmpBool::kTrue, row.GetField(j)->CompareEquals(row_kv.second->at(j)));
     }
@@ -61,3 +87,736 @@ TEST(TableHeapTest, TableHeapSampleTest) {
   }
   ASSERT_EQ(size, 0);
 }
+
+/**
+ * Scan a table which does not fit into the buffer pool with and without read-ahead.
+ */
+TEST(TableHeapTest, TableHeapReadAheadScanTest) {
+  remove(db_file_name.c_str());
+  const int row_nums = 30000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  auto disk_mgr_ = new DiskManager(db_file_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  page_id_t free_space_map_page_id = table_heap->GetFreeSpaceMapPageId();
+  char characters[64];
+  for (int i = 0; i < row_nums; i++) {
+    RandomUtils::RandomString(characters, 64);
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 64, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+  delete table_heap;
+  delete bpm_;
+
+  for (size_t window : {static_cast<size_t>(0), DEFAULT_READ_AHEAD_WINDOW}) {
+    bpm_ = new BufferPoolManager(64, disk_mgr_);
+    bpm_->SetReadAheadWindow(window);
+    table_heap = TableHeap::Create(bpm_, first_page_id, schema.get(), nullptr, nullptr, free_space_map_page_id);
+    auto start = std::chrono::steady_clock::now();
+    int count = 0;
+    for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+      ASSERT_EQ(CmpBool::kTrue, iter->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, count)));
+      count++;
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ASSERT_EQ(row_nums, count);
+    ASSERT_TRUE(bpm_->CheckAllUnpinned());
+    LOG(INFO) << "read-ahead window: " << window << ", rows/sec: " << static_cast<size_t>(row_nums / elapsed)
+              << ", prefetched pages: " << bpm_->GetPrefetchedPages();
+    delete table_heap;
+    delete bpm_;
+  }
+  delete disk_mgr_;
+  remove(db_file_name.c_str());
+}
+
+/**
+ * Inserts go through the free space map, so the cost of an insert does not grow with the table.
+ */
+TEST(TableHeapTest, TableHeapInsertLatencyTest) {
+  remove(db_file_name.c_str());
+  const int rounds = 5;
+  const int rows_per_round = 100000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 32, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  auto disk_mgr_ = new DiskManager(db_file_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  char characters[32];
+  RandomUtils::RandomString(characters, 32);
+  std::vector<RowId> first_page_rids;
+  for (int round = 0; round < rounds; round++) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rows_per_round; i++) {
+      Fields fields{Field(TypeId::kTypeInt, round * rows_per_round + i), Field(TypeId::kTypeChar, characters, 32, true)};
+      Row row(fields);
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+      if (row.GetRowId().GetPageId() == table_heap->GetFirstPageId()) {
+        first_page_rids.push_back(row.GetRowId());
+      }
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    LOG(INFO) << "rows " << round * rows_per_round << " - " << (round + 1) * rows_per_round << ": "
+              << elapsed * 1e9 / rows_per_round << " ns per insert, " << table_heap->GetNumPages() << " pages";
+  }
+
+  // space freed in the first page is found again by the next insert
+  size_t num_pages = table_heap->GetNumPages();
+  ASSERT_FALSE(first_page_rids.empty());
+  ASSERT_TRUE(table_heap->MarkDelete(first_page_rids[0], nullptr));
+  table_heap->ApplyDelete(first_page_rids[0], nullptr);
+  Fields fields{Field(TypeId::kTypeInt, -1), Field(TypeId::kTypeChar, characters, 32, true)};
+  Row row(fields);
+  ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  ASSERT_EQ(table_heap->GetFirstPageId(), row.GetRowId().GetPageId());
+  ASSERT_EQ(num_pages, table_heap->GetNumPages());
+
+  // the map is persistent, a reopened heap knows every page
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  page_id_t free_space_map_page_id = table_heap->GetFreeSpaceMapPageId();
+  delete table_heap;
+  table_heap = TableHeap::Create(bpm_, first_page_id, schema.get(), nullptr, nullptr, free_space_map_page_id);
+  ASSERT_EQ(num_pages, table_heap->GetNumPages());
+  ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  delete table_heap;
+
+  // a heap whose pages were written in an older format is not opened
+  auto first_page = bpm_->FetchPage(first_page_id);
+  ASSERT_NE(nullptr, first_page);
+  uint16_t old_version = 0;
+  memcpy(first_page->GetData() + 30, &old_version, sizeof(old_version));  // version field of the page header
+  bpm_->UnpinPage(first_page_id, true);
+  ASSERT_EQ(nullptr,
+            TableHeap::Create(bpm_, first_page_id, schema.get(), nullptr, nullptr, free_space_map_page_id));
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_file_name.c_str());
+}
+
+/**
+ * A batch insert packs the rows into as few page visits as possible and gives every row its own rid.
+ */
+TEST(TableHeapTest, TableHeapBulkInsertTest) {
+  remove(db_file_name.c_str());
+  const int row_nums = 100000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 32, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  auto disk_mgr_ = new DiskManager(db_file_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  char characters[32];
+  RandomUtils::RandomString(characters, 32);
+  auto make_rows = [&](int begin, int end) {
+    std::vector<Row> rows;
+    for (int i = begin; i < end; i++) {
+      Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 32, true)};
+      rows.emplace_back(fields);
+    }
+    return rows;
+  };
+
+  // one row at a time
+  TableHeap *single_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  auto rows = make_rows(0, row_nums);
+  auto start = std::chrono::steady_clock::now();
+  for (auto &row : rows) {
+    ASSERT_TRUE(single_heap->InsertTuple(row, nullptr));
+  }
+  auto single_elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  // the same rows as batches of multi-row VALUES size, into a table which already has a partly filled page
+  TableHeap *batch_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  rows = make_rows(0, 10);
+  ASSERT_EQ(10, batch_heap->InsertTuples(rows, nullptr));
+  start = std::chrono::steady_clock::now();
+  for (int begin = 10; begin < row_nums; begin += 1000) {
+    rows = make_rows(begin, std::min(begin + 1000, row_nums));
+    ASSERT_EQ(rows.size(), batch_heap->InsertTuples(rows, nullptr));
+  }
+  auto batch_elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  LOG(INFO) << "inserting " << row_nums << " rows: one by one " << static_cast<size_t>(row_nums / single_elapsed)
+            << " rows/sec, batched " << static_cast<size_t>(row_nums / batch_elapsed) << " rows/sec";
+  ASSERT_EQ(single_heap->GetNumPages(), batch_heap->GetNumPages());
+
+  // every row comes back in insert order with a distinct rid
+  int count = 0;
+  std::unordered_map<int64_t, int> rids;
+  for (auto iter = batch_heap->Begin(nullptr); iter != batch_heap->End(); ++iter) {
+    ASSERT_EQ(CmpBool::kTrue, iter->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, count)));
+    ASSERT_TRUE(rids.emplace(iter->GetRowId().Get(), count).second);
+    count++;
+  }
+  ASSERT_EQ(row_nums, count);
+  ASSERT_TRUE(bpm_->CheckAllUnpinned());
+  delete single_heap;
+  delete batch_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_file_name.c_str());
+}
+
+/**
+ * Scan with a selective predicate, evaluated once on materialized rows and once on row views.
+ */
+TEST(TableHeapTest, TableHeapScanBenchmark) {
+  remove(db_file_name.c_str());
+  const int row_nums = 100000;
+  const int selected = 1000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 32, 1, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  auto disk_mgr_ = new DiskManager(db_file_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  // 预读线程读入页时的分配与扫描交错，次数随时机变化，这里只统计扫描本身
+  bpm_->SetReadAheadWindow(0);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  char characters[32];
+  RandomUtils::RandomString(characters, 32);
+  std::vector<Row> rows;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 32, true),
+                  Field(TypeId::kTypeFloat, static_cast<float>(i))};
+    rows.emplace_back(fields);
+  }
+  ASSERT_EQ(row_nums, table_heap->InsertTuples(rows, nullptr));
+  rows.clear();
+
+  // id < selected
+  auto predicate = std::make_shared<ComparisonExpression>(
+      std::make_shared<ColumnValueExpression>(0, 0, TypeId::kTypeInt),
+      std::make_shared<ConstantValueExpression>(Field(TypeId::kTypeInt, selected)), "<");
+  auto end = table_heap->End();
+
+  size_t allocations = num_allocations;
+  auto start = std::chrono::steady_clock::now();
+  int matched = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != end; ++iter) {
+    if (predicate->Evaluate(&*iter).CompareEquals(Field(TypeId::kTypeInt, 1)) == CmpBool::kTrue) {
+      matched++;
+    }
+  }
+  double row_elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  double row_allocations = static_cast<double>(num_allocations - allocations) / row_nums;
+  ASSERT_EQ(selected, matched);
+
+  allocations = num_allocations;
+  start = std::chrono::steady_clock::now();
+  matched = 0;
+  Row row;
+  for (auto iter = table_heap->Begin(nullptr); iter != end; ++iter) {
+    const RowView &view = iter.GetRowView();
+    if (predicate->Evaluate(view).CompareEquals(Field(TypeId::kTypeInt, 1)) == CmpBool::kTrue) {
+      view.Materialize(&row);
+      ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, matched)));
+      matched++;
+    }
+  }
+  double view_elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  double view_allocations = static_cast<double>(num_allocations - allocations) / row_nums;
+  ASSERT_EQ(selected, matched);
+
+  LOG(INFO) << "scanning " << row_nums << " rows with " << selected << " matches: materialized "
+            << static_cast<size_t>(row_nums / row_elapsed) << " rows/sec, " << row_allocations
+            << " allocations/row; row view " << static_cast<size_t>(row_nums / view_elapsed) << " rows/sec, "
+            << view_allocations << " allocations/row";
+  // the iterator materializes every row into the same buffer, so neither way allocates per row
+  ASSERT_LE(view_allocations, row_allocations);
+  ASSERT_LT(row_allocations, 1);
+  ASSERT_LT(view_allocations, 1);
+  ASSERT_TRUE(bpm_->CheckAllUnpinned());
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_file_name.c_str());
+}
+
+/**
+ * The iterator walks a page at a time, skips pages without live tuples and notices changes made to the page of the row
+ * it has just returned: a delete of the next row, or an update which moves the tuples after it.
+ */
+TEST(TableHeapTest, TableHeapPageIteratorTest) {
+  remove(db_file_name.c_str());
+  const int row_nums = 20000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  auto disk_mgr_ = new DiskManager(db_file_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  char characters[64];
+  RandomUtils::RandomString(characters, 64);
+  std::vector<Row> rows;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, i % 32, true)};
+    rows.emplace_back(fields);
+  }
+  ASSERT_EQ(row_nums, table_heap->InsertTuples(rows, nullptr));
+
+  // empty the first page and a page in the middle of the chain
+  page_id_t first_page_id = rows.front().GetRowId().GetPageId();
+  page_id_t middle_page_id = rows[row_nums / 2].GetRowId().GetPageId();
+  int deleted = 0;
+  for (auto &row : rows) {
+    if (row.GetRowId().GetPageId() == first_page_id || row.GetRowId().GetPageId() == middle_page_id) {
+      ASSERT_TRUE(table_heap->MarkDelete(row.GetRowId(), nullptr));
+      table_heap->ApplyDelete(row.GetRowId(), nullptr);
+      deleted++;
+    }
+  }
+  auto end = table_heap->End();
+
+  // a row at a time
+  auto start = std::chrono::steady_clock::now();
+  int count = 0;
+  int last_id = -1;
+  for (auto iter = table_heap->Begin(nullptr); iter != end; ++iter) {
+    int id = iter.GetRowView().GetInt(0);
+    ASSERT_GT(id, last_id);
+    ASSERT_NE(first_page_id, iter.GetRowView().GetRowId().GetPageId());
+    ASSERT_NE(middle_page_id, iter.GetRowView().GetRowId().GetPageId());
+    last_id = id;
+    count++;
+  }
+  auto row_elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  ASSERT_EQ(row_nums - deleted, count);
+
+  // a page at a time
+  start = std::chrono::steady_clock::now();
+  count = 0;
+  size_t pages = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != end; iter.NextPage()) {
+    size_t num_views;
+    const RowView *views = iter.GetPageRowViews(&num_views);
+    ASSERT_GT(num_views, 0);
+    for (size_t i = 0; i < num_views; i++) {
+      ASSERT_EQ(views[i].GetRowId().GetPageId(), views[0].GetRowId().GetPageId());
+      count++;
+    }
+    pages++;
+  }
+  auto page_elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  ASSERT_EQ(row_nums - deleted, count);
+  ASSERT_EQ(table_heap->GetNumPages() - 2, pages);
+  LOG(INFO) << "iterating " << count << " rows: a row at a time " << static_cast<size_t>(count / row_elapsed)
+            << " rows/sec, a page at a time " << static_cast<size_t>(count / page_elapsed) << " rows/sec";
+
+  // mark the next row deleted right after a row has been returned, which leaves the free space of its page as it was
+  count = 0;
+  std::unordered_set<int> marked;
+  for (auto iter = table_heap->Begin(nullptr); iter != end; ++iter) {
+    int id = iter.GetRowView().GetInt(0);
+    ASSERT_EQ(0, marked.count(id));
+    count++;
+    if (id + 1 < row_nums && rows[id + 1].GetRowId().GetPageId() == rows[id].GetRowId().GetPageId()) {
+      ASSERT_TRUE(table_heap->MarkDelete(rows[id + 1].GetRowId(), nullptr));
+      marked.insert(id + 1);
+    }
+  }
+  ASSERT_EQ(row_nums - deleted, count + marked.size());
+  for (auto id : marked) {
+    table_heap->RollbackDelete(rows[id].GetRowId(), nullptr);
+  }
+
+  // delete every row in an even slot after the iterator has reached it, the iterator notices under the latch
+  count = 0;
+  marked.clear();
+  for (auto iter = table_heap->Begin(nullptr); iter != end; ++iter) {
+    if (iter.GetRowView().GetRowId().GetSlotNum() % 2 == 0) {
+      marked.insert(iter.GetRowView().GetInt(0));
+      ASSERT_TRUE(table_heap->MarkDelete(iter.GetRowView().GetRowId(), nullptr));
+    }
+    if (!iter.RLatchPage()) {
+      iter.RUnlatchPage();
+      continue;
+    }
+    int id = iter.GetRowView().GetInt(0);
+    iter.RUnlatchPage();
+    ASSERT_EQ(0, marked.count(id));
+    count++;
+  }
+  ASSERT_EQ(row_nums - deleted, count + marked.size());
+  for (auto id : marked) {
+    table_heap->RollbackDelete(rows[id].GetRowId(), nullptr);
+  }
+
+  // grow every row right after it has been returned, which moves the tuples after it in its page
+  count = 0;
+  last_id = -1;
+  for (auto iter = table_heap->Begin(nullptr); iter != end; ++iter) {
+    const RowView &view = iter.GetRowView();
+    int id = view.GetInt(0);
+    ASSERT_GT(id, last_id);
+    uint32_t len;
+    view.GetChars(1, &len);
+    ASSERT_EQ(static_cast<uint32_t>(id % 32), len);
+    last_id = id;
+    count++;
+    Fields fields{Field(TypeId::kTypeInt, id), Field(TypeId::kTypeChar, characters, id % 32 + 1, true)};
+    Row row(fields);
+    table_heap->UpdateTuple(row, view.GetRowId(), nullptr);
+  }
+  ASSERT_EQ(row_nums - deleted, count);
+  ASSERT_TRUE(bpm_->CheckAllUnpinned());
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_file_name.c_str());
+}
+
+/**
+ * After deleting most rows, VACUUM gives back the pages left empty, so that a scan reads fewer pages.
+ */
+TEST(TableHeapTest, TableHeapVacuumTest) {
+  remove(db_file_name.c_str());
+  const int row_nums = 50000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  auto disk_mgr_ = new DiskManager(db_file_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  char characters[64];
+  RandomUtils::RandomString(characters, 64);
+  std::vector<Row> rows;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 64, true)};
+    rows.emplace_back(fields);
+  }
+  ASSERT_EQ(row_nums, table_heap->InsertTuples(rows, nullptr));
+  auto end = table_heap->End();
+  auto scan = [&]() {
+    int count = 0;
+    for (auto iter = table_heap->Begin(nullptr); iter != end; ++iter) {
+      count++;
+    }
+    return count;
+  };
+
+  // delete the first 90% of the rows and every other row of the rest
+  int live = 0;
+  for (int i = 0; i < row_nums; i++) {
+    if (i < row_nums * 9 / 10 || i % 2 == 0) {
+      ASSERT_TRUE(table_heap->MarkDelete(rows[i].GetRowId(), nullptr));
+    } else {
+      live++;
+    }
+  }
+  size_t pages_before = table_heap->GetNumPages();
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_EQ(live, scan());
+  auto elapsed_before = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  // a page left empty which another thread still has pinned is unlinked, but only freed by the next VACUUM
+  page_id_t pinned_page_id = rows[row_nums / 2].GetRowId().GetPageId();
+  ASSERT_NE(nullptr, bpm_->FetchPage(pinned_page_id));
+  size_t pages_freed = 0;
+  ASSERT_EQ(row_nums - live, table_heap->Vacuum(DEFAULT_VACUUM_DEAD_RATIO, &pages_freed));
+  size_t pages_after = table_heap->GetNumPages();
+  std::vector<page_id_t> kept_page_ids = table_heap->GetPageIds();
+  ASSERT_EQ(kept_page_ids.end(), std::find(kept_page_ids.begin(), kept_page_ids.end(), pinned_page_id));
+  ASSERT_FALSE(bpm_->IsPageFree(pinned_page_id));
+  bpm_->UnpinPage(pinned_page_id, false);
+  ASSERT_EQ(pages_before - pages_freed, pages_after);
+  ASSERT_LT(pages_after, pages_before / 5);
+  start = std::chrono::steady_clock::now();
+  ASSERT_EQ(live, scan());
+  auto elapsed_after = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  LOG(INFO) << "vacuum: pages " << pages_before << " -> " << pages_after << ", scan " << elapsed_before * 1000
+            << " ms -> " << elapsed_after * 1000 << " ms";
+  // nothing left to do
+  ASSERT_EQ(0, table_heap->Vacuum(DEFAULT_VACUUM_DEAD_RATIO, &pages_freed));
+  ASSERT_EQ(0, pages_freed);
+  ASSERT_TRUE(bpm_->IsPageFree(pinned_page_id));
+
+  // the free space map on disk matches the chain, new rows go into the compacted pages first
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  page_id_t free_space_map_page_id = table_heap->GetFreeSpaceMapPageId();
+  delete table_heap;
+  table_heap = TableHeap::Create(bpm_, first_page_id, schema.get(), nullptr, nullptr, free_space_map_page_id);
+  ASSERT_EQ(pages_after, table_heap->GetNumPages());
+  std::vector<page_id_t> page_ids = table_heap->GetPageIds();
+  Fields fields{Field(TypeId::kTypeInt, -1), Field(TypeId::kTypeChar, characters, 64, true)};
+  Row row(fields);
+  ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  ASSERT_EQ(page_ids.front(), row.GetRowId().GetPageId());
+  end = table_heap->End();
+  ASSERT_EQ(live + 1, scan());
+  ASSERT_TRUE(bpm_->CheckAllUnpinned());
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_file_name.c_str());
+}
+
+/**
+ * Rows inserted while VACUUM unlinks empty pages are never put into a page which has just been unlinked.
+ */
+TEST(TableHeapTest, TableHeapVacuumConcurrentInsertTest) {
+  remove(db_file_name.c_str());
+  const int row_nums = 20000;
+  const int num_threads = 4;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  auto disk_mgr_ = new DiskManager(db_file_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  char characters[64];
+  RandomUtils::RandomString(characters, 64);
+  for (int round = 0; round < 5; round++) {
+    std::vector<Row> rows;
+    for (int i = 0; i < row_nums; i++) {
+      Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 64, true)};
+      rows.emplace_back(fields);
+    }
+    ASSERT_EQ(row_nums, table_heap->InsertTuples(rows, nullptr));
+    for (auto &row : rows) {
+      ASSERT_TRUE(table_heap->MarkDelete(row.GetRowId(), nullptr));
+      table_heap->ApplyDelete(row.GetRowId(), nullptr);
+    }
+    // the inserts go to the empty pages which VACUUM is unlinking
+    std::atomic<int> inserted{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+      threads.emplace_back([&, t] {
+        for (int i = 0; i < row_nums / 10; i++) {
+          Fields fields{Field(TypeId::kTypeInt, t), Field(TypeId::kTypeChar, characters, 8, true)};
+          Row row(fields);
+          if (table_heap->InsertTuple(row, nullptr)) {
+            inserted++;
+          }
+        }
+      });
+    }
+    table_heap->Vacuum(0);
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    ASSERT_EQ(num_threads * row_nums / 10, inserted);
+    int count = 0;
+    for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+      count++;
+    }
+    ASSERT_EQ(inserted * (round + 1), count);
+  }
+  ASSERT_TRUE(bpm_->CheckAllUnpinned());
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_file_name.c_str());
+}
+
+/**
+ * Large char fields are kept in overflow pages, so the heap stays dense and a scan which does not read them never
+ * fetches an overflow page.
+ */
+TEST(TableHeapTest, TableHeapOverflowTest) {
+  remove(db_file_name.c_str());
+  const int row_nums = 2000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   new Column("doc", TypeId::kTypeChar, VARCHAR_MAX_LEN - 1, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  auto disk_mgr_ = new DiskManager(db_file_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  auto overflow_store = table_heap->GetOverflowStore();
+
+  // every third row is small enough to stay in its page, the others are up to several pages long
+  auto make_doc = [](int i) {
+    size_t len = i % 3 == 0 ? 100 : 2000 + (i * 37) % (3 * PAGE_SIZE);
+    std::string doc(len, 'a' + i % 26);
+    doc[0] = static_cast<char>('0' + i % 10);
+    return doc;
+  };
+  char name[64];
+  RandomUtils::RandomString(name, 64);
+  std::vector<Row> rows;
+  std::vector<std::string> docs;
+  for (int i = 0; i < row_nums; i++) {
+    docs.push_back(make_doc(i));
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, name, 64, true),
+                  Field(TypeId::kTypeChar, const_cast<char *>(docs[i].data()), docs[i].size(), true)};
+    rows.emplace_back(fields);
+  }
+  // half through the batch insert, half one by one
+  std::vector<Row> batch(rows.begin(), rows.begin() + row_nums / 2);
+  ASSERT_EQ(row_nums / 2, table_heap->InsertTuples(batch, nullptr));
+  for (int i = 0; i < row_nums / 2; i++) {
+    rows[i].SetRowId(batch[i].GetRowId());
+    ASSERT_FALSE(rows[i].GetField(2)->IsExternal());
+  }
+  for (int i = row_nums / 2; i < row_nums; i++) {
+    ASSERT_TRUE(table_heap->InsertTuple(rows[i], nullptr));
+  }
+  size_t heap_pages = table_heap->GetNumPages();
+  LOG(INFO) << "overflow: " << row_nums << " rows in " << heap_pages << " heap pages";
+  ASSERT_LT(heap_pages, row_nums / 20);
+
+  // a scan of the small columns reads no overflow page
+  auto start = std::chrono::steady_clock::now();
+  int count = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+    const RowView &view = iter.GetRowView();
+    int id = view.GetInt(0);
+    uint32_t len;
+    view.GetChars(1, &len);
+    ASSERT_EQ(64, len);
+    ASSERT_EQ(id % 3 != 0, view.IsExternal(2));
+    count++;
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  LOG(INFO) << "overflow: scan without the large column " << elapsed * 1000 << " ms";
+  ASSERT_EQ(row_nums, count);
+  ASSERT_EQ(0, overflow_store->GetReads());
+
+  // the large column is read on access, once per row
+  count = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+    const RowView &view = iter.GetRowView();
+    int id = view.GetInt(0);
+    uint32_t len;
+    const char *doc = view.GetChars(2, &len);
+    ASSERT_EQ(docs[id], std::string(doc, len));
+    view.GetChars(2, &len);
+    ASSERT_EQ(docs[id], iter->GetField(2)->toString());
+    count++;
+  }
+  ASSERT_EQ(row_nums - (row_nums + 2) / 3, overflow_store->GetReads() / 2);
+
+  for (int i = 0; i < row_nums; i++) {
+    Row row(rows[i].GetRowId());
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    ASSERT_FALSE(row.GetField(2)->IsExternal());
+    ASSERT_EQ(docs[i], row.GetField(2)->toString());
+  }
+
+  // an update replaces the chain of the old value, VACUUM frees the chains of deleted rows
+  RowView view;
+  auto page = reinterpret_cast<TablePage *>(bpm_->FetchPage(rows[1].GetRowId().GetPageId()));
+  ASSERT_TRUE(page->GetTupleView(rows[1].GetRowId(), schema.get(), &view));
+  page_id_t old_chain = view.GetOverflowPageId(2);
+  ASSERT_TRUE(page->GetTupleView(rows[2].GetRowId(), schema.get(), &view));
+  page_id_t deleted_chain = view.GetOverflowPageId(2);
+  bpm_->UnpinPage(page->GetPageId(), false);
+  std::string new_doc(3 * PAGE_SIZE, 'z');
+  Fields fields{Field(TypeId::kTypeInt, 1), Field(TypeId::kTypeChar, name, 64, true),
+                Field(TypeId::kTypeChar, const_cast<char *>(new_doc.data()), new_doc.size(), true)};
+  Row new_row(fields);
+  ASSERT_TRUE(table_heap->UpdateTuple(new_row, rows[1].GetRowId(), nullptr));
+  ASSERT_TRUE(bpm_->IsPageFree(old_chain));
+  Row row(rows[1].GetRowId());
+  ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+  ASSERT_EQ(new_doc, row.GetField(2)->toString());
+
+  ASSERT_TRUE(table_heap->MarkDelete(rows[2].GetRowId(), nullptr));
+  ASSERT_FALSE(bpm_->IsPageFree(deleted_chain));
+  table_heap->Vacuum(0);
+  ASSERT_TRUE(bpm_->IsPageFree(deleted_chain));
+  ASSERT_TRUE(bpm_->CheckAllUnpinned());
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_file_name.c_str());
+}
+
+/**
+ * A heap created with the PAX layout keeps it when it is opened again, and works like a row heap.
+ */
+TEST(TableHeapTest, TableHeapPaxTest) {
+  remove(db_file_name.c_str());
+  const int row_nums = 20000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  auto disk_mgr_ = new DiskManager(db_file_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr, TableLayout::kPax);
+  ASSERT_EQ(TableLayout::kPax, table_heap->GetLayout());
+  char characters[64];
+  RandomUtils::RandomString(characters, 64);
+  std::vector<Row> rows;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, i % 65, true),
+                  Field(TypeId::kTypeFloat, i * 0.25f)};
+    rows.emplace_back(fields);
+  }
+  // half through the batch insert, half one by one
+  std::vector<Row> batch(rows.begin(), rows.begin() + row_nums / 2);
+  ASSERT_EQ(row_nums / 2, table_heap->InsertTuples(batch, nullptr));
+  for (int i = 0; i < row_nums / 2; i++) {
+    rows[i].SetRowId(batch[i].GetRowId());
+  }
+  for (int i = row_nums / 2; i < row_nums; i++) {
+    ASSERT_TRUE(table_heap->InsertTuple(rows[i], nullptr));
+  }
+  // a value longer than its column is rejected
+  char long_name[65];
+  Fields long_fields{Field(TypeId::kTypeInt, -1), Field(TypeId::kTypeChar, long_name, 65, false),
+                     Field(TypeId::kTypeFloat, 0.0f)};
+  Row long_row(long_fields);
+  ASSERT_FALSE(table_heap->InsertTuple(long_row, nullptr));
+  std::vector<Row> long_batch{long_row};
+  ASSERT_EQ(0, table_heap->InsertTuples(long_batch, nullptr));
+
+  auto check = [&](int expected) {
+    int count = 0;
+    for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+      const RowView &view = iter.GetRowView();
+      int id = view.GetInt(0);
+      uint32_t len;
+      view.GetChars(1, &len);
+      ASSERT_EQ(static_cast<uint32_t>(id % 65), len);
+      ASSERT_EQ(id * 0.25f, view.GetFloat(2));
+      ASSERT_EQ(id, std::stoi(iter->GetField(0)->toString()));
+      count++;
+    }
+    ASSERT_EQ(expected, count);
+  };
+  check(row_nums);
+  for (int i = 0; i < row_nums; i += 97) {
+    Row row(rows[i].GetRowId());
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(1)->CompareEquals(*rows[i].GetField(1)));
+  }
+  Fields new_fields{Field(TypeId::kTypeInt, 1), Field(TypeId::kTypeChar, characters, 1, true),
+                    Field(TypeId::kTypeFloat, 0.25f)};
+  Row new_row(new_fields);
+  ASSERT_TRUE(table_heap->UpdateTuple(new_row, rows[1].GetRowId(), nullptr));
+  ASSERT_FALSE(table_heap->UpdateTuple(long_row, rows[2].GetRowId(), nullptr));
+
+  // the layout is read from the first page when the heap is opened
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  page_id_t free_space_map_page_id = table_heap->GetFreeSpaceMapPageId();
+  delete table_heap;
+  table_heap = TableHeap::Create(bpm_, first_page_id, schema.get(), nullptr, nullptr, free_space_map_page_id);
+  ASSERT_EQ(TableLayout::kPax, table_heap->GetLayout());
+  check(row_nums);
+
+  // deleted slots are freed by VACUUM and reused
+  int deleted = 0;
+  for (int i = 0; i < row_nums; i++) {
+    if (i < row_nums * 9 / 10) {
+      ASSERT_TRUE(table_heap->MarkDelete(rows[i].GetRowId(), nullptr));
+      deleted++;
+    }
+  }
+  size_t pages_before = table_heap->GetNumPages();
+  ASSERT_EQ(deleted, table_heap->Vacuum(0));
+  ASSERT_LT(table_heap->GetNumPages(), pages_before);
+  check(row_nums - deleted);
+  ASSERT_TRUE(table_heap->InsertTuple(rows[0], nullptr));
+  check(row_nums - deleted + 1);
+  ASSERT_TRUE(bpm_->CheckAllUnpinned());
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_file_name.c_str());
+}